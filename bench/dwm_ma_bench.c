@@ -0,0 +1,422 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "dwm_ma.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Maximum amount of values of each swept parameter
+ */
+#define MAX_SWEEP_COUNT 32
+
+// Internal structs and functions declarations
+
+/**
+ * Benchmark options, parsed from the command line
+ */
+typedef struct {
+    int sizes[MAX_SWEEP_COUNT][3];
+    int size_count;
+    int in_counts[MAX_SWEEP_COUNT];
+    int in_count_count;
+    MA_CONFIG ma_configs[MA_CONFIG_CUSTOM];
+    int ma_config_count;
+    double seconds;
+    int thread_count;
+    int temporal_block_size;
+    DWM_MA_STORAGE storage;
+    DWM_MA_TOPOLOGY topology;
+    const char *json_path;
+} bench_options_t;
+
+/**
+ * Measurements of a single benchmark case
+ */
+typedef struct {
+    int size[3];
+    int in_count;
+    MA_CONFIG ma_config;
+    long long buffer_count;
+    double elapsed_s;
+    double ns_per_junction;
+    double mjunctions_per_s;
+    double realtime_factor;
+} bench_result_t;
+
+/**
+ * Names of the built-in microphone array configurations, indexed by MA_CONFIG
+ */
+static const char *const MA_CONFIG_NAMES[MA_CONFIG_CUSTOM] = {
+        "MA_CONFIG_MONO",
+        "MA_CONFIG_STEREO",
+        "MA_CONFIG_6_POINTS_SQRT_1",
+        "MA_CONFIG_8_POINTS_SQRT_3",
+        "MA_CONFIG_12_POINTS_SQRT_2",
+        "MA_CONFIG_24_POINTS_SQRT_5",
+        "MA_CONFIG_24_POINTS_SQRT_6",
+        "MA_CONFIG_24_POINTS_SQRT_10",
+        "MA_CONFIG_24_POINTS_SQRT_11",
+        "MA_CONFIG_24_POINTS_SQRT_13",
+        "MA_CONFIG_30_POINTS_SQRT_9",
+};
+
+/**
+ * Names of the storage formats, indexed by DWM_MA_STORAGE
+ */
+static const char *const STORAGE_NAMES[] = {"f32", "f16", "bf16"};
+
+/**
+ * Names of the junction topologies, indexed by DWM_MA_TOPOLOGY
+ */
+static const char *const TOPOLOGY_NAMES[] = {"rectilinear", "interpolated"};
+
+/**
+ * Prints the command line usage
+ */
+static void print_usage(const char *program);
+
+/**
+ * Parses a comma separated list of non-negative integers
+ * @return the amount of values parsed, or -1 if the list is not valid
+ */
+static int parse_list(const char *list, int *values, int max_count);
+
+/**
+ * Parses the command line, starting from the default options
+ * @return 0 on success, non-zero if the command line is not valid
+ */
+static int parse_options(int argc, char **argv, bench_options_t *options);
+
+/**
+ * Runs a single benchmark case: the mesh is first filled by the inputs' wavefronts, so that every junction is updated,
+ * and then processes buffers until options->seconds elapsed
+ * @return 0 on success, non-zero if the dwm-ma instance or the sample buffers cannot be allocated
+ */
+static int run_case(const bench_options_t *options, const dwm_ma_mesh_config *config, int in_count,
+                    MA_CONFIG ma_config, bench_result_t *result);
+
+/**
+ * Writes the results as JSON
+ * @return 0 on success, non-zero if the file cannot be written
+ */
+static int write_json(const char *path, const bench_options_t *options, const dwm_ma_mesh_config *config,
+                      const bench_result_t *results, int result_count);
+
+/**
+ * Monotonic time in seconds
+ */
+static double now_s(void);
+
+// Function definitions
+
+int main(int argc, char **argv) {
+    bench_options_t options;
+    if (parse_options(argc, argv, &options) != 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    dwm_ma_mesh_config config;
+    dwm_ma_mesh_config_default(&config);
+    config.storage = options.storage;
+    config.topology = options.topology;
+
+    // Check every swept configuration upfront, so that only allocation failures are left to the benchmark cases
+    for (int s = 0; s < options.size_count; s++) {
+        config.size_x_j = options.sizes[s][0];
+        config.size_y_j = options.sizes[s][1];
+        config.size_z_j = options.sizes[s][2];
+        if (dwm_ma_memory_requirements(&config) == 0) {
+            fprintf(stderr, "invalid configuration: %dx%dx%d mesh with %s storage and %s topology\n", config.size_x_j,
+                    config.size_y_j, config.size_z_j, STORAGE_NAMES[config.storage], TOPOLOGY_NAMES[config.topology]);
+            return 1;
+        }
+    }
+
+    // Sweep every size, input count and microphone array configuration
+    const int case_count = options.size_count * options.in_count_count * options.ma_config_count;
+    bench_result_t *results = malloc(sizeof(bench_result_t) * case_count);
+    if (results == NULL) {
+        fprintf(stderr, "cannot allocate the results\n");
+        return 1;
+    }
+    int result_count = 0;
+    printf("%-14s %6s %-28s %12s %12s %10s\n", "size", "inputs", "ma_config", "ns/junction", "Mjunctions/s",
+           "realtime");
+    for (int s = 0; s < options.size_count; s++) {
+        config.size_x_j = options.sizes[s][0];
+        config.size_y_j = options.sizes[s][1];
+        config.size_z_j = options.sizes[s][2];
+        for (int i = 0; i < options.in_count_count; i++) {
+            for (int c = 0; c < options.ma_config_count; c++) {
+                bench_result_t *result = &results[result_count];
+                if (run_case(&options, &config, options.in_counts[i], options.ma_configs[c], result) != 0) {
+                    fprintf(stderr, "cannot allocate a %dx%dx%d mesh\n", config.size_x_j, config.size_y_j,
+                            config.size_z_j);
+                    free(results);
+                    return 1;
+                }
+                result_count++;
+                printf("%4dx%4dx%4d %6d %-28s %12.3f %12.1f %9.3fx\n", result->size[0], result->size[1],
+                       result->size[2], result->in_count, MA_CONFIG_NAMES[result->ma_config],
+                       result->ns_per_junction, result->mjunctions_per_s, result->realtime_factor);
+                fflush(stdout);
+            }
+        }
+    }
+    const int status = options.json_path != NULL ? write_json(options.json_path, &options, &config, results,
+                                                              result_count)
+                                                 : 0;
+    free(results);
+    return status;
+}
+
+void print_usage(const char *program) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --sizes N[,N...]       cubic mesh sizes in junctions (default: the DWM_MA_SPECIALIZED_SIZES and\n"
+            "                         DWM_MA_SIZE_*_J sizes the program was compiled with)\n"
+            "  --inputs N[,N...]      input counts (default: 1,4,16)\n"
+            "  --configs C[,C...]     MA_CONFIG values, as integers (default: every built-in configuration)\n"
+            "  --seconds S            measured time per case (default: 0.25)\n"
+            "  --threads N            dwm_ma_set_thread_count (default: 1)\n"
+            "  --block N              dwm_ma_set_temporal_block_size (default: 1)\n"
+            "  --storage f32|f16|bf16 mesh storage (default: f32)\n"
+            "  --topology rectilinear|interpolated\n"
+            "                         mesh topology (default: rectilinear)\n"
+            "  --json PATH            writes the results as JSON\n",
+            program);
+}
+
+int parse_list(const char *list, int *values, const int max_count) {
+    int count = 0;
+    while (*list != '\0') {
+        char *end;
+        const long value = strtol(list, &end, 10);
+        if (end == list || value < 0 || value > 1 << 20 || count == max_count || (*end != ',' && *end != '\0')) {
+            return -1;
+        }
+        values[count++] = (int) value;
+        list = *end == ',' ? end + 1 : end;
+    }
+    return count;
+}
+
+int parse_options(const int argc, char **argv, bench_options_t *options) {
+    // Default sizes are the specialized ones, followed by the compiled one if it is not among them
+#define ADD_SIZE(X_J, Y_J, Z_J)                                                                                        \
+    options->sizes[options->size_count][0] = X_J;                                                                      \
+    options->sizes[options->size_count][1] = Y_J;                                                                      \
+    options->sizes[options->size_count][2] = Z_J;                                                                      \
+    compiled_listed |= X_J == DWM_MA_SIZE_X_J && Y_J == DWM_MA_SIZE_Y_J && Z_J == DWM_MA_SIZE_Z_J;                     \
+    options->size_count++;
+    int compiled_listed = 0;
+    options->size_count = 0;
+    DWM_MA_SPECIALIZED_SIZES(ADD_SIZE)
+    if (!compiled_listed) {
+        ADD_SIZE(DWM_MA_SIZE_X_J, DWM_MA_SIZE_Y_J, DWM_MA_SIZE_Z_J)
+    }
+#undef ADD_SIZE
+    options->in_counts[0] = 1;
+    options->in_counts[1] = 4;
+    options->in_counts[2] = 16;
+    options->in_count_count = 3;
+    for (int c = 0; c < MA_CONFIG_CUSTOM; c++) {
+        options->ma_configs[c] = (MA_CONFIG) c;
+    }
+    options->ma_config_count = MA_CONFIG_CUSTOM;
+    options->seconds = 0.25;
+    options->thread_count = 1;
+    options->temporal_block_size = 1;
+    options->storage = DWM_MA_STORAGE_FLOAT32;
+    options->topology = DWM_MA_TOPOLOGY_RECTILINEAR;
+    options->json_path = NULL;
+
+    for (int a = 1; a < argc; a++) {
+        const char *option = argv[a], *value = a + 1 < argc ? argv[a + 1] : NULL;
+        int values[MAX_SWEEP_COUNT], count;
+        if (value == NULL) {
+            return 1;
+        }
+        a++;
+        if (strcmp(option, "--sizes") == 0) {
+            if ((count = parse_list(value, values, MAX_SWEEP_COUNT)) < 1) {
+                return 1;
+            }
+            for (int k = 0; k < count; k++) {
+                options->sizes[k][0] = options->sizes[k][1] = options->sizes[k][2] = values[k];
+            }
+            options->size_count = count;
+        } else if (strcmp(option, "--inputs") == 0) {
+            if ((count = parse_list(value, options->in_counts, MAX_SWEEP_COUNT)) < 1) {
+                return 1;
+            }
+            options->in_count_count = count;
+            for (int k = 0; k < count; k++) {
+                if (options->in_counts[k] > DWM_MA_MAX_INPUT_COUNT) {
+                    return 1;
+                }
+            }
+        } else if (strcmp(option, "--configs") == 0) {
+            if ((count = parse_list(value, values, MA_CONFIG_CUSTOM)) < 1) {
+                return 1;
+            }
+            for (int k = 0; k < count; k++) {
+                if (values[k] >= MA_CONFIG_CUSTOM) {
+                    return 1;
+                }
+                options->ma_configs[k] = (MA_CONFIG) values[k];
+            }
+            options->ma_config_count = count;
+        } else if (strcmp(option, "--seconds") == 0) {
+            options->seconds = atof(value);
+        } else if (strcmp(option, "--threads") == 0) {
+            options->thread_count = atoi(value);
+        } else if (strcmp(option, "--block") == 0) {
+            options->temporal_block_size = atoi(value);
+        } else if (strcmp(option, "--storage") == 0) {
+            int storage = 0;
+            while (storage < 3 && strcmp(value, STORAGE_NAMES[storage]) != 0) {
+                storage++;
+            }
+            if (storage == 3) {
+                return 1;
+            }
+            options->storage = (DWM_MA_STORAGE) storage;
+        } else if (strcmp(option, "--topology") == 0) {
+            int topology = 0;
+            while (topology < 2 && strcmp(value, TOPOLOGY_NAMES[topology]) != 0) {
+                topology++;
+            }
+            if (topology == 2) {
+                return 1;
+            }
+            options->topology = (DWM_MA_TOPOLOGY) topology;
+        } else if (strcmp(option, "--json") == 0) {
+            options->json_path = value;
+        } else {
+            return 1;
+        }
+    }
+    return options->seconds > 0.0 ? 0 : 1;
+}
+
+int run_case(const bench_options_t *options, const dwm_ma_mesh_config *config, const int in_count,
+             const MA_CONFIG ma_config, bench_result_t *result) {
+    void *dwm_ma;
+    if (dwm_ma_create_ex(&dwm_ma, config) != 0) {
+        return 1;
+    }
+    dwm_ma_set_thread_count(dwm_ma, options->thread_count);
+    dwm_ma_set_temporal_block_size(dwm_ma, options->temporal_block_size);
+    const float bound_params[6][2] = {{0.5f, 0.5f}, {0.5f, 0.5f}, {0.5f, 0.5f},
+                                      {0.5f, 0.5f}, {0.5f, 0.5f}, {0.5f, 0.5f}};
+    dwm_ma_init(dwm_ma, bound_params, 1);
+
+    // Inputs are spread along the mesh's diagonal and play white noise, the array being at the mesh's center
+    const int buffer_size = config->buffer_size;
+    const float junction_2_metric = dwm_ma_junction_size_m(config);
+    const float size_m[3] = {(float) config->size_x_j * junction_2_metric, (float) config->size_y_j * junction_2_metric,
+                             (float) config->size_z_j * junction_2_metric};
+    float in_positions[DWM_MA_MAX_INPUT_COUNT][3];
+    const float *in_positions_m[DWM_MA_MAX_INPUT_COUNT], *in_buffers[DWM_MA_MAX_INPUT_COUNT];
+    float *in_samples = malloc(sizeof(float) * DWM_MA_MAX_INPUT_COUNT * buffer_size);
+    float *out_samples = malloc(sizeof(float) * DWM_MA_MAX_OUTPUT_COUNT * buffer_size);
+    if (in_samples == NULL || out_samples == NULL) {
+        free(in_samples);
+        free(out_samples);
+        dwm_ma_destroy(&dwm_ma);
+        return 1;
+    }
+    float *ma_buffers[DWM_MA_MAX_OUTPUT_COUNT];
+    unsigned int seed = 1;
+    for (int i = 0; i < in_count; i++) {
+        const float t = ((float) i + 1.0f) / ((float) in_count + 1.0f);
+        for (int k = 0; k < 3; k++) {
+            in_positions[i][k] = t * size_m[k];
+        }
+        in_positions_m[i] = in_positions[i];
+        in_buffers[i] = in_samples + i * buffer_size;
+    }
+    for (int k = 0; k < DWM_MA_MAX_INPUT_COUNT * buffer_size; k++) {
+        seed = seed * 1664525u + 1013904223u;
+        in_samples[k] = (float) (seed >> 8) / (float) (1u << 24) - 0.5f;
+    }
+    for (int c = 0; c < DWM_MA_MAX_OUTPUT_COUNT; c++) {
+        ma_buffers[c] = out_samples + c * buffer_size;
+    }
+    const float ma_position_m[3] = {0.5f * size_m[0], 0.5f * size_m[1], 0.5f * size_m[2]};
+
+    // Warm up until the wavefronts crossed the whole mesh, then measure
+    const int fill_steps = config->size_x_j + config->size_y_j + config->size_z_j;
+    for (int n = 0; n < fill_steps + buffer_size; n += buffer_size) {
+        dwm_ma_process_interpolated(dwm_ma, in_buffers, in_positions_m, in_count, ma_config, 1.0f, ma_buffers,
+                                    ma_position_m);
+    }
+    long long buffer_count = 0;
+    const double begin = now_s();
+    double elapsed;
+    do {
+        dwm_ma_process_interpolated(dwm_ma, in_buffers, in_positions_m, in_count, ma_config, 1.0f, ma_buffers,
+                                    ma_position_m);
+        buffer_count++;
+        elapsed = now_s() - begin;
+    } while (elapsed < options->seconds || buffer_count < 3);
+
+    const double junction_updates = (double) buffer_count * buffer_size * config->size_x_j * config->size_y_j *
+                                    config->size_z_j;
+    result->size[0] = config->size_x_j;
+    result->size[1] = config->size_y_j;
+    result->size[2] = config->size_z_j;
+    result->in_count = in_count;
+    result->ma_config = ma_config;
+    result->buffer_count = buffer_count;
+    result->elapsed_s = elapsed;
+    result->ns_per_junction = elapsed * 1e9 / junction_updates;
+    result->mjunctions_per_s = junction_updates / elapsed * 1e-6;
+    result->realtime_factor = (double) buffer_count * buffer_size / config->sample_rate / elapsed;
+    free(in_samples);
+    free(out_samples);
+    dwm_ma_destroy(&dwm_ma);
+    return 0;
+}
+
+int write_json(const char *path, const bench_options_t *options, const dwm_ma_mesh_config *config,
+               const bench_result_t *results, const int result_count) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return 1;
+    }
+    fprintf(file, "{\n");
+    fprintf(file, "  \"compiled_size\": [%d, %d, %d],\n", DWM_MA_SIZE_X_J, DWM_MA_SIZE_Y_J, DWM_MA_SIZE_Z_J);
+    fprintf(file, "  \"sample_rate\": %d,\n", config->sample_rate);
+    fprintf(file, "  \"buffer_size\": %d,\n", config->buffer_size);
+    fprintf(file, "  \"storage\": \"%s\",\n", STORAGE_NAMES[options->storage]);
+    fprintf(file, "  \"topology\": \"%s\",\n", TOPOLOGY_NAMES[options->topology]);
+    fprintf(file, "  \"threads\": %d,\n", options->thread_count);
+    fprintf(file, "  \"temporal_block_size\": %d,\n", options->temporal_block_size);
+    fprintf(file, "  \"results\": [\n");
+    for (int r = 0; r < result_count; r++) {
+        const bench_result_t *result = &results[r];
+        fprintf(file,
+                "    {\"size\": [%d, %d, %d], \"inputs\": %d, \"ma_config\": \"%s\", \"buffers\": %lld, "
+                "\"elapsed_s\": %.6f, \"ns_per_junction\": %.4f, \"mjunctions_per_s\": %.3f, "
+                "\"realtime_factor\": %.3f}%s\n",
+                result->size[0], result->size[1], result->size[2], result->in_count,
+                MA_CONFIG_NAMES[result->ma_config], result->buffer_count, result->elapsed_s, result->ns_per_junction,
+                result->mjunctions_per_s, result->realtime_factor, r + 1 < result_count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0 ? 0 : 1;
+}
+
+double now_s(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec * 1e-9;
+}
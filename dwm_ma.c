@@ -1,9 +1,43 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "dwm_ma.h"
+#include "dwm_ma_convolver.h"
+#include "dwm_ma_internal.h"
+#include "dwm_ma_pool.h"
+#include "dwm_ma_resampler.h"
+#include "dwm_ma_simd.h"
 
 #include <assert.h>
+#include <fcntl.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__GNUC__)
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE inline
+#endif
+
+/**
+ * Amount of face junctions of an interpolated mesh updated at once by process_face_row_interpolated
+ */
+#define FACE_ROW_CHUNK 128
+
+/**
+ * Amount of output channels of a built-in layout or of an Ambisonics order, the most a dwm_ma_process_frames call split
+ * in parts writes without a custom layout
+ */
+#define PART_CAPACITY (DWM_MA_MAX_OUTPUT_COUNT > (MA_AMBISONICS_MAX_ORDER + 1) * (MA_AMBISONICS_MAX_ORDER + 1) \
+                               ? DWM_MA_MAX_OUTPUT_COUNT                                                   \
+                               : (MA_AMBISONICS_MAX_ORDER + 1) * (MA_AMBISONICS_MAX_ORDER + 1))
 
 // Internal structs and functions declarations
 
@@ -11,37 +45,363 @@
  * Internal dwm-ma boundary filter implementation, based on the solution described in
  * Kelloniemi, Antti. "Frequency-dependent boundary condition for the 3-D digital waveguide mesh." Proc. Int. Conf.
  * Digital Audio Effects (DAFx’06). 2006.
+ * @details Holds the filters of all the junctions of a face as a structure of arrays, indexed by the junction's
+ * coordinates on the two axes parallel to the face, so that a whole face is filtered by a single SIMD pass: each step
+ * out is filled with the face junctions' pressures, and then overwritten with their filtered values
  */
 typedef struct {
-    float t1, t2, t3;
+    float *t1, *t2, *t3;
+    float *out;
 } dwm_boundary_t;
 
 /**
- * Internal dwm-ma implementation, based on a rectilinear junction scheme with 1-D boundaries
+ * Internal dwm-ma per junction boundary parameters of a mesh face, see dwm_ma_set_boundary_map
+ * @details r1 and r2 hold the target filter values of each of the face's junctions, indexed as the face's
+ * dwm_boundary_t, and from_r1 and from_r2 the values a ramp starts from, each step of the ramp computing its values
+ * into ramp_r1 and ramp_r2. active is set while the face is filtered with its map rather than with its uniform values,
+ * and ramp while its pending ramp goes through the arrays (a map being on either end of it)
+ */
+typedef struct {
+    float *r1, *r2;
+    float *from_r1, *from_r2;
+    float *ramp_r1, *ramp_r2;
+    int active, ramp;
+} dwm_boundary_map_t;
+
+/**
+ * Internal dwm-ma edge junction, an air junction lying on a mesh face or next to a solid junction
+ * @details link holds, for each neighbour in order [Z-,Y-,X-,X+,Y+,Z+], the index of the link filtering the side facing
+ * the mesh face or a solid neighbour, or -1 if the neighbour is an air junction
+ */
+typedef struct {
+    int x;
+    int link[6];
+} dwm_edge_t;
+
+/**
+ * Internal dwm-ma voxelized room geometry, splitting the air junctions of each X row (rows ordered by Z and then by Y)
+ * in runs of plain junctions, all of whose neighbours are air junctions, updated by the SIMD row kernel, and edge
+ * junctions updated one by one. Solid junctions are never updated
+ * @details Each side of an edge junction facing the mesh face or a solid junction is a link, a 1-D boundary filter fed
+ * by the edge junction's pressure, which replaces the mesh faces' filters (dwm_ma_t::b) of box-shaped rooms. Links are
+ * stored as a structure of arrays sorted by Z-plane and then by group, groups being the six mesh faces in order
+ * [Z-,Y-,X-,X+,Y+,Z+] followed by the materials, so that each group of each Z-plane is filtered by a single SIMD pass
+ */
+typedef struct {
+    int *run_offsets;
+    int (*runs)[2];
+    int *edge_offsets;
+    dwm_edge_t *edges;
+    int *link_offsets;
+    int *link_junctions;
+    dwm_boundary_t links;
+    float (*material_params)[2];
+    int group_count;
+    uint64_t hash;
+} dwm_geometry_t;
+
+/**
+ * Internal dwm-ma microphone array of a processing call, either a built-in layout or the instance's custom layout,
+ * along with the per microphone working memory of the call: interpolation parameters, taps (see dwm_taps_t) and the
+ * values read on each of the two Z-planes sampled by each microphone
+ * @details Microphones are stored in reading order, channels holding the output channel of each. radius_m is expressed
+ * in junctions of radius_junction_m metric units. encoder_matrix is the array's Ambisonics encoding matrix, if the
+ * instance has an encoder, and part_buffers (custom layouts only) room for the output buffers of each channel from the
+ * part of a dwm_ma_process_frames call being processed on
+ */
+typedef struct {
+    int channel_count;
+    float radius_m, radius_junction_m;
+    const float (*mic_rel_xyz_j)[3];
+    const int *channels;
+    const float *encoder_matrix;
+    float (*int_percents)[3];
+    int (*int_indices)[2][2][2];
+    int *tap_planes, *tap_mics, *tap_halves;
+    float (*values)[2];
+    float **part_buffers;
+} dwm_mic_array_t;
+
+/**
+ * Internal dwm-ma built-in microphone array, a dwm_mic_array_t along with the memory it points to
+ */
+typedef struct {
+    dwm_mic_array_t mics;
+    float mic_rel_xyz_j[DWM_MA_MAX_OUTPUT_COUNT][3];
+    int channels[DWM_MA_MAX_OUTPUT_COUNT];
+    float int_percents[DWM_MA_MAX_OUTPUT_COUNT][3];
+    int int_indices[DWM_MA_MAX_OUTPUT_COUNT][2][2][2];
+    int tap_planes[DWM_MA_MAX_OUTPUT_COUNT * 2], tap_mics[DWM_MA_MAX_OUTPUT_COUNT * 2];
+    int tap_halves[DWM_MA_MAX_OUTPUT_COUNT * 2];
+    float values[DWM_MA_MAX_OUTPUT_COUNT][2];
+} dwm_builtin_mic_array_t;
+
+/**
+ * Internal dwm-ma Ambisonics encoder, see dwm_ma_set_ambisonics_order
+ * @details matrices holds the encoding matrix of each built-in layout, indexed by MA_CONFIG, followed by the one of the
+ * custom layout (NULL if the instance has none). The microphones of a processing call are read into mic_buffers, which
+ * are then encoded into its output buffers
+ */
+typedef struct {
+    int order, channel_count;
+    const float *matrices[MA_CONFIG_CUSTOM + 1];
+    float **mic_buffers;
+} dwm_encoder_t;
+
+/**
+ * Internal dwm-ma host rate adaptation, see dwm_ma_set_host_sample_rate
+ * @details The inputs of a processing call are resampled into in_buffers, which feed the mesh, and its outputs are
+ * written into out_buffers, which are then resampled into the call's output buffers. out_capacity is the amount of
+ * output channels out_resampler and out_buffers have room for, and frame_count the amount of host samples of the call:
+ * the call's mesh steps are the mesh samples in_resampler has for them, and out_resampler always has enough host
+ * samples for the call, keeping the rest for the next one
  */
 typedef struct {
-    float *p, *p_aux;
-    dwm_boundary_t *b_xp, *b_xn, *b_yp, *b_yn, *b_zp, *b_zn;
+    int sample_rate, buffer_size;
+    int frame_count;
+    int out_capacity;
+    void *in_resampler, *out_resampler;
+    float **in_buffers, **out_buffers;
+} dwm_host_t;
+
+/**
+ * Internal dwm-ma convolution rendering, see dwm_ma_capture_convolution
+ * @details The scene whose responses convolver holds is stored as passed to the capture, along with the boundary
+ * parameters it was captured with. mesh_tail counts the samples during which the mesh still produces the response of
+ * the inputs it had before convolution rendering started, and convolver_tail those during which the convolver still
+ * produces the response of the inputs it had before live rendering started
+ */
+typedef struct {
+    void *convolver;
+    int rir_length, block_size;
+    int in_count, out_count;
+    float in_positions_m[DWM_MA_MAX_INPUT_COUNT][3];
+    MA_CONFIG ma_config;
+    float ma_scale;
+    float ma_position_m[3];
+    float b_params[6][2];
+    int mesh_tail, convolver_tail;
+} dwm_convolution_t;
+
+/**
+ * Internal dwm-ma fused source injection and microphone capture of a processing call: the junctions written by the
+ * inputs and the Z-plane halves read by the microphones, each sorted by Z-plane, so that the stencil sweep writes and
+ * reads the junctions of each plane right after producing it instead of in separate passes over the mesh
+ * @details Sorting is stable, the taps of a Z-plane keeping the order of an unfused processing. source_n is the sample
+ * written by the inputs after the current step (-1 for none) and mic_n the sample read by the microphones, whose two
+ * halves are combined as soon as the upper one is read, unless ma_buffers is NULL. Microphone taps are stored in mics
+ */
+typedef struct {
+    int source_count;
+    int source_planes[DWM_MA_MAX_INPUT_COUNT * 8];
+    int source_junctions[DWM_MA_MAX_INPUT_COUNT * 8];
+    int source_inputs[DWM_MA_MAX_INPUT_COUNT * 8];
+    float source_weights[DWM_MA_MAX_INPUT_COUNT * 8];
+    int mic_count;
+    dwm_mic_array_t *mics;
+    const float *const *in_buffers;
+    float *const *ma_buffers;
+    int source_n, mic_n;
+} dwm_taps_t;
+
+/**
+ * Internal dwm-ma setup of a processing call: the interpolation parameters of each input, the microphone array (the
+ * built-in one being stored in builtin) and their taps
+ * @details The setup of a call whose objects are all still is kept for the next calls with the same scene, which is
+ * stored along with it while valid is set: the first in_count in_positions_m, ma_config, ma_scale (clamped) and
+ * ma_position_m. A call with a moving object, a custom layout change or an Ambisonics order change clears valid
+ */
+typedef struct {
+    int valid;
+    int in_count;
+    float in_positions_m[DWM_MA_MAX_INPUT_COUNT][3];
+    MA_CONFIG ma_config;
+    float ma_scale;
+    float ma_position_m[3];
+    float input_int_percents[DWM_MA_MAX_INPUT_COUNT][3];
+    int input_int_indices[DWM_MA_MAX_INPUT_COUNT][2][2][2];
+    dwm_mic_array_t *mics;
+    dwm_builtin_mic_array_t builtin;
+    dwm_taps_t taps;
+} dwm_setup_t;
+
+/**
+ * Internal dwm-ma implementation, based on a rectilinear or interpolated junction scheme (see DWM_MA_TOPOLOGY) with 1-D
+ * boundaries
+ * @details The active region is a box of junctions (in order X, Y, Z, end excluded) out of which both pressure buffers
+ * and all boundary filter states are 0. A silent junction whose neighbours are silent stays silent, thus each step only
+ * updates its update region, the active region grown by one junction along each axis, which then becomes the active
+ * region: the simulation skips the parts of the mesh the sources' wavefronts did not reach yet. taps is only set during
+ * a processing call. custom_layout is the layout used for MA_CONFIG_CUSTOM, if any, encoder the Ambisonics output
+ * stage, if any, host the resampling between the host's rate and sample_rate, if any, and convolution the captured
+ * responses of a still scene, if any. stats_timing is set while the phases of a processing call are timed, each lap
+ * accounting the time elapsed since stats_lap_ns to a phase. The memory block is either owned_memory, a mapping of a
+ * snapshot file (mapped_memory) or the caller's, and snapshot_links holds the links' filter states of a loaded
+ * snapshot, whose geometry hashes to snapshot_geometry_hash, until its geometry is set again. Boundary parameter
+ * changes ramp from b_params_from to b_params over the buffer following them on each face whose b_ramp is set, b_step
+ * being the step of the buffer being processed. frame_count is the amount of steps of the processing call (buffer_size,
+ * bar for dwm_ma_process_frames calls, host rate adaptation and the parts of longer calls), call_frame_count its
+ * amount of samples at the rate of the buffers it exchanges, and setup the setup of the last one. part_buffers holds
+ * the output buffers of each channel from the part of a dwm_ma_process_frames call being processed on
+ */
+typedef struct dwm_ma_t {
+    void *p, *p_aux;
+    DWM_MA_STORAGE storage;
+    DWM_MA_TOPOLOGY topology;
+    dwm_boundary_t b[6];
     float b_params[6][2];
+    float b_params_from[6][2];
+    dwm_boundary_map_t *b_maps[6];
+    int b_ramp[6];
+    int b_step;
+    int size_x_j, size_y_j, size_z_j;
+    int sample_rate, buffer_size;
+    int frame_count, call_frame_count;
+    float sound_propagation_speed;
+    float metric_2_junction, junction_2_metric;
+    float size_m[3];
+    void (*process_slab)(struct dwm_ma_t *handle, int z_begin, int z_end);
+    dwm_ma_row_kernel_t row_kernel;
+    dwm_ma_row_kernel_16_t row_kernel_16;
+    dwm_ma_boundary_kernel_t boundary_kernel;
+    dwm_ma_boundary_map_kernel_t boundary_map_kernel;
+    dwm_ma_encode_kernel_t encode_kernel;
+    void *pool;
+    int temporal_block_size;
+    void *owned_memory;
+    void *mapped_memory;
+    size_t mapped_size;
+    int active_begin[3], active_end[3];
+    int update_begin[3], update_end[3];
+    dwm_geometry_t *geometry;
+    const float *snapshot_links;
+    int snapshot_link_count;
+    uint64_t snapshot_geometry_hash;
+    dwm_taps_t *taps;
+    dwm_setup_t setup;
+    dwm_mic_array_t *custom_layout;
+    dwm_encoder_t *encoder;
+    dwm_host_t *host;
+    dwm_convolution_t *convolution;
+    float *part_buffers[PART_CAPACITY];
+    int stats_enabled, stats_timing;
+    uint64_t stats_lap_ns;
+    dwm_ma_stats stats;
 } dwm_ma_t;
 
+/**
+ * Checks at runtime the same constraints dwm_ma_create asserts at compile time
+ * @return non-zero if the mesh configuration is valid
+ */
+static int is_config_valid(const dwm_ma_mesh_config *config);
+
+/**
+ * Computes the placement of an instance inside a single memory block, every section starting at a
+ * DWM_MA_MEMORY_ALIGNMENT aligned offset
+ * @param config valid mesh configuration
+ * @param b_offsets resulting byte offset of each face's boundary filters, in order [Z-,Y-,X-,X+,Y+,Z+]
+ * @param p_offset resulting byte offset of the junction pressures
+ * @param p_aux_offset resulting byte offset of the auxiliary junction pressures
+ * @return the size in bytes of the memory block, excluding the slack needed to align its start
+ */
+static size_t compute_memory_layout(const dwm_ma_mesh_config *config, size_t b_offsets[6], size_t *p_offset,
+                                    size_t *p_aux_offset);
+
+/**
+ * Fills the mesh configuration an instance was created with
+ * @param handle dwm-ma handle
+ * @param config mesh configuration to be filled
+ */
+static void get_mesh_config(const dwm_ma_t *handle, dwm_ma_mesh_config *config);
+
+/**
+ * Copies the simulation state (junction pressures and mesh faces' boundary filter states) of an instance into a memory
+ * block image of the same mesh configuration, p landing at its p_offset and p_aux at its p_aux_offset
+ * @param handle dwm-ma handle
+ * @param block memory block image, laid out as by compute_memory_layout
+ */
+static void copy_state_to_block(const dwm_ma_t *handle, char *block);
+
+/**
+ * Copies a geometry, whose memory block holds pointers to itself
+ * @param geometry geometry to be copied
+ * @return the copy, or NULL if it cannot be allocated
+ */
+static dwm_geometry_t *copy_geometry(const dwm_geometry_t *geometry);
+
+/**
+ * Applies the settings of an instance (geometry, custom layout, Ambisonics order, host's sampling rate, threads and
+ * statistics) to another instance of the same mesh configuration, see dwm_ma_clone
+ * @return 0 on success, non-zero if any setting cannot be allocated
+ */
+static int copy_settings(dwm_ma_t *copy, const dwm_ma_t *handle);
+
+/**
+ * Rounds a size up to the next multiple of DWM_MA_MEMORY_ALIGNMENT
+ */
+static size_t align_size(size_t size);
+
 /**
  * Computes the linearized junction index inside the 3D volume, given each axis' junction coordinate
  */
-static int linearized_index_xyz(int x_j, int y_j, int z_j);
+static int linearized_index_xyz(const dwm_ma_t *handle, int x_j, int y_j, int z_j);
+
+/**
+ * Size in bytes of a junction pressure stored in a storage format
+ */
+static size_t storage_size(DWM_MA_STORAGE storage);
+
+/**
+ * Loads a junction pressure stored in a storage format
+ * @param p junction pressures
+ * @param i linearized junction index
+ * @param storage storage format of p
+ * @note Always inlined, so that storage format conversions are resolved at compile time in the slab code paths
+ */
+static ALWAYS_INLINE float load_junction(const void *p, int i, DWM_MA_STORAGE storage);
+
+/**
+ * Stores a junction pressure in a storage format
+ * @param p junction pressures
+ * @param i linearized junction index
+ * @param value junction pressure
+ * @param storage storage format of p
+ */
+static ALWAYS_INLINE void store_junction(void *p, int i, float value, DWM_MA_STORAGE storage);
+
+/**
+ * Loads a strided sequence of junction pressures stored in a storage format
+ * @param dst loaded junction pressures
+ * @param p junction pressures
+ * @param i linearized index of the first junction
+ * @param count amount of junctions loaded
+ * @param stride linearized index distance between two loaded junctions
+ * @param storage storage format of p
+ */
+static ALWAYS_INLINE void load_junctions(float *dst, const void *p, int i, int count, int stride,
+                                         DWM_MA_STORAGE storage);
+
+/**
+ * Computes the amount of junctions lying on a face
+ * @param handle dwm-ma handle
+ * @param face face index, in order [Z-,Y-,X-,X+,Y+,Z+]
+ */
+static int face_size_j(const dwm_ma_t *handle, int face);
 
 /**
  * Computes the interpolation parameters for a metric units coordinate
+ * @param handle dwm-ma handle
  * @param pos_m metric units XYZ position
  * @param interp_percents resulting XYZ interpolation percentages
  * @param interp_indices resulting X[0,1]-Y[0,1]-Z[0,1] interpolation coordinate
  * @note coordinates outside the mesh are clamped inside to valid coordinates
  */
-static void compute_interpolation_parameters_m(const float *pos_m, float interp_percents[3],
+static void compute_interpolation_parameters_m(const dwm_ma_t *handle, const float *pos_m, float interp_percents[3],
                                                int interp_indices[2][2][2]);
 
 /**
  * Computes the interpolation parameters for a relative mic array coordinate
+ * @param handle dwm-ma handle
  * @param pos_j_rel relative junction mic XYZ position
  * @param pos_m_offset metric units mic array XYZ position offset
  * @param ma_scale relative junction mic position scaling factor
@@ -49,373 +409,3083 @@ static void compute_interpolation_parameters_m(const float *pos_m, float interp_
  * @param interp_indices resulting X[0,1]-Y[0,1]-Z[0,1] interpolation coordinate
  * @note coordinates outside the mesh are clamped inside to valid coordinates
  */
-static void compute_interpolation_parameters_ma(const int *pos_j_rel, const float *pos_m_offset, float ma_scale,
-                                                float interp_percents[3], int interp_indices[2][2][2]);
+static void compute_interpolation_parameters_ma(const dwm_ma_t *handle, const float *pos_j_rel,
+                                                const float *pos_m_offset, float ma_scale, float interp_percents[3],
+                                                int interp_indices[2][2][2]);
 
 /**
- * Writes a value using pre-computed interpolation parameters
+ * Selects the microphone array of a processing call
+ * @param handle dwm-ma handle
+ * @param ma_config microphone array configuration
+ * @param builtin memory of the array, used if the configuration is a built-in layout
+ * @return the array, MA_CONFIG_CUSTOM resulting in the instance's custom layout if it has one
+ */
+static dwm_mic_array_t *select_mic_array(dwm_ma_t *handle, MA_CONFIG ma_config, dwm_builtin_mic_array_t *builtin);
+
+/**
+ * Computes the interpolation parameters of every microphone of an array
+ * @param handle dwm-ma handle
+ * @param mics microphone array, whose interpolation parameters are computed
+ * @param ma_scale microphone array scale
+ * @param ma_position_m metric units XYZ position of the array's center
+ * @note The array's center is moved to the nearest position keeping the entire array inside the mesh
+ */
+static void compute_ma_interpolation_parameters(const dwm_ma_t *handle, dwm_mic_array_t *mics, float ma_scale,
+                                                const float *ma_position_m);
+
+/**
+ * Creates an Ambisonics encoder for the built-in layouts and a custom layout
+ * @param handle dwm-ma handle
+ * @param order Ambisonics order, in [0, MA_AMBISONICS_MAX_ORDER]
+ * @param custom_layout custom layout, or NULL
+ * @return the encoder, to be released with free, or NULL if it cannot be allocated
+ */
+static dwm_encoder_t *create_encoder(const dwm_ma_t *handle, int order, const dwm_mic_array_t *custom_layout);
+
+/**
+ * Encodes the microphones read by a processing call to Ambisonics, if the instance has an encoder, and resamples its
+ * outputs to the host's rate, if the instance has a host rate
+ * @param handle dwm-ma handle
+ * @param mics microphone array of the call
+ * @param ma_buffers output buffers of the call
+ * @return the amount of output channels written
+ */
+static int write_outputs(const dwm_ma_t *handle, const dwm_mic_array_t *mics, float *const *ma_buffers);
+
+/**
+ * Creates the resampling between a host's rate and the mesh's rate
+ * @param handle dwm-ma handle
+ * @param sample_rate host's sampling rate
+ * @param custom_layout custom layout, or NULL
+ * @return the host rate adaptation, to be released with destroy_host, or NULL if the rates are not compatible or it
+ * cannot be allocated
+ */
+static dwm_host_t *create_host(const dwm_ma_t *handle, int sample_rate, const dwm_mic_array_t *custom_layout);
+
+/**
+ * Destroys a host rate adaptation
+ * @param host host rate adaptation, or NULL
+ */
+static void destroy_host(dwm_host_t *host);
+
+/**
+ * Destroys the captured responses of an instance, if any, returning to live rendering only
+ * @param handle dwm-ma handle
+ */
+static void destroy_convolution(dwm_ma_t *handle);
+
+/**
+ * Checks whether a processing call renders the scene captured by dwm_ma_capture_convolution
+ * @return non-zero if every object is still, at its captured position, and the boundary parameters did not change
+ */
+static int is_captured_scene(const dwm_ma_t *handle, const float *const *in_positions_start_m,
+                             const float *const *in_positions_end_m, int in_count, MA_CONFIG ma_config,
+                             float ma_scale, const float *ma_position_start_m, const float *ma_position_end_m);
+
+/**
+ * Checks whether the setup of the previous processing call holds for a call whose objects are all still
+ * @return non-zero if the setup is valid and its scene is the same
+ */
+static int is_setup_cached(const dwm_ma_t *handle, const float *const *in_positions_m, int in_count,
+                           MA_CONFIG ma_config, float ma_scale, const float *ma_position_m);
+
+/**
+ * Amount of output channels of a processing call
+ * @param handle dwm-ma handle
+ * @param ma_config microphone array configuration of the call
+ * @return the amount of Ambisonics channels if the instance has an encoder, or else of microphones
+ */
+static int output_count(const dwm_ma_t *handle, MA_CONFIG ma_config);
+
+/**
+ * Renders frame_count samples (no more than a buffer, at the host's rate if the instance has one), by convolution for
+ * the captured scene and by simulation otherwise, with the same other parameters as dwm_ma_process_trajectory
+ */
+static void process_scene(dwm_ma_t *handle, const float *const *in_buffers, const float *const *in_positions_start_m,
+                          const float *const *in_positions_end_m, int in_count, MA_CONFIG ma_config, float ma_scale,
+                          float *const *ma_buffers, const float *ma_position_start_m, const float *ma_position_end_m,
+                          int frame_count);
+
+/**
+ * Simulates frame_count samples in the mesh, with the same parameters as dwm_ma_process_trajectory
+ * @return the amount of output channels written
+ */
+static int process_live(dwm_ma_t *handle, const float *const *in_buffers, const float *const *in_positions_start_m,
+                        const float *const *in_positions_end_m, int in_count, MA_CONFIG ma_config, float ma_scale,
+                        float *const *ma_buffers, const float *ma_position_start_m, const float *ma_position_end_m);
+
+/**
+ * Sets the whole simulation state (mesh, boundary filters and resamplers) to silence, keeping the boundary parameters
  * @param handle dwm-ma handle
- * @param value value to be written
- * @param interp_percents pre-computed XYZ interpolation percentages
- * @param interp_indices pre-computed X[0,1]-Y[0,1]-Z[0,1] interpolation coordinate
  */
-static void write_value_interp_params(const dwm_ma_t *handle, float value, const float interp_percents[3],
-                                      const int interp_indices[2][2][2]);
+static void clear_state(dwm_ma_t *handle);
 
 /**
- * Reads a value using pre-computed interpolation parameters
+ * Resamples the boundary filter states of a mesh face of another instance of the same room, see dwm_ma_transfer_state
+ * @param handle dwm-ma handle, whose face states are replaced
+ * @param src dwm-ma handle, whose face states are read
+ * @param face mesh face, in order [Z-,Y-,X-,X+,Y+,Z+]
+ */
+static void transfer_face(dwm_ma_t *handle, const dwm_ma_t *src, int face);
+
+/**
+ * Linearly interpolates between two XYZ positions
+ * @param start position at t = 0
+ * @param end position at t = 1
+ * @param t interpolation percentage
+ * @param position resulting position
+ */
+static void lerp_position(const float *start, const float *end, float t, float position[3]);
+
+/**
+ * Reads the bilinearly interpolated value of one of the two Z-planes sampled by pre-computed interpolation parameters
  * @param handle dwm-ma handle
+ * @param p junction pressures to be read
  * @param interp_percents pre-computed XYZ interpolation percentages
  * @param interp_indices pre-computed X[0,1]-Y[0,1]-Z[0,1] interpolation coordinate
+ * @param z_i Z-plane to be read, 0 for the lower one and 1 for the upper one
+ */
+static float read_plane_interp_params(const dwm_ma_t *handle, const void *p, const float interp_percents[3],
+                                      const int interp_indices[2][2][2], int z_i);
+
+/**
+ * Fills the source taps of a processing call, in the same order as the inputs write their junctions
+ * @param handle dwm-ma handle
+ * @param in_count amount of inputs processed
+ * @param input_int_percents pre-computed interpolation percentages of each input
+ * @param input_int_indices pre-computed interpolation coordinates of each input
+ * @param taps taps whose source taps are filled
+ */
+static void build_source_taps(const dwm_ma_t *handle, int in_count, const float input_int_percents[][3],
+                              const int input_int_indices[][2][2][2], dwm_taps_t *taps);
+
+/**
+ * Fills the microphone taps of a processing call, each microphone reading its lower Z-plane half before its upper one
+ * @param handle dwm-ma handle
+ * @param taps taps whose microphone taps are filled, from the pre-computed interpolation coordinates of taps->mics
+ */
+static void build_mic_taps(const dwm_ma_t *handle, dwm_taps_t *taps);
+
+/**
+ * Finds the first tap lying on a Z-plane or after it
+ * @param planes sorted Z-plane of each tap
+ * @param count amount of taps
+ * @param z_j Z-plane searched
+ * @return index of the first tap whose Z-plane is not lower than z_j, count if there is none
+ */
+static int first_tap(const int *planes, int count, int z_j);
+
+/**
+ * Writes one sample of every input through its source taps, from a given tap up to a Z-plane
+ * @param handle dwm-ma handle
+ * @param taps taps of the processing call
+ * @param p junction pressures to be written
+ * @param n sample written
+ * @param s first source tap written
+ * @param z_end Z-plane following the last one written
+ * @return index of the first source tap not written
  */
-static float read_value_interp_params(const dwm_ma_t *handle, const float interp_percents[3],
-                                      const int interp_indices[2][2][2]);
+static int write_source_taps(const dwm_ma_t *handle, const dwm_taps_t *taps, void *p, int n, int s, int z_end);
 
 /**
- * Progress the simulation state by one step on the whole mesh
+ * Reads the microphones through their taps, from a given tap up to a Z-plane, see dwm_taps_t
  * @param handle dwm-ma handle
+ * @param taps taps of the processing call
+ * @param p junction pressures to be read
+ * @param m first microphone tap read
+ * @param z_end Z-plane following the last one read
+ * @return index of the first microphone tap not read
+ */
+static int read_mic_taps(const dwm_ma_t *handle, dwm_taps_t *taps, const void *p, int m, int z_end);
+
+/**
+ * Runs the simulation iterations of a buffer in temporal blocks, as described in dwm_ma_set_temporal_block_size
+ * @param handle dwm-ma handle, whose taps are set
+ */
+static void process_buffer_blocked(dwm_ma_t *handle);
+
+/**
+ * Progress the simulation state by one step on the whole mesh, writing the inputs' sample taps->source_n and reading
+ * the microphones' sample taps->mic_n
+ * @param handle dwm-ma handle, whose taps are set
+ * @note Only the update region is progressed, see dwm_ma_t
  */
 static void process_iteration(dwm_ma_t *handle);
 
 /**
- * Progress a boundary's simulation state by one step and filter an input sample
- * @param b boundary position handle
- * @param in input sample
- * @param r R1 and R2 filter values
- * @return the filtered in value
+ * Progress the simulation state by one step on a slab of Z-planes, writing and reading the taps of each plane right
+ * after producing it
+ * @param handle dwm-ma handle, whose taps are set
+ * @param z_begin first Z-plane of the slab
+ * @param z_end Z-plane following the last one of the slab
  */
-static float process_boundary(dwm_boundary_t *b, float in, const float r[2]);
+static void process_slab_taps(dwm_ma_t *handle, int z_begin, int z_end);
 
 /**
- * Minimum of two integers
+ * Empties the active region, all junctions being silent
+ * @param handle dwm-ma handle
  */
-static int mini(int a, int b);
+static void clear_active_region(dwm_ma_t *handle);
 
 /**
- * Maximum of two integers
+ * Extends the active region to the junctions written by a source
+ * @param handle dwm-ma handle
+ * @param interp_indices interpolation coordinates of the source
  */
-static int maxi(int a, int b);
+static void extend_active_region(dwm_ma_t *handle, const int interp_indices[2][2][2]);
 
 /**
- * First value limited to be between the second and third arguments
+ * Computes the region reachable from the active region after a given amount of steps
+ * @param handle dwm-ma handle
+ * @param steps amount of steps
+ * @param begin resulting first junction of the region along each axis
+ * @param end resulting junction following the last one of the region along each axis
+ * @note begin and end may be the active region itself
  */
-static int clampi(int v, int min, int max);
+static void dilate_active_region(const dwm_ma_t *handle, int steps, int begin[3], int end[3]);
 
 /**
- * First value limited to be between the second and third arguments
- * @note min must be less or equal than max
+ * Progress the simulation state by one step on a slab of Z-planes
+ * @param handle dwm-ma handle
+ * @param z_begin first Z-plane of the slab
+ * @param z_end Z-plane following the last one of the slab
+ * @param size_x_j junctions size on the X-axis
+ * @param size_y_j junctions size on the Y-axis
+ * @param size_z_j junctions size on the Z-axis
+ * @param storage storage format of the junction pressures
+ * @note The slab's boundary filters are all progressed first, by process_boundaries, and the junction updates then
+ * only read their outputs
+ * @note Slabs never share boundary filters, so disjoint slabs can be processed concurrently
+ * @note Always inlined, so that the mesh sizes (and thus all strides) and the storage format are compile-time
+ * constants in the specialized code paths selected by dwm_ma_create_ex
  */
-static float fclampf(float v, float min, float max);
+static ALWAYS_INLINE void process_slab_sized(dwm_ma_t *handle, int z_begin, int z_end, int size_x_j, int size_y_j,
+                                             int size_z_j, DWM_MA_STORAGE storage);
 
 /**
- * Floating point unclamped linear interpolation between a and b controlled by percentage f
+ * Generic slab processing code path, with the mesh sizes read from the handle
  */
-float flerpf(float a, float b, float f);
+static void process_slab_generic(dwm_ma_t *handle, int z_begin, int z_end);
 
-// Function definitions
+/**
+ * Generic slab processing code path of meshes stored as IEEE half precision values
+ */
+static void process_slab_generic_f16(dwm_ma_t *handle, int z_begin, int z_end);
 
-void dwm_ma_create(void **dwm_ma) {
-    // Assert at compile time that the user-redefinable definitions have legal values
-    static_assert(DWM_MA_SAMPLE_RATE >= 1, "dwm-ma DSP sample rate must be greater or equal than 1");
-    static_assert(DWM_MA_BUFFER_SIZE >= 1, "dwm-ma DSP buffer size must be greater or equal than 1");
-    static_assert(DWM_MA_SIZE_X_J >= 3, "dwm-ma junctions size on the X-axis must be greater or equal than 3");
-    static_assert(DWM_MA_SIZE_Y_J >= 3, "dwm-ma junctions size on the Y-axis must be greater or equal than 3");
-    static_assert(DWM_MA_SIZE_Z_J >= 3, "dwm-ma junctions size on the Z-axis must be greater or equal than 3");
-    static_assert(DWM_MA_SOUND_PROPAGATION_SPEED >= 1, "dwm-ma sound propagation speed must be greater than 0");
-    static_assert(DWM_MA_MAX_INPUT_COUNT >= 1, "dwm-ma sample rate must be greater or equal than 1");
+/**
+ * Generic slab processing code path of meshes stored as bfloat16 values
+ */
+static void process_slab_generic_bf16(dwm_ma_t *handle, int z_begin, int z_end);
 
-    // Allocate all resources
-    dwm_ma_t *handle = malloc(sizeof(dwm_ma_t));
-    handle->p = (float *) malloc(sizeof(float) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Y_J * DWM_MA_SIZE_Z_J);
-    handle->p_aux = (float *) malloc(sizeof(float) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Y_J * DWM_MA_SIZE_Z_J);
-    handle->b_xp = (dwm_boundary_t *) malloc(sizeof(dwm_boundary_t) * DWM_MA_SIZE_Y_J * DWM_MA_SIZE_Z_J);
-    handle->b_xn = (dwm_boundary_t *) malloc(sizeof(dwm_boundary_t) * DWM_MA_SIZE_Y_J * DWM_MA_SIZE_Z_J);
-    handle->b_yp = (dwm_boundary_t *) malloc(sizeof(dwm_boundary_t) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Z_J);
-    handle->b_yn = (dwm_boundary_t *) malloc(sizeof(dwm_boundary_t) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Z_J);
-    handle->b_zp = (dwm_boundary_t *) malloc(sizeof(dwm_boundary_t) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Y_J);
-    handle->b_zn = (dwm_boundary_t *) malloc(sizeof(dwm_boundary_t) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Y_J);
-    *dwm_ma = handle;
-}
+/**
+ * Progress the simulation state by one step on a slab of Z-planes of an interpolated mesh, see process_slab_sized
+ */
+static ALWAYS_INLINE void process_slab_interpolated_sized(dwm_ma_t *handle, int z_begin, int z_end, int size_x_j,
+                                                          int size_y_j, int size_z_j);
 
-void dwm_ma_destroy(void **dwm_ma) {
-    dwm_ma_t *handle = *dwm_ma;
+/**
+ * Generic slab processing code path of interpolated meshes, with the mesh sizes read from the handle
+ */
+static void process_slab_interpolated(dwm_ma_t *handle, int z_begin, int z_end);
 
-    // Free all resources
-    free(handle->p);
-    free(handle->p_aux);
-    free(handle->b_xp);
-    free(handle->b_xn);
-    free(handle->b_yp);
-    free(handle->b_yn);
-    free(handle->b_zp);
-    free(handle->b_zn);
-    free(handle);
-    *dwm_ma = NULL;
-}
+/**
+ * Progress the simulation state by one step on a slab of Z-planes of a mesh with a voxelized room geometry, see
+ * process_slab_sized
+ * @note Each Z-plane's links are progressed right before its junctions, while the plane is still cached
+ */
+static ALWAYS_INLINE void process_slab_masked_sized(dwm_ma_t *handle, int z_begin, int z_end, int size_x_j,
+                                                    int size_y_j, DWM_MA_STORAGE storage);
 
-void dwm_ma_init(void *dwm_ma, const float dwm_bound_params[6][2], const int dwm_bound_params_normalized) {
-    dwm_ma_t *handle = dwm_ma;
+/**
+ * Slab processing code path of meshes with a voxelized room geometry, stored as 32-bit floating point values
+ */
+static void process_slab_masked(dwm_ma_t *handle, int z_begin, int z_end);
 
-    // Set initial memory state, assumes IEEE 754 float representation where 0-ed out bits correspond to 0.0f
-    memset(handle->p, 0, sizeof(float) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Y_J * DWM_MA_SIZE_Z_J);
-    memset(handle->p_aux, 0, sizeof(float) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Y_J * DWM_MA_SIZE_Z_J);
-    memset(handle->b_xp, 0, sizeof(dwm_boundary_t) * DWM_MA_SIZE_Y_J * DWM_MA_SIZE_Z_J);
-    memset(handle->b_xn, 0, sizeof(dwm_boundary_t) * DWM_MA_SIZE_Y_J * DWM_MA_SIZE_Z_J);
-    memset(handle->b_yp, 0, sizeof(dwm_boundary_t) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Z_J);
-    memset(handle->b_yn, 0, sizeof(dwm_boundary_t) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Z_J);
-    memset(handle->b_zp, 0, sizeof(dwm_boundary_t) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Y_J);
-    memset(handle->b_zn, 0, sizeof(dwm_boundary_t) * DWM_MA_SIZE_X_J * DWM_MA_SIZE_Y_J);
-
-    // Handle the boundary parameters
-    if (dwm_bound_params_normalized != 0) {
-        // If the parameters are given as normalized admittance & normalized low-pass cutoff, convert to R1 and R2
-        for (int i = 0; i < 6; i++) {
-            handle->b_params[i][0] = (1 - dwm_bound_params[i][1]) * 0.25f * dwm_bound_params[i][0];
-            handle->b_params[i][1] = dwm_bound_params[i][0] * (1 - (1 - dwm_bound_params[i][1]) * 0.5f);
-        }
-    } else {
-        // Otherwise copy R1, R2
-        memcpy(handle->b_params, dwm_bound_params, sizeof(float) * 6 * 2);
-    }
-}
+/**
+ * Slab processing code path of meshes with a voxelized room geometry, stored as IEEE half precision values
+ */
+static void process_slab_masked_f16(dwm_ma_t *handle, int z_begin, int z_end);
 
-void dwm_ma_process_interpolated(void *dwm_ma, const float *const *in_buffers, const float *const *in_positions_m,
-                                 int in_count, const MA_CONFIG ma_config, float ma_scale, float *const *ma_buffers,
-                                 const float *ma_position_m) {
-    dwm_ma_t *handle = dwm_ma;
+/**
+ * Slab processing code path of meshes with a voxelized room geometry, stored as bfloat16 values
+ */
+static void process_slab_masked_bf16(dwm_ma_t *handle, int z_begin, int z_end);
 
-    // Protect against non-valid parameters
-    ma_scale = fclampf(ma_scale, 1.0f, 10.0f);
-    in_count = clampi(in_count, 0, DWM_MA_MAX_INPUT_COUNT);
+/**
+ * Selects the slab processing code path of an instance, from its mesh size, storage format, topology and geometry
+ * @param handle dwm-ma handle
+ */
+static void select_process_slab(dwm_ma_t *handle);
 
-    // Preprocess each input coordinate's interpolation parameters, since they are the same during the entire buffer
-    float input_int_percents[DWM_MA_MAX_INPUT_COUNT][3];
-    int input_int_indices[DWM_MA_MAX_INPUT_COUNT][2][2][2];
-    for (int i = 0; i < in_count; i++) {
-        compute_interpolation_parameters_m(in_positions_m[i], input_int_percents[i], input_int_indices[i]);
-    }
+/**
+ * Thread pool task processing, along with their taps, the thread_index-th of thread_count equally sized slabs
+ */
+static void process_taps_task(void *context, int thread_index, int thread_count);
 
-    // Preprocess the microphone array position such that the entire radius is inside the mesh bounds
-    const ma_layout *ma = ma_config_layout(ma_config);
-    float ma_position_m_restricted[3];
-    ma_position_m_restricted[0] =
-            fclampf(ma_position_m[0], ma->radius_m * ma_scale, DWM_MA_SIZE_X_M - ma->radius_m * ma_scale);
-    ma_position_m_restricted[1] =
-            fclampf(ma_position_m[1], ma->radius_m * ma_scale, DWM_MA_SIZE_Y_M - ma->radius_m * ma_scale);
-    ma_position_m_restricted[2] =
-            fclampf(ma_position_m[2], ma->radius_m * ma_scale, DWM_MA_SIZE_Z_M - ma->radius_m * ma_scale);
-
-    // Preprocess the output microphone array's interpolation parameters, since they are the same during the entire
-    // buffer
-    float output_int_percents[DWM_MA_MAX_OUTPUT_COUNT][3];
-    int output_int_indices[DWM_MA_MAX_OUTPUT_COUNT][2][2][2];
-    for (int i = 0; i < ma->channel_count; i++) {
-        compute_interpolation_parameters_ma(ma->mic_rel_xyz_j[i], ma_position_m_restricted, ma_scale,
-                                            output_int_percents[i], output_int_indices[i]);
-    }
+/**
+ * Progress the boundary filters of every face junction inside a slab of Z-planes by one step
+ * @param handle dwm-ma handle
+ * @param z_begin first Z-plane of the slab
+ * @param z_end Z-plane following the last one of the slab
+ * @param size_x_j junctions size on the X-axis
+ * @param size_y_j junctions size on the Y-axis
+ * @param size_z_j junctions size on the Z-axis
+ * @param storage storage format of the junction pressures
+ */
+static ALWAYS_INLINE void process_boundaries(dwm_ma_t *handle, int z_begin, int z_end, int size_x_j, int size_y_j,
+                                             int size_z_j, DWM_MA_STORAGE storage);
 
-    // Run DWM_MA_BUFFER_SIZE simulation iterations
-    for (int n = 0; n < DWM_MA_BUFFER_SIZE; n++) {
-        // Write all sources
-        for (int i = 0; i < in_count; i++) {
-            write_value_interp_params(handle, in_buffers[i][n], input_int_percents[i], input_int_indices[i]);
-        }
-        process_iteration(handle); // Single simulation interation
-        // Read all mic outputs
-        for (int i = 0; i < ma->channel_count; i++) {
-            ma_buffers[i][n] = read_value_interp_params(handle, output_int_percents[i], output_int_indices[i]);
-        }
-        {
-            float *aux = handle->p; // Post iteration buffer swapping
-            handle->p = handle->p_aux;
-            handle->p_aux = aux;
-        }
-    }
-}
+/**
+ * Computes the damping of every face junction of an interpolated mesh inside a slab of Z-planes into the face filters'
+ * outputs, from the boundary parameters of process_boundaries
+ * @param handle dwm-ma handle
+ * @param z_begin first Z-plane of the slab
+ * @param z_end Z-plane following the last one of the slab
+ * @param size_x_j junctions size on the X-axis
+ * @param size_y_j junctions size on the Y-axis
+ * @param size_z_j junctions size on the Z-axis
+ * @details The filter's reflectance is R1 + R2 * z^-1 + R1 * z^-2, and a face junction's damping is
+ * (1 - R) / (1 + R) with R its static reflectance 2 * R1 + R2 clamped to [0, 1], so that a rigid face (R = 1) is not
+ * damped. The filters' states are left untouched
+ */
+static void process_boundary_dampings(dwm_ma_t *handle, int z_begin, int z_end, int size_x_j, int size_y_j,
+                                      int size_z_j);
 
-static int linearized_index_xyz(const int x_j, const int y_j, const int z_j) {
-    return (z_j * DWM_MA_SIZE_Y_J + y_j) * DWM_MA_SIZE_X_J + x_j;
-}
-
-void compute_interpolation_parameters_m(const float *pos_m, float interp_percents[3], int interp_indices[2][2][2]) {
-    // Translate the metric coordinates to valid floating point junction coordinates
-    const float x_j = fclampf(pos_m[0] * _DWM_MA_METRIC_2_JUNCTION - 0.5f, 0.0f, DWM_MA_SIZE_X_J - 1.0f);
-    const float y_j = fclampf(pos_m[1] * _DWM_MA_METRIC_2_JUNCTION - 0.5f, 0.0f, DWM_MA_SIZE_Y_J - 1.0f);
-    const float z_j = fclampf(pos_m[2] * _DWM_MA_METRIC_2_JUNCTION - 0.5f, 0.0f, DWM_MA_SIZE_Z_J - 1.0f);
-
-    // Get the next and previous junction coordinates for each dimension
-    const int x_j_0 = (int) floorf(x_j);
-    const int x_j_1 = (int) ceilf(x_j);
-    const int y_j_0 = (int) floorf(y_j);
-    const int y_j_1 = (int) ceilf(y_j);
-    const int z_j_0 = (int) floorf(z_j);
-    const int z_j_1 = (int) ceilf(z_j);
-
-    // Return the linearized junction sampling indices
-    interp_indices[0][0][0] = linearized_index_xyz(x_j_0, y_j_0, z_j_0);
-    interp_indices[1][0][0] = linearized_index_xyz(x_j_1, y_j_0, z_j_0);
-    interp_indices[0][1][0] = linearized_index_xyz(x_j_0, y_j_1, z_j_0);
-    interp_indices[1][1][0] = linearized_index_xyz(x_j_1, y_j_1, z_j_0);
-    interp_indices[0][0][1] = linearized_index_xyz(x_j_0, y_j_0, z_j_1);
-    interp_indices[1][0][1] = linearized_index_xyz(x_j_1, y_j_0, z_j_1);
-    interp_indices[0][1][1] = linearized_index_xyz(x_j_0, y_j_1, z_j_1);
-    interp_indices[1][1][1] = linearized_index_xyz(x_j_1, y_j_1, z_j_1);
-
-    float _; // Return each axis' interpolation percentages
-    interp_percents[0] = modff(x_j, &_);
-    interp_percents[1] = modff(y_j, &_);
-    interp_percents[2] = modff(z_j, &_);
-}
-
-void compute_interpolation_parameters_ma(const int *pos_j_rel, const float *pos_m_offset, const float ma_scale,
-                                         float interp_percents[3], int interp_indices[2][2][2]) {
-    // Translate the metric coordinates to valid floating point junction coordinates
-    const float x_j = fclampf((float) pos_j_rel[0] * ma_scale + pos_m_offset[0] * _DWM_MA_METRIC_2_JUNCTION - 0.5f,
-                              0.0f, DWM_MA_SIZE_X_J - 1.0f);
-    const float y_j = fclampf((float) pos_j_rel[1] * ma_scale + pos_m_offset[1] * _DWM_MA_METRIC_2_JUNCTION - 0.5f,
-                              0.0f, DWM_MA_SIZE_Y_J - 1.0f);
-    const float z_j = fclampf((float) pos_j_rel[2] * ma_scale + pos_m_offset[2] * _DWM_MA_METRIC_2_JUNCTION - 0.5f,
-                              0.0f, DWM_MA_SIZE_Z_J - 1.0f);
-
-    // Get the next and previous junction coordinates for each dimension
-    const int x_j_0 = (int) floorf(x_j);
-    const int x_j_1 = (int) ceilf(x_j);
-    const int y_j_0 = (int) floorf(y_j);
-    const int y_j_1 = (int) ceilf(y_j);
-    const int z_j_0 = (int) floorf(z_j);
-    const int z_j_1 = (int) ceilf(z_j);
-
-    // Return the linearized junction sampling indices
-    interp_indices[0][0][0] = linearized_index_xyz(x_j_0, y_j_0, z_j_0);
-    interp_indices[1][0][0] = linearized_index_xyz(x_j_1, y_j_0, z_j_0);
-    interp_indices[0][1][0] = linearized_index_xyz(x_j_0, y_j_1, z_j_0);
-    interp_indices[1][1][0] = linearized_index_xyz(x_j_1, y_j_1, z_j_0);
-    interp_indices[0][0][1] = linearized_index_xyz(x_j_0, y_j_0, z_j_1);
-    interp_indices[1][0][1] = linearized_index_xyz(x_j_1, y_j_0, z_j_1);
-    interp_indices[0][1][1] = linearized_index_xyz(x_j_0, y_j_1, z_j_1);
-    interp_indices[1][1][1] = linearized_index_xyz(x_j_1, y_j_1, z_j_1);
-
-    float _; // Return each axis' interpolation percentages
-    interp_percents[0] = modff(x_j, &_);
-    interp_percents[1] = modff(y_j, &_);
-    interp_percents[2] = modff(z_j, &_);
-}
-
-void write_value_interp_params(const dwm_ma_t *handle, const float value, const float interp_percents[3],
-                               const int interp_indices[2][2][2]) {
-    handle->p[interp_indices[0][0][0]] =
-            flerpf(handle->p[interp_indices[0][0][0]], value,
-                   (1 - interp_percents[0]) * (1 - interp_percents[1]) * (1 - interp_percents[2]));
-    handle->p[interp_indices[1][0][0]] =
-            flerpf(handle->p[interp_indices[1][0][0]], value,
-                   interp_percents[0] * (1 - interp_percents[1]) * (1 - interp_percents[2]));
-    handle->p[interp_indices[0][1][0]] =
-            flerpf(handle->p[interp_indices[0][1][0]], value,
-                   (1 - interp_percents[0]) * interp_percents[1] * (1 - interp_percents[2]));
-    handle->p[interp_indices[1][1][0]] = flerpf(handle->p[interp_indices[1][1][0]], value,
-                                                interp_percents[0] * interp_percents[1] * (1 - interp_percents[2]));
-    handle->p[interp_indices[0][0][1]] =
-            flerpf(handle->p[interp_indices[0][0][1]], value,
-                   (1 - interp_percents[0]) * (1 - interp_percents[1]) * interp_percents[2]);
-    handle->p[interp_indices[1][0][1]] = flerpf(handle->p[interp_indices[1][0][1]], value,
-                                                interp_percents[0] * (1 - interp_percents[1]) * interp_percents[2]);
-    handle->p[interp_indices[0][1][1]] = flerpf(handle->p[interp_indices[0][1][1]], value,
-                                                (1 - interp_percents[0]) * interp_percents[1] * interp_percents[2]);
-    handle->p[interp_indices[1][1][1]] = flerpf(handle->p[interp_indices[1][1][1]], value,
-                                                interp_percents[0] * interp_percents[1] * interp_percents[2]);
-}
-
-float read_value_interp_params(const dwm_ma_t *handle, const float interp_percents[3],
-                               const int interp_indices[2][2][2]) {
-    return flerpf(flerpf(flerpf(handle->p_aux[interp_indices[0][0][0]], handle->p_aux[interp_indices[1][0][0]],
-                                interp_percents[0]),
-                         flerpf(handle->p_aux[interp_indices[0][1][0]], handle->p_aux[interp_indices[1][1][0]],
-                                interp_percents[0]),
-                         interp_percents[1]),
-                  flerpf(flerpf(handle->p_aux[interp_indices[0][0][1]], handle->p_aux[interp_indices[1][0][1]],
-                                interp_percents[0]),
-                         flerpf(handle->p_aux[interp_indices[0][1][1]], handle->p_aux[interp_indices[1][1][1]],
-                                interp_percents[0]),
-                         interp_percents[1]),
-                  interp_percents[2]);
-}
+/**
+ * Computes the dampings of a sequence of face junctions of an interpolated mesh, see process_boundary_dampings
+ * @param dampings computed dampings
+ * @param count amount of junctions
+ * @param r1 R1 values of the junctions
+ * @param r2 R2 values of the junctions
+ * @param stride index distance between the values of two junctions in r1 and r2, 0 for uniform values
+ */
+static void compute_boundary_dampings(float *dampings, int count, const float *r1, const float *r2, int stride);
 
-void process_iteration(dwm_ma_t *handle) {
-    // Iterate trough each unwrapped boundary/internal case along each axis:
-    // this implementation method is quite simple and results in code which is easily optimizable by a compiler with the
-    // right options, since the macro expansion results in all conditional branches being removed and for loops which
-    // iterate a predeterminate amount of times
-    int i = 0, i_xp = 0, i_xn = 0, i_yp = 0, i_yn = 0, i_zp = 0, i_zn = 0;
-
-#define UPDATE(ZN, ZP, YN, YP, XN, XP)                                                                                 \
-    handle->p_aux[i] = (ZN + YN + XN + XP + YP + ZP) / 3.0f - handle->p_aux[i];                                        \
-    i++;
-
-#define XN_INTERNAL handle->p[i - 1]
-#define XP_INTERNAL handle->p[i + 1]
-#define XN_BOUNDARY process_boundary(&handle->b_xn[i_xn++], handle->p[i], handle->b_params[2])
-#define XP_BOUNDARY process_boundary(&handle->b_xp[i_xp++], handle->p[i], handle->b_params[3])
-#define AXIS_X(ZN, ZP, YN, YP)                                                                                         \
-    UPDATE(ZN, ZP, YN, YP, XN_BOUNDARY, XP_INTERNAL)                                                                   \
-    for (int x = 1; x < DWM_MA_SIZE_X_J - 1; x++) {                                                                    \
-        UPDATE(ZN, ZP, YN, YP, XN_INTERNAL, XP_INTERNAL)                                                               \
-    }                                                                                                                  \
-    UPDATE(ZN, ZP, YN, YP, XN_INTERNAL, XP_BOUNDARY)
-
-#define YN_INTERNAL handle->p[i - DWM_MA_SIZE_X_J]
-#define YP_INTERNAL handle->p[i + DWM_MA_SIZE_X_J]
-#define YN_BOUNDARY process_boundary(&handle->b_yn[i_yn++], handle->p[i], handle->b_params[1])
-#define YP_BOUNDARY process_boundary(&handle->b_yp[i_yp++], handle->p[i], handle->b_params[4])
-#define AXIS_Y(ZN, ZP)                                                                                                 \
-    AXIS_X(ZN, ZP, YN_BOUNDARY, YP_INTERNAL)                                                                           \
-    for (int y = 1; y < DWM_MA_SIZE_Y_J - 1; y++) {                                                                    \
-        AXIS_X(ZN, ZP, YN_INTERNAL, YP_INTERNAL)                                                                       \
-    }                                                                                                                  \
-    AXIS_X(ZN, ZP, YN_INTERNAL, YP_BOUNDARY)
-
-#define ZN_INTERNAL handle->p[i - DWM_MA_SIZE_X_J * DWM_MA_SIZE_Y_J]
-#define ZP_INTERNAL handle->p[i + DWM_MA_SIZE_X_J * DWM_MA_SIZE_Y_J]
-#define ZN_BOUNDARY process_boundary(&handle->b_zn[i_zn++], handle->p[i], handle->b_params[0])
-#define ZP_BOUNDARY process_boundary(&handle->b_zp[i_zp++], handle->p[i], handle->b_params[5])
-    AXIS_Y(ZN_BOUNDARY, ZP_INTERNAL)
-    for (int z = 1; z < DWM_MA_SIZE_Z_J - 1; z++) {
-        AXIS_Y(ZN_INTERNAL, ZP_INTERNAL)
-    }
-    AXIS_Y(ZN_INTERNAL, ZP_BOUNDARY)
-
-    // Undef all macros
-#undef UPDATE
-#undef XN_INTERNAL
-#undef XP_INTERNAL
-#undef XN_BOUNDARY
-#undef XP_BOUNDARY
-#undef AXIS_X
-#undef YN_INTERNAL
-#undef YP_INTERNAL
-#undef YN_BOUNDARY
-#undef YP_BOUNDARY
-#undef AXIS_Y
-#undef ZN_INTERNAL
-#undef ZP_INTERNAL
-#undef ZN_BOUNDARY
-#undef ZP_BOUNDARY
-}
-
-float process_boundary(dwm_boundary_t *b, const float in, const float r[2]) {
-    const float aux = in - b->t1;
-    const float out = r[0] * (aux + b->t3) + (1 + r[1]) * b->t2;
-    b->t3 = b->t2;
-    b->t1 = out - b->t2;
-    b->t2 = aux;
-    return out;
-}
-
-static int mini(const int a, const int b) { return a < b ? a : b; }
-
-static int maxi(const int a, const int b) { return a > b ? a : b; }
-
-static int clampi(const int v, const int min, const int max) { return mini(maxi(v, min), max); }
-
-float fclampf(const float v, const float min, const float max) { return fminf(fmaxf(v, min), max); }
-
-float flerpf(const float a, const float b, const float f) { return a * (1.0f - f) + (b * f); }
+/**
+ * Progress the links of every edge junction inside a slab of Z-planes by one step
+ * @param handle dwm-ma handle
+ * @param z_begin first Z-plane of the slab
+ * @param z_end Z-plane following the last one of the slab
+ * @param storage storage format of the junction pressures
+ */
+static ALWAYS_INLINE void process_links(dwm_ma_t *handle, int z_begin, int z_end, DWM_MA_STORAGE storage);
+
+/**
+ * Progress the simulation state by one step on the edge junctions of a row, reading the filtered value of their links
+ * @param edges edge junctions of the row
+ * @param edge_count amount of edge junctions of the row
+ * @param links_out filtered values of the links
+ * @param p current step junction pressures
+ * @param p_aux previous step junction pressures, overwritten with the next step pressures
+ * @param row_i linearized index of the row's first junction
+ * @param x_begin first junction of the update region along the X-axis
+ * @param x_end junction following the last one of the update region along the X-axis
+ * @param size_x_j junctions size on the X-axis
+ * @param size_y_j junctions size on the Y-axis
+ * @param storage storage format of the junction pressures
+ * @note The pointers are passed explicitly so that they stay in registers across the junctions' stores
+ */
+static ALWAYS_INLINE void process_edge_junctions(const dwm_edge_t *edges, int edge_count, const float *links_out,
+                                                 const void *p, void *p_aux, int row_i, int x_begin, int x_end,
+                                                 int size_x_j, int size_y_j, DWM_MA_STORAGE storage);
+
+/**
+ * Finds the link groups of the neighbours of an air junction of a voxelized room geometry, see dwm_geometry_t
+ * @param handle dwm-ma handle
+ * @param cells material of each junction, 0 for air
+ * @param x_j junction coordinate on the X-axis
+ * @param y_j junction coordinate on the Y-axis
+ * @param z_j junction coordinate on the Z-axis
+ * @param neighbour_groups resulting link group of each neighbour in order [Z-,Y-,X-,X+,Y+,Z+], -1 for air junctions
+ * @return non-zero if the junction is an edge junction
+ */
+static int classify_junction(const dwm_ma_t *handle, const uint8_t *cells, int x_j, int y_j, int z_j,
+                             int neighbour_groups[6]);
+
+/**
+ * Tells whether a junction of a voxelized room geometry is an air junction, i.e. lies in a run or is an edge junction
+ * of its row, see dwm_geometry_t
+ * @param geometry voxelized room geometry
+ * @param i linearized junction index
+ * @param size_x_j junctions size on the X-axis
+ * @return non-zero for an air junction, zero for a solid junction
+ */
+static int is_air_junction(const dwm_geometry_t *geometry, int i, int size_x_j);
+
+/**
+ * Hashes the cells of a voxelized room geometry (64-bit FNV-1a), identifying the geometry of the links of a snapshot
+ * @param cells material of each junction
+ * @param count amount of junctions
+ * @return hash of the cells
+ */
+static uint64_t hash_cells(const uint8_t *cells, int count);
+
+/**
+ * Converts boundary parameters to the R1 and R2 filter values, see dwm_ma_init
+ * @param params boundary parameters
+ * @param params_normalized non-zero if the parameters are normalized admittance and normalized low-pass cutoff
+ * @param r resulting R1 and R2 filter values
+ */
+static void convert_boundary_params(const float params[2], int params_normalized, float r[2]);
+
+/**
+ * Starts the ramp of a face's boundary parameters, before its target values are changed, unless a ramp is already
+ * pending (which then keeps its start)
+ * @param handle dwm-ma handle
+ * @param face face index
+ */
+static void begin_boundary_ramp(dwm_ma_t *handle, int face);
+
+/**
+ * Ends the boundary ramps of the buffer just processed, the faces then being filtered with their target values
+ * @param handle dwm-ma handle
+ */
+static void end_boundary_ramps(dwm_ma_t *handle);
+
+/**
+ * Uniform boundary parameters of a face at the current step
+ * @param handle dwm-ma handle
+ * @param face face index
+ * @param r storage for ramped values
+ * @return the face's target values, or r filled with the ramped values if the face is ramping
+ */
+static const float *uniform_boundary_params(const dwm_ma_t *handle, int face, float r[2]);
+
+/**
+ * Computes the current step's values of a range of a ramping boundary map
+ * @param handle dwm-ma handle
+ * @param map ramping boundary map
+ * @param begin first filter of the range
+ * @param count amount of filters of the range
+ */
+static void ramp_boundary_map(const dwm_ma_t *handle, const dwm_boundary_map_t *map, int begin, int count);
+
+/**
+ * Allocates the boundary map of a face, as a single memory block
+ * @return the map, inactive, or NULL if it cannot be allocated
+ */
+static dwm_boundary_map_t *create_boundary_map(int face_size);
+
+/**
+ * Progress the simulation state by one step on a single junction, reading the filtered value of any boundary the
+ * junction lies on
+ * @param handle dwm-ma handle
+ * @param x_j junction coordinate on the X-axis
+ * @param y_j junction coordinate on the Y-axis
+ * @param z_j junction coordinate on the Z-axis
+ * @param size_x_j junctions size on the X-axis
+ * @param size_y_j junctions size on the Y-axis
+ * @param size_z_j junctions size on the Z-axis
+ * @param storage storage format of the junction pressures
+ */
+static ALWAYS_INLINE void process_junction(dwm_ma_t *handle, int x_j, int y_j, int z_j, int size_x_j, int size_y_j,
+                                           int size_z_j, DWM_MA_STORAGE storage);
+
+/**
+ * Progress the simulation state by one step on a row of junctions of an interpolated mesh which all lie on a face
+ * @param handle dwm-ma handle
+ * @param x_j X coordinate of the row's first junction
+ * @param y_j Y coordinate of the row's first junction
+ * @param z_j Z coordinate of the row
+ * @param along_y non-zero for a row along the Y-axis, zero for a row along the X-axis
+ * @param count amount of junctions of the row
+ * @param size_x_j junctions size on the X-axis
+ * @param size_y_j junctions size on the Y-axis
+ * @param size_z_j junctions size on the Z-axis
+ * @details The neighbours out of the mesh are clamped into it, which mirrors the junctions along each face as a rigid
+ * boundary: the clamped neighbour rows are copied chunk by chunk into a contiguous scratch, which the row kernel then
+ * updates as any other row. The sum of the dampings of the faces each junction lies on (see
+ * process_boundary_dampings) then damps its update as a locally reacting boundary of the interpolated scheme, as
+ * described in the reference of DWM_MA_TOPOLOGY_INTERPOLATED. Unlike face filters, damping terms keep the scheme
+ * stable on edges and corners
+ */
+static ALWAYS_INLINE void process_face_row_interpolated(dwm_ma_t *handle, int x_j, int y_j, int z_j, int along_y,
+                                                        int count, int size_x_j, int size_y_j, int size_z_j);
+
+/**
+ * Computes the dampings of a row of face junctions of an interpolated mesh, see process_face_row_interpolated
+ * @param handle dwm-ma handle
+ * @param dampings sum of the dampings of the faces each junction lies on (dimensionality count)
+ * @param x_j X coordinate of the row's first junction
+ * @param y_j Y coordinate of the row's first junction
+ * @param z_j Z coordinate of the row
+ * @param along_y non-zero for a row along the Y-axis, zero for a row along the X-axis
+ * @param count amount of junctions of the row
+ * @param size_x_j junctions size on the X-axis
+ * @param size_y_j junctions size on the Y-axis
+ * @param size_z_j junctions size on the Z-axis
+ */
+static ALWAYS_INLINE void row_dampings(const dwm_ma_t *handle, float *dampings, int x_j, int y_j, int z_j, int along_y,
+                                       int count, int size_x_j, int size_y_j, int size_z_j);
+
+/**
+ * Reads the monotonic clock
+ * @return the time in nanoseconds
+ */
+static uint64_t now_ns(void);
+
+/**
+ * Accounts the time elapsed since the previous lap of a processing call to a phase, if its phases are timed
+ * @param handle dwm-ma handle
+ * @param phase phase the elapsed time was spent in
+ */
+static void stats_lap(dwm_ma_t *handle, DWM_MA_PHASE phase);
+
+/**
+ * Deadline of a processing call
+ * @param handle dwm-ma handle
+ * @return the deadline set by dwm_ma_set_stats_deadline, or the duration of a buffer
+ */
+static uint64_t stats_deadline_ns(const dwm_ma_t *handle);
+
+/**
+ * Accounts a processing call to the statistics
+ * @param handle dwm-ma handle
+ * @param begin_ns time at which the call began
+ */
+static void stats_call(dwm_ma_t *handle, uint64_t begin_ns);
+
+// Function definitions
+
+/**
+ * Specialized slab processing code paths, one for each of the DWM_MA_SPECIALIZED_SIZES
+ */
+#define SPECIALIZED_PROCESS_SLAB(X, Y, Z)                                                                              \
+    static void process_slab_##X##_##Y##_##Z(dwm_ma_t *handle, const int z_begin, const int z_end) {                   \
+        process_slab_sized(handle, z_begin, z_end, X, Y, Z, DWM_MA_STORAGE_FLOAT32);                                   \
+    }
+DWM_MA_SPECIALIZED_SIZES(SPECIALIZED_PROCESS_SLAB)
+#undef SPECIALIZED_PROCESS_SLAB
+
+/**
+ * Specialized slab processing code paths of interpolated meshes, one for each of the DWM_MA_SPECIALIZED_SIZES
+ */
+#define SPECIALIZED_PROCESS_SLAB(X, Y, Z)                                                                              \
+    static void process_slab_interpolated_##X##_##Y##_##Z(dwm_ma_t *handle, const int z_begin, const int z_end) {      \
+        process_slab_interpolated_sized(handle, z_begin, z_end, X, Y, Z);                                              \
+    }
+DWM_MA_SPECIALIZED_SIZES(SPECIALIZED_PROCESS_SLAB)
+#undef SPECIALIZED_PROCESS_SLAB
+
+void dwm_ma_mesh_config_default(dwm_ma_mesh_config *config) {
+    config->sample_rate = DWM_MA_SAMPLE_RATE;
+    config->buffer_size = DWM_MA_BUFFER_SIZE;
+    config->size_x_j = DWM_MA_SIZE_X_J;
+    config->size_y_j = DWM_MA_SIZE_Y_J;
+    config->size_z_j = DWM_MA_SIZE_Z_J;
+    config->sound_propagation_speed = DWM_MA_SOUND_PROPAGATION_SPEED;
+    config->storage = DWM_MA_STORAGE_FLOAT32;
+    config->topology = DWM_MA_TOPOLOGY_RECTILINEAR;
+}
+
+float dwm_ma_junction_size_m(const dwm_ma_mesh_config *config) {
+    // Each scheme runs at its largest stable Courant number, 1 / sqrt(3) for the rectilinear one and 1 for the
+    // interpolated one
+    return _DWM_MA_JUNCTION_SPACING(config->topology) * config->sound_propagation_speed / (float) config->sample_rate;
+}
+
+void dwm_ma_create(void **dwm_ma) {
+    // Assert at compile time that the user-redefinable definitions have legal values
+    static_assert(DWM_MA_SAMPLE_RATE >= 1, "dwm-ma DSP sample rate must be greater or equal than 1");
+    static_assert(DWM_MA_BUFFER_SIZE >= 1, "dwm-ma DSP buffer size must be greater or equal than 1");
+    static_assert(DWM_MA_SIZE_X_J >= 3, "dwm-ma junctions size on the X-axis must be greater or equal than 3");
+    static_assert(DWM_MA_SIZE_Y_J >= 3, "dwm-ma junctions size on the Y-axis must be greater or equal than 3");
+    static_assert(DWM_MA_SIZE_Z_J >= 3, "dwm-ma junctions size on the Z-axis must be greater or equal than 3");
+    static_assert(DWM_MA_SOUND_PROPAGATION_SPEED >= 1, "dwm-ma sound propagation speed must be greater than 0");
+    static_assert(DWM_MA_MAX_INPUT_COUNT >= 1, "dwm-ma sample rate must be greater or equal than 1");
+
+    dwm_ma_mesh_config config;
+    dwm_ma_mesh_config_default(&config);
+    dwm_ma_create_ex(dwm_ma, &config);
+}
+
+int dwm_ma_create_ex(void **dwm_ma, const dwm_ma_mesh_config *config) {
+    // Allocate all resources as a single memory block, owned by the instance
+    const size_t memory_size = dwm_ma_memory_requirements(config);
+    void *memory = memory_size != 0 ? malloc(memory_size) : NULL;
+    if (dwm_ma_create_in(dwm_ma, config, memory, memory_size) != 0) {
+        free(memory);
+        return 1;
+    }
+    ((dwm_ma_t *) *dwm_ma)->owned_memory = memory;
+    return 0;
+}
+
+size_t dwm_ma_memory_requirements(const dwm_ma_mesh_config *config) {
+    if (!is_config_valid(config)) {
+        return 0;
+    }
+    size_t b_offsets[6], p_offset, p_aux_offset;
+    return compute_memory_layout(config, b_offsets, &p_offset, &p_aux_offset) + DWM_MA_MEMORY_ALIGNMENT - 1;
+}
+
+int dwm_ma_create_in(void **dwm_ma, const dwm_ma_mesh_config *config, void *memory, const size_t memory_size) {
+    if (memory == NULL || !is_config_valid(config) || memory_size < dwm_ma_memory_requirements(config)) {
+        *dwm_ma = NULL;
+        return 1;
+    }
+    const int x = config->size_x_j, y = config->size_y_j, z = config->size_z_j;
+
+    // Place all resources inside the memory block, starting from its first aligned address
+    size_t b_offsets[6], p_offset, p_aux_offset;
+    compute_memory_layout(config, b_offsets, &p_offset, &p_aux_offset);
+    char *base = (char *) (((uintptr_t) memory + DWM_MA_MEMORY_ALIGNMENT - 1) &
+                           ~(uintptr_t) (DWM_MA_MEMORY_ALIGNMENT - 1));
+    dwm_ma_t *handle = (dwm_ma_t *) base;
+    handle->p = base + p_offset;
+    handle->p_aux = base + p_aux_offset;
+    handle->owned_memory = NULL;
+    handle->mapped_memory = NULL;
+    handle->mapped_size = 0;
+
+    // Store the mesh geometry, with the same metric conversions as the _DWM_MA_* definitions at the topology's spacing
+    handle->size_x_j = x;
+    handle->size_y_j = y;
+    handle->size_z_j = z;
+    handle->sample_rate = config->sample_rate;
+    handle->buffer_size = config->buffer_size;
+    handle->frame_count = config->buffer_size;
+    handle->call_frame_count = config->buffer_size;
+    handle->storage = config->storage;
+    handle->topology = config->topology;
+    handle->sound_propagation_speed = config->sound_propagation_speed;
+    const float spacing = _DWM_MA_JUNCTION_SPACING(config->topology);
+    handle->metric_2_junction = (float) config->sample_rate / (spacing * config->sound_propagation_speed);
+    handle->junction_2_metric = spacing * config->sound_propagation_speed / (float) config->sample_rate;
+    handle->size_m[0] = (float) x * handle->junction_2_metric;
+    handle->size_m[1] = (float) y * handle->junction_2_metric;
+    handle->size_m[2] = (float) z * handle->junction_2_metric;
+
+    // Each face's filter states and outputs are stored contiguously
+    for (int f = 0; f < 6; f++) {
+        const int n = face_size_j(handle, f);
+        handle->b[f].t1 = (float *) (base + b_offsets[f]);
+        handle->b[f].t2 = handle->b[f].t1 + n;
+        handle->b[f].t3 = handle->b[f].t2 + n;
+        handle->b[f].out = handle->b[f].t3 + n;
+    }
+
+    // Pick the code path of the mesh and the fastest junction update and boundary filter kernels for the running CPU
+    handle->geometry = NULL;
+    handle->snapshot_links = NULL;
+    handle->snapshot_link_count = 0;
+    handle->snapshot_geometry_hash = 0;
+    for (int f = 0; f < 6; f++) {
+        handle->b_maps[f] = NULL;
+        handle->b_ramp[f] = 0;
+    }
+    handle->b_step = 0;
+    handle->taps = NULL;
+    handle->setup.valid = 0;
+    handle->custom_layout = NULL;
+    handle->encoder = NULL;
+    handle->host = NULL;
+    handle->convolution = NULL;
+    select_process_slab(handle);
+    if (handle->topology == DWM_MA_TOPOLOGY_INTERPOLATED) {
+        handle->row_kernel = dwm_ma_simd_select_interpolated_row_kernel();
+        handle->row_kernel_16 = NULL;
+    } else {
+        handle->row_kernel = dwm_ma_simd_select_row_kernel();
+        handle->row_kernel_16 = handle->storage == DWM_MA_STORAGE_BFLOAT16 ? dwm_ma_simd_select_row_kernel_bf16()
+                                                                           : dwm_ma_simd_select_row_kernel_f16();
+    }
+    handle->boundary_kernel = dwm_ma_simd_select_boundary_kernel();
+    handle->boundary_map_kernel = dwm_ma_simd_select_boundary_map_kernel();
+    handle->encode_kernel = dwm_ma_simd_select_encode_kernel();
+    handle->pool = NULL;
+    handle->temporal_block_size = 1;
+    handle->stats_enabled = 0;
+    handle->stats_timing = 0;
+    memset(&handle->stats, 0, sizeof(handle->stats));
+    clear_active_region(handle);
+    *dwm_ma = handle;
+    return 0;
+}
+
+void dwm_ma_destroy(void **dwm_ma) {
+    dwm_ma_t *handle = *dwm_ma;
+
+    // Free all resources, the memory block being freed or unmapped last since it holds the handle itself
+    if (handle->pool != NULL) {
+        dwm_ma_pool_destroy(&handle->pool);
+    }
+    free(handle->geometry);
+    for (int f = 0; f < 6; f++) {
+        free(handle->b_maps[f]);
+    }
+    free(handle->custom_layout);
+    free(handle->encoder);
+    destroy_host(handle->host);
+    destroy_convolution(handle);
+    void *mapped_memory = handle->mapped_memory;
+    const size_t mapped_size = handle->mapped_size;
+    free(handle->owned_memory);
+    if (mapped_memory != NULL) {
+        munmap(mapped_memory, mapped_size);
+    }
+    *dwm_ma = NULL;
+}
+
+int dwm_ma_save_snapshot(const void *dwm_ma, const char *path) {
+    const dwm_ma_t *handle = dwm_ma;
+    dwm_ma_mesh_config config;
+    get_mesh_config(handle, &config);
+    const size_t block_size = dwm_ma_memory_requirements(&config);
+    const int link_count = handle->geometry != NULL
+                                   ? handle->geometry->link_offsets[handle->size_z_j * handle->geometry->group_count]
+                                   : 0;
+
+    // Write the snapshot into a temporary file, renamed over the path once complete so that the previous snapshot is
+    // only ever replaced by a whole new one
+    const size_t links_offset = align_size(DWM_MA_SNAPSHOT_HEADER_SIZE + block_size);
+    const size_t size = links_offset + sizeof(float) * 3 * link_count;
+    char *temp_path = malloc(strlen(path) + sizeof(".tmp"));
+    if (temp_path == NULL) {
+        return 1;
+    }
+    strcat(strcpy(temp_path, path), ".tmp");
+    const int fd = open(temp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        free(temp_path);
+        return 1;
+    }
+
+    // Allocate the file's blocks before mapping it, a full disk then fails here rather than raising SIGBUS when the
+    // mapped pages are written back
+    struct stat st;
+    const int regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    char *memory = regular && posix_fallocate(fd, 0, (off_t) size) == 0
+                           ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                           : MAP_FAILED;
+    int result = memory == MAP_FAILED;
+    if (result == 0) {
+        // Write the memory block image and the links' filter states first and the header last, so that the file is
+        // only recognized as a snapshot once its contents are complete
+        copy_state_to_block(handle, memory + DWM_MA_SNAPSHOT_HEADER_SIZE);
+        if (link_count > 0) {
+            memcpy(memory + links_offset, handle->geometry->links.t1, sizeof(float) * 3 * link_count);
+        }
+        dwm_ma_snapshot_header *header = (dwm_ma_snapshot_header *) memory;
+        header->version = DWM_MA_SNAPSHOT_VERSION;
+        header->sample_rate = config.sample_rate;
+        header->buffer_size = config.buffer_size;
+        header->size_x_j = config.size_x_j;
+        header->size_y_j = config.size_y_j;
+        header->size_z_j = config.size_z_j;
+        header->sound_propagation_speed = config.sound_propagation_speed;
+        header->storage = config.storage;
+        header->topology = config.topology;
+        memcpy(header->b_params, handle->b_params, sizeof(header->b_params));
+        memcpy(header->active_begin, handle->active_begin, sizeof(header->active_begin));
+        memcpy(header->active_end, handle->active_end, sizeof(header->active_end));
+        header->link_count = link_count;
+        header->block_size = block_size;
+        header->links_offset = links_offset;
+        header->geometry_hash = handle->geometry != NULL ? handle->geometry->hash : 0;
+        memcpy(header->magic, DWM_MA_SNAPSHOT_MAGIC, sizeof(header->magic));
+        result = msync(memory, size, MS_SYNC) != 0;
+        result |= munmap(memory, size) != 0;
+    }
+    result = result || fsync(fd) != 0;
+    result |= close(fd) != 0;
+    result = result || rename(temp_path, path) != 0;
+    if (result != 0 && regular) {
+        unlink(temp_path);
+    }
+    free(temp_path);
+    return result;
+}
+
+int dwm_ma_load_snapshot(void **dwm_ma, const char *path) {
+    *dwm_ma = NULL;
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < DWM_MA_SNAPSHOT_HEADER_SIZE) {
+        close(fd);
+        return 1;
+    }
+
+    // A private writable mapping loads pages on demand and copies them on write, leaving the file untouched
+    const size_t size = (size_t) st.st_size;
+    char *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        return 1;
+    }
+
+    // Check the header against the file's size before trusting any of its fields
+    const dwm_ma_snapshot_header *header = (const dwm_ma_snapshot_header *) memory;
+    const dwm_ma_mesh_config config = {header->sample_rate, header->buffer_size, header->size_x_j, header->size_y_j,
+                                       header->size_z_j, header->sound_propagation_speed,
+                                       (DWM_MA_STORAGE) header->storage, (DWM_MA_TOPOLOGY) header->topology};
+    int valid = memcmp(header->magic, DWM_MA_SNAPSHOT_MAGIC, sizeof(header->magic)) == 0 &&
+                header->version == DWM_MA_SNAPSHOT_VERSION && header->storage >= DWM_MA_STORAGE_FLOAT32 &&
+                header->storage <= DWM_MA_STORAGE_BFLOAT16 && header->topology >= DWM_MA_TOPOLOGY_RECTILINEAR &&
+                header->topology <= DWM_MA_TOPOLOGY_INTERPOLATED && is_config_valid(&config) &&
+                header->block_size == dwm_ma_memory_requirements(&config) && header->link_count >= 0 &&
+                header->links_offset == align_size(DWM_MA_SNAPSHOT_HEADER_SIZE + header->block_size) &&
+                size == header->links_offset + sizeof(float) * 3 * header->link_count;
+    const int size_j[3] = {config.size_x_j, config.size_y_j, config.size_z_j};
+    for (int k = 0; k < 3 && valid; k++) {
+        valid = header->active_begin[k] >= 0 && header->active_begin[k] <= header->active_end[k] &&
+                header->active_end[k] <= size_j[k];
+    }
+    void *instance;
+    if (!valid ||
+        dwm_ma_create_in(&instance, &config, memory + DWM_MA_SNAPSHOT_HEADER_SIZE, header->block_size) != 0) {
+        munmap(memory, size);
+        return 1;
+    }
+
+    // The instance's memory block is the image itself, only the settings stored in the header are left to restore
+    dwm_ma_t *handle = instance;
+    handle->mapped_memory = memory;
+    handle->mapped_size = size;
+    memcpy(handle->b_params, header->b_params, sizeof(handle->b_params));
+    memcpy(handle->active_begin, header->active_begin, sizeof(handle->active_begin));
+    memcpy(handle->active_end, header->active_end, sizeof(handle->active_end));
+    if (header->link_count > 0) {
+        handle->snapshot_links = (const float *) (memory + header->links_offset);
+        handle->snapshot_link_count = header->link_count;
+        handle->snapshot_geometry_hash = header->geometry_hash;
+    }
+    *dwm_ma = handle;
+    return 0;
+}
+
+int dwm_ma_clone(void **clone, const void *dwm_ma) {
+    const dwm_ma_t *handle = dwm_ma;
+    dwm_ma_mesh_config config;
+    get_mesh_config(handle, &config);
+    if (dwm_ma_create_ex(clone, &config) != 0) {
+        return 1;
+    }
+    dwm_ma_t *copy = *clone;
+    copy_state_to_block(handle, (char *) copy);
+    memcpy(copy->b_params, handle->b_params, sizeof(copy->b_params));
+    memcpy(copy->active_begin, handle->active_begin, sizeof(copy->active_begin));
+    memcpy(copy->active_end, handle->active_end, sizeof(copy->active_end));
+    if (copy_settings(copy, handle) != 0) {
+        dwm_ma_destroy(clone);
+        return 1;
+    }
+    return 0;
+}
+
+void dwm_ma_transfer_state(void *dwm_ma, const void *source) {
+    dwm_ma_t *handle = dwm_ma;
+    const dwm_ma_t *src = source;
+    clear_state(handle);
+    if (src->active_begin[0] >= src->active_end[0]) {
+        return;
+    }
+
+    // The active region covers every junction whose interpolation reads a junction of the source's active region,
+    // grown by one junction for rounding
+    const int size_j[3] = {handle->size_x_j, handle->size_y_j, handle->size_z_j};
+    const float ratio = src->junction_2_metric * handle->metric_2_junction;
+    for (int f = 0; f < 6; f++) {
+        transfer_face(handle, src, f);
+    }
+    for (int k = 0; k < 3; k++) {
+        handle->active_begin[k] = clampi((int) floorf((src->active_begin[k] - 0.5f) * ratio - 0.5f) - 1, 0, size_j[k]);
+        handle->active_end[k] = clampi((int) ceilf((src->active_end[k] + 0.5f) * ratio - 0.5f) + 1, 0, size_j[k]);
+    }
+
+    // Sample both pressure buffers of the source at each junction's metric position
+    float interp_percents[3];
+    int interp_indices[2][2][2];
+    for (int z_j = handle->active_begin[2]; z_j < handle->active_end[2]; z_j++) {
+        for (int y_j = handle->active_begin[1]; y_j < handle->active_end[1]; y_j++) {
+            for (int x_j = handle->active_begin[0]; x_j < handle->active_end[0]; x_j++) {
+                const float pos_m[3] = {((float) x_j + 0.5f) * handle->junction_2_metric,
+                                        ((float) y_j + 0.5f) * handle->junction_2_metric,
+                                        ((float) z_j + 0.5f) * handle->junction_2_metric};
+                compute_interpolation_parameters_m(src, pos_m, interp_percents, interp_indices);
+                const int i = linearized_index_xyz(handle, x_j, y_j, z_j);
+                store_junction(handle->p, i,
+                               flerpf(read_plane_interp_params(src, src->p, interp_percents, interp_indices, 0),
+                                      read_plane_interp_params(src, src->p, interp_percents, interp_indices, 1),
+                                      interp_percents[2]),
+                               handle->storage);
+                store_junction(handle->p_aux, i,
+                               flerpf(read_plane_interp_params(src, src->p_aux, interp_percents, interp_indices, 0),
+                                      read_plane_interp_params(src, src->p_aux, interp_percents, interp_indices, 1),
+                                      interp_percents[2]),
+                               handle->storage);
+            }
+        }
+    }
+}
+
+void dwm_ma_set_thread_count(void *dwm_ma, int thread_count) {
+    dwm_ma_t *handle = dwm_ma;
+
+    // Each slab must contain at least one Z-plane
+    thread_count = clampi(thread_count, 1, handle->size_z_j);
+    if (handle->pool != NULL) {
+        dwm_ma_pool_destroy(&handle->pool);
+    }
+    if (thread_count > 1) {
+        dwm_ma_pool_create(&handle->pool, thread_count); // Left as NULL on failure, falling back to a single thread
+    }
+}
+
+void dwm_ma_set_temporal_block_size(void *dwm_ma, const int temporal_block_size) {
+    dwm_ma_t *handle = dwm_ma;
+    handle->temporal_block_size = clampi(temporal_block_size, 1, handle->buffer_size);
+}
+
+int dwm_ma_set_geometry(void *dwm_ma, const uint8_t *cells, const float material_params[][2], const int material_count,
+                        const int material_params_normalized) {
+    dwm_ma_t *handle = dwm_ma;
+    const int size_x_j = handle->size_x_j, size_y_j = handle->size_y_j, size_z_j = handle->size_z_j;
+    const int row_count = size_y_j * size_z_j, junction_count = row_count * size_x_j;
+    if (cells == NULL) {
+        free(handle->geometry);
+        handle->geometry = NULL;
+        select_process_slab(handle);
+        destroy_convolution(handle);
+        return 0;
+    }
+    if (material_count < 0 || material_count > UINT8_MAX || handle->topology != DWM_MA_TOPOLOGY_RECTILINEAR) {
+        return 1;
+    }
+
+    // Validate the materials and count the runs, edge junctions and links
+    int run_count = 0, edge_count = 0, link_count = 0, neighbour_groups[6];
+    for (int i = 0; i < junction_count; i++) {
+        if (cells[i] > material_count) {
+            return 1;
+        }
+    }
+    for (int z = 0; z < size_z_j; z++) {
+        for (int y = 0; y < size_y_j; y++) {
+            int in_run = 0;
+            for (int x = 0; x < size_x_j; x++) {
+                const int air = cells[(z * size_y_j + y) * size_x_j + x] == 0;
+                const int edge = air && classify_junction(handle, cells, x, y, z, neighbour_groups);
+                for (int d = 0; d < 6 && edge; d++) {
+                    link_count += neighbour_groups[d] >= 0;
+                }
+                edge_count += edge;
+                run_count += air && !edge && !in_run;
+                in_run = air && !edge;
+            }
+        }
+    }
+
+    // Allocate the whole geometry as a single memory block
+    const int group_count = 6 + material_count, plane_group_count = size_z_j * group_count;
+    const size_t offsets[] = {align_size(sizeof(dwm_geometry_t)),
+                              align_size(sizeof(int) * (row_count + 1)),
+                              align_size(sizeof(int[2]) * run_count),
+                              align_size(sizeof(int) * (row_count + 1)),
+                              align_size(sizeof(dwm_edge_t) * edge_count),
+                              align_size(sizeof(int) * (plane_group_count + 1)),
+                              align_size(sizeof(int) * link_count),
+                              align_size(sizeof(float) * 4 * link_count),
+                              align_size(sizeof(float[2]) * material_count)};
+    size_t size = 0;
+    for (size_t k = 0; k < sizeof(offsets) / sizeof(offsets[0]); k++) {
+        size += offsets[k];
+    }
+    char *memory = malloc(size);
+    if (memory == NULL) {
+        return 1;
+    }
+    dwm_geometry_t *geometry = (dwm_geometry_t *) memory;
+    memory += offsets[0];
+    geometry->run_offsets = (int *) memory;
+    memory += offsets[1];
+    geometry->runs = (int(*)[2]) memory;
+    memory += offsets[2];
+    geometry->edge_offsets = (int *) memory;
+    memory += offsets[3];
+    geometry->edges = (dwm_edge_t *) memory;
+    memory += offsets[4];
+    geometry->link_offsets = (int *) memory;
+    memory += offsets[5];
+    geometry->link_junctions = (int *) memory;
+    memory += offsets[6];
+    geometry->links.t1 = (float *) memory;
+    geometry->links.t2 = geometry->links.t1 + link_count;
+    geometry->links.t3 = geometry->links.t2 + link_count;
+    geometry->links.out = geometry->links.t3 + link_count;
+    memory += offsets[7];
+    geometry->material_params = (float(*)[2]) memory;
+    geometry->group_count = group_count;
+    for (int m = 0; m < material_count; m++) {
+        convert_boundary_params(material_params[m], material_params_normalized, geometry->material_params[m]);
+    }
+
+    // Count the links of each Z-plane and group, and turn the counts into offsets
+    memset(geometry->link_offsets, 0, sizeof(int) * (plane_group_count + 1));
+    for (int z = 0; z < size_z_j; z++) {
+        for (int y = 0; y < size_y_j; y++) {
+            for (int x = 0; x < size_x_j; x++) {
+                if (cells[(z * size_y_j + y) * size_x_j + x] == 0 &&
+                    classify_junction(handle, cells, x, y, z, neighbour_groups)) {
+                    for (int d = 0; d < 6; d++) {
+                        if (neighbour_groups[d] >= 0) {
+                            geometry->link_offsets[z * group_count + neighbour_groups[d] + 1]++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    for (int g = 0; g < plane_group_count; g++) {
+        geometry->link_offsets[g + 1] += geometry->link_offsets[g];
+    }
+
+    // Split each row in runs and edge junctions, assigning the links of each Z-plane and group in scanning order
+    int runs = 0, edges = 0, link_cursors[6 + UINT8_MAX];
+    for (int z = 0; z < size_z_j; z++) {
+        memcpy(link_cursors, &geometry->link_offsets[z * group_count], sizeof(int) * group_count);
+        for (int y = 0; y < size_y_j; y++) {
+            const int row = z * size_y_j + y;
+            geometry->run_offsets[row] = runs;
+            geometry->edge_offsets[row] = edges;
+            int in_run = 0;
+            for (int x = 0; x < size_x_j; x++) {
+                const int i = row * size_x_j + x;
+                const int air = cells[i] == 0;
+                const int edge = air && classify_junction(handle, cells, x, y, z, neighbour_groups);
+                if (edge) {
+                    geometry->edges[edges].x = x;
+                    for (int d = 0; d < 6; d++) {
+                        const int g = neighbour_groups[d];
+                        geometry->edges[edges].link[d] = g >= 0 ? link_cursors[g] : -1;
+                        if (g >= 0) {
+                            geometry->link_junctions[link_cursors[g]++] = i;
+                        }
+                    }
+                    edges++;
+                }
+                if (air && !edge && !in_run) {
+                    geometry->runs[runs][0] = x;
+                    runs++;
+                }
+                if (air && !edge) {
+                    geometry->runs[runs - 1][1] = x + 1;
+                }
+                in_run = air && !edge;
+            }
+        }
+    }
+    geometry->run_offsets[row_count] = runs;
+    geometry->edge_offsets[row_count] = edges;
+
+    // Silence the links and the solid junctions, which are never updated, unless the links are those of a loaded
+    // snapshot of the same geometry
+    geometry->hash = hash_cells(cells, junction_count);
+    memset(geometry->links.t1, 0, sizeof(float) * 4 * link_count);
+    if (handle->snapshot_links != NULL && handle->snapshot_link_count == link_count &&
+        handle->snapshot_geometry_hash == geometry->hash) {
+        memcpy(geometry->links.t1, handle->snapshot_links, sizeof(float) * 3 * link_count);
+    }
+    handle->snapshot_links = NULL;
+    for (int i = 0; i < junction_count; i++) {
+        if (cells[i] != 0) {
+            store_junction(handle->p, i, 0.0f, handle->storage);
+            store_junction(handle->p_aux, i, 0.0f, handle->storage);
+        }
+    }
+    free(handle->geometry);
+    handle->geometry = geometry;
+    select_process_slab(handle);
+    destroy_convolution(handle);
+    return 0;
+}
+
+int dwm_ma_set_custom_layout(void *dwm_ma, const ma_custom_layout *layout) {
+    dwm_ma_t *handle = dwm_ma;
+    if (layout == NULL) {
+        free(handle->custom_layout);
+        handle->custom_layout = NULL;
+        handle->setup.valid = 0;
+        destroy_convolution(handle);
+        return 0;
+    }
+    if (layout->channel_count < 1) {
+        return 1;
+    }
+
+    // Allocate the layout's copy and its working memory as a single memory block
+    const int channel_count = layout->channel_count;
+    const size_t offsets[] = {align_size(sizeof(dwm_mic_array_t)),
+                              align_size(sizeof(float[3]) * channel_count),
+                              align_size(sizeof(int) * channel_count),
+                              align_size(sizeof(float[3]) * channel_count),
+                              align_size(sizeof(int[2][2][2]) * channel_count),
+                              align_size(sizeof(int) * 2 * channel_count),
+                              align_size(sizeof(int) * 2 * channel_count),
+                              align_size(sizeof(int) * 2 * channel_count),
+                              align_size(sizeof(float[2]) * channel_count),
+                              align_size(sizeof(float *) * channel_count)};
+    size_t size = 0;
+    for (size_t k = 0; k < sizeof(offsets) / sizeof(offsets[0]); k++) {
+        size += offsets[k];
+    }
+    char *memory = malloc(size);
+    if (memory == NULL) {
+        return 1;
+    }
+    dwm_mic_array_t *mics = (dwm_mic_array_t *) memory;
+    memory += offsets[0];
+    float(*mic_rel_xyz_j)[3] = (float(*)[3]) memory;
+    memory += offsets[1];
+    int *channels = (int *) memory;
+    memory += offsets[2];
+    mics->int_percents = (float(*)[3]) memory;
+    memory += offsets[3];
+    mics->int_indices = (int(*)[2][2][2]) memory;
+    memory += offsets[4];
+    mics->tap_planes = (int *) memory;
+    memory += offsets[5];
+    mics->tap_mics = (int *) memory;
+    memory += offsets[6];
+    mics->tap_halves = (int *) memory;
+    memory += offsets[7];
+    mics->values = (float(*)[2]) memory;
+    memory += offsets[8];
+    mics->part_buffers = (float **) memory;
+
+    // Keep the layout's reading order, with its radius expressed in junctions
+    memcpy(mic_rel_xyz_j, layout->mic_rel_xyz_j, sizeof(float[3]) * channel_count);
+    memcpy(channels, layout->channels, sizeof(int) * channel_count);
+    mics->channel_count = channel_count;
+    mics->radius_m = layout->radius_j;
+    mics->radius_junction_m = 1.0f;
+    mics->mic_rel_xyz_j = (const float(*)[3]) mic_rel_xyz_j;
+    mics->channels = channels;
+
+    // Extend the encoder to the new layout, and the output resampling to its channels
+    dwm_encoder_t *encoder = NULL;
+    dwm_host_t *host = NULL;
+    if (handle->encoder != NULL) {
+        encoder = create_encoder(handle, handle->encoder->order, mics);
+    }
+    if (handle->host != NULL && handle->host->out_capacity < channel_count) {
+        host = create_host(handle, handle->host->sample_rate, mics);
+    }
+    if ((handle->encoder != NULL && encoder == NULL) ||
+        (handle->host != NULL && handle->host->out_capacity < channel_count && host == NULL)) {
+        free(encoder);
+        destroy_host(host);
+        free(mics);
+        return 1;
+    }
+    if (encoder != NULL) {
+        free(handle->encoder);
+        handle->encoder = encoder;
+    }
+    if (host != NULL) {
+        destroy_host(handle->host);
+        handle->host = host;
+    }
+    free(handle->custom_layout);
+    handle->custom_layout = mics;
+    handle->setup.valid = 0;
+    destroy_convolution(handle);
+    return 0;
+}
+
+int dwm_ma_set_ambisonics_order(void *dwm_ma, const int order) {
+    dwm_ma_t *handle = dwm_ma;
+    if (order > MA_AMBISONICS_MAX_ORDER) {
+        return 1;
+    }
+    dwm_encoder_t *encoder = NULL;
+    if (order >= 0) {
+        encoder = create_encoder(handle, order, handle->custom_layout);
+        if (encoder == NULL) {
+            return 1;
+        }
+    }
+    free(handle->encoder);
+    handle->encoder = encoder;
+    handle->setup.valid = 0;
+    destroy_convolution(handle);
+    return 0;
+}
+
+int dwm_ma_set_host_sample_rate(void *dwm_ma, const int host_sample_rate) {
+    dwm_ma_t *handle = dwm_ma;
+    dwm_host_t *host = NULL;
+    if (host_sample_rate != 0 && host_sample_rate != handle->sample_rate) {
+        host = create_host(handle, host_sample_rate, handle->custom_layout);
+        if (host == NULL) {
+            return 1;
+        }
+    }
+    destroy_host(handle->host);
+    handle->host = host;
+    handle->call_frame_count = host != NULL ? host->buffer_size : handle->buffer_size;
+    destroy_convolution(handle);
+    return 0;
+}
+
+int dwm_ma_capture_convolution(void *dwm_ma, const float *const *in_positions_m, int in_count,
+                               const MA_CONFIG ma_config, float ma_scale, const float *ma_position_m,
+                               const int rir_length) {
+    dwm_ma_t *handle = dwm_ma;
+    destroy_convolution(handle);
+    in_count = clampi(in_count, 0, DWM_MA_MAX_INPUT_COUNT);
+    ma_scale = fclampf(ma_scale, 1.0f, 10.0f);
+    if (rir_length <= 0 || in_count == 0) {
+        return rir_length > 0;
+    }
+
+    // Responses are captured with the buffers the host exchanges, partitioned in blocks of a buffer
+    handle->frame_count = handle->buffer_size;
+    const int block_size = handle->host != NULL ? handle->host->buffer_size : handle->buffer_size;
+    if (handle->host != NULL) {
+        handle->host->frame_count = block_size;
+    }
+    const int length = (rir_length + block_size - 1) / block_size * block_size;
+    dwm_builtin_mic_array_t builtin;
+    const int out_count = handle->encoder != NULL ? handle->encoder->channel_count
+                                                  : select_mic_array(handle, ma_config, &builtin)->channel_count;
+    dwm_convolution_t *convolution = malloc(sizeof(dwm_convolution_t));
+    float *rirs = malloc(sizeof(float) * out_count * length);
+    float **ma_buffers = malloc(sizeof(float *) * out_count);
+    float *impulse = calloc(2 * block_size, sizeof(float));
+    void *convolver = NULL;
+    if (convolution == NULL || rirs == NULL || ma_buffers == NULL || impulse == NULL ||
+        dwm_ma_convolver_create(&convolver, block_size, length, in_count, out_count) != 0) {
+        free(convolution);
+        free(rirs);
+        free(ma_buffers);
+        free(impulse);
+        return 1;
+    }
+
+    // Every input is present in every simulation (their junction writes are part of the scene), the impulse being
+    // emitted by one of them at a time while the others are silent
+    const float *in_buffers[DWM_MA_MAX_INPUT_COUNT];
+    const float *silence = impulse + block_size;
+    for (int i = 0; i < in_count; i++) {
+        clear_state(handle);
+        for (int k = 0; k < in_count; k++) {
+            in_buffers[k] = k == i ? impulse : silence;
+        }
+        for (int n = 0; n < length; n += block_size) {
+            impulse[0] = n == 0 ? 1.0f : 0.0f;
+            for (int c = 0; c < out_count; c++) {
+                ma_buffers[c] = rirs + c * length + n;
+            }
+            process_live(handle, in_buffers, in_positions_m, in_positions_m, in_count, ma_config, ma_scale,
+                         ma_buffers, ma_position_m, ma_position_m);
+        }
+        for (int c = 0; c < out_count; c++) {
+            dwm_ma_convolver_set_response(convolver, i, c, rirs + c * length);
+        }
+    }
+    clear_state(handle);
+    free(rirs);
+    free(ma_buffers);
+    free(impulse);
+
+    // Store the scene the responses belong to
+    convolution->convolver = convolver;
+    convolution->rir_length = length;
+    convolution->block_size = block_size;
+    convolution->in_count = in_count;
+    convolution->out_count = out_count;
+    for (int i = 0; i < in_count; i++) {
+        memcpy(convolution->in_positions_m[i], in_positions_m[i], sizeof(float[3]));
+    }
+    convolution->ma_config = ma_config;
+    convolution->ma_scale = ma_scale;
+    memcpy(convolution->ma_position_m, ma_position_m, sizeof(float[3]));
+    memcpy(convolution->b_params, handle->b_params, sizeof(handle->b_params));
+    convolution->mesh_tail = 0;
+    convolution->convolver_tail = 0;
+    handle->convolution = convolution;
+    return 0;
+}
+
+void dwm_ma_set_stats_enabled(void *dwm_ma, const int enabled) {
+    dwm_ma_t *handle = dwm_ma;
+    handle->stats_enabled = enabled != 0;
+}
+
+void dwm_ma_set_stats_deadline(void *dwm_ma, const uint64_t deadline_ns) {
+    dwm_ma_t *handle = dwm_ma;
+    handle->stats.deadline_ns = deadline_ns;
+}
+
+void dwm_ma_get_stats(const void *dwm_ma, dwm_ma_stats *stats) {
+    const dwm_ma_t *handle = dwm_ma;
+    *stats = handle->stats;
+    stats->deadline_ns = stats_deadline_ns(handle);
+}
+
+void dwm_ma_reset_stats(void *dwm_ma) {
+    dwm_ma_t *handle = dwm_ma;
+    const uint64_t deadline_ns = handle->stats.deadline_ns;
+    memset(&handle->stats, 0, sizeof(handle->stats));
+    handle->stats.deadline_ns = deadline_ns;
+}
+
+void dwm_ma_init(void *dwm_ma, const float dwm_bound_params[6][2], const int dwm_bound_params_normalized) {
+    dwm_ma_t *handle = dwm_ma;
+
+    // Set initial memory state, including the convolver's
+    clear_state(handle);
+    if (handle->convolution != NULL) {
+        dwm_ma_convolver_reset(handle->convolution->convolver);
+        handle->convolution->mesh_tail = 0;
+        handle->convolution->convolver_tail = 0;
+    }
+
+    // Handle the boundary parameters, which replace any pending ramp and any boundary map
+    end_boundary_ramps(handle);
+    for (int i = 0; i < 6; i++) {
+        convert_boundary_params(dwm_bound_params[i], dwm_bound_params_normalized, handle->b_params[i]);
+        if (handle->b_maps[i] != NULL) {
+            handle->b_maps[i]->active = 0;
+        }
+    }
+}
+
+void dwm_ma_set_boundary_params(void *dwm_ma, const float dwm_bound_params[6][2],
+                                const int dwm_bound_params_normalized) {
+    dwm_ma_t *handle = dwm_ma;
+    for (int f = 0; f < 6; f++) {
+        begin_boundary_ramp(handle, f);
+        convert_boundary_params(dwm_bound_params[f], dwm_bound_params_normalized, handle->b_params[f]);
+
+        // A map ramps towards the uniform values, spread over its target values
+        dwm_boundary_map_t *map = handle->b_maps[f];
+        if (map != NULL && map->ramp) {
+            const int n = face_size_j(handle, f);
+            for (int i = 0; i < n; i++) {
+                map->r1[i] = handle->b_params[f][0];
+                map->r2[i] = handle->b_params[f][1];
+            }
+        }
+        if (map != NULL) {
+            map->active = 0;
+        }
+    }
+}
+
+int dwm_ma_set_boundary_map(void *dwm_ma, const int face, const float (*params)[2], const int params_normalized) {
+    dwm_ma_t *handle = dwm_ma;
+    if (face < 0 || face >= 6) {
+        return 1;
+    }
+    const int n = face_size_j(handle, face);
+    dwm_boundary_map_t *map = handle->b_maps[face];
+    if (params == NULL) {
+        // Ramp back to the face's uniform values, if its map is in use
+        if (map == NULL || !map->active) {
+            return 0;
+        }
+        begin_boundary_ramp(handle, face);
+        for (int i = 0; i < n; i++) {
+            map->r1[i] = handle->b_params[face][0];
+            map->r2[i] = handle->b_params[face][1];
+        }
+        map->active = 0;
+        destroy_convolution(handle);
+        return 0;
+    }
+    if (map == NULL) {
+        map = create_boundary_map(n);
+        if (map == NULL) {
+            return 1;
+        }
+        handle->b_maps[face] = map;
+    }
+
+    // A ramp starting from the uniform values spreads them over the map's start values
+    begin_boundary_ramp(handle, face);
+    if (!map->ramp) {
+        for (int i = 0; i < n; i++) {
+            map->from_r1[i] = handle->b_params_from[face][0];
+            map->from_r2[i] = handle->b_params_from[face][1];
+        }
+        map->ramp = 1;
+    }
+    for (int i = 0; i < n; i++) {
+        float r[2];
+        convert_boundary_params(params[i], params_normalized, r);
+        map->r1[i] = r[0];
+        map->r2[i] = r[1];
+    }
+    map->active = 1;
+    destroy_convolution(handle);
+    return 0;
+}
+
+void dwm_ma_process_interpolated(void *dwm_ma, const float *const *in_buffers, const float *const *in_positions_m,
+                                 const int in_count, const MA_CONFIG ma_config, const float ma_scale,
+                                 float *const *ma_buffers, const float *ma_position_m) {
+    dwm_ma_process_trajectory(dwm_ma, in_buffers, in_positions_m, in_positions_m, in_count, ma_config, ma_scale,
+                              ma_buffers, ma_position_m, ma_position_m);
+}
+
+void dwm_ma_process_trajectory(void *dwm_ma, const float *const *in_buffers, const float *const *in_positions_start_m,
+                               const float *const *in_positions_end_m, const int in_count, const MA_CONFIG ma_config,
+                               const float ma_scale, float *const *ma_buffers, const float *ma_position_start_m,
+                               const float *ma_position_end_m) {
+    const dwm_ma_t *handle = dwm_ma;
+    dwm_ma_process_frames(dwm_ma, in_buffers, in_positions_start_m, in_positions_end_m, in_count, ma_config, ma_scale,
+                          ma_buffers, ma_position_start_m, ma_position_end_m,
+                          handle->host != NULL ? handle->host->buffer_size : handle->buffer_size);
+}
+
+int dwm_ma_process_frames(void *dwm_ma, const float *const *in_buffers, const float *const *in_positions_start_m,
+                          const float *const *in_positions_end_m, int in_count, const MA_CONFIG ma_config,
+                          const float ma_scale, float *const *ma_buffers, const float *ma_position_start_m,
+                          const float *ma_position_end_m, const int frame_count) {
+    dwm_ma_t *handle = dwm_ma;
+    if (frame_count < 0) {
+        return 1;
+    }
+    if (frame_count == 0) {
+        return 0;
+    }
+    handle->call_frame_count = frame_count;
+    const uint64_t begin_ns = handle->stats_enabled ? now_ns() : 0;
+    handle->stats_lap_ns = begin_ns;
+    handle->stats_timing = handle->stats_enabled;
+
+    // Calls of up to a buffer (at the host's rate if the instance has one) are rendered at once, longer ones in parts
+    // of a buffer whose moving objects follow the same trajectory, from the positions at the parts' first samples
+    // (still objects keep their exact positions, the scene staying the same for the setup cache and the captured scene)
+    const int buffer_size = handle->host != NULL ? handle->host->buffer_size : handle->buffer_size;
+    if (frame_count <= buffer_size) {
+        process_scene(handle, in_buffers, in_positions_start_m, in_positions_end_m, in_count, ma_config, ma_scale,
+                      ma_buffers, ma_position_start_m, ma_position_end_m, frame_count);
+    } else {
+        in_count = clampi(in_count, 0, DWM_MA_MAX_INPUT_COUNT);
+        const int out_count = output_count(handle, ma_config);
+        float **part_buffers = out_count <= PART_CAPACITY ? handle->part_buffers : handle->custom_layout->part_buffers;
+        float in_positions_m[2][DWM_MA_MAX_INPUT_COUNT][3], ma_positions_m[2][3];
+        const float *part_in_buffers[DWM_MA_MAX_INPUT_COUNT];
+        const float *part_positions_start_m[DWM_MA_MAX_INPUT_COUNT], *part_positions_end_m[DWM_MA_MAX_INPUT_COUNT];
+        for (int begin = 0; begin < frame_count; begin += buffer_size) {
+            const int end = mini(begin + buffer_size, frame_count);
+            const float t_begin = (float) begin / (float) frame_count, t_end = (float) end / (float) frame_count;
+            for (int i = 0; i < in_count; i++) {
+                part_in_buffers[i] = in_buffers[i] + begin;
+                part_positions_start_m[i] = in_positions_start_m[i];
+                part_positions_end_m[i] = in_positions_end_m[i];
+                if (memcmp(in_positions_start_m[i], in_positions_end_m[i], sizeof(float) * 3) != 0) {
+                    lerp_position(in_positions_start_m[i], in_positions_end_m[i], t_begin, in_positions_m[0][i]);
+                    lerp_position(in_positions_start_m[i], in_positions_end_m[i], t_end, in_positions_m[1][i]);
+                    part_positions_start_m[i] = begin > 0 ? in_positions_m[0][i] : in_positions_start_m[i];
+                    part_positions_end_m[i] = end < frame_count ? in_positions_m[1][i] : in_positions_end_m[i];
+                }
+            }
+            const float *part_position_start_m = ma_position_start_m, *part_position_end_m = ma_position_end_m;
+            if (memcmp(ma_position_start_m, ma_position_end_m, sizeof(float) * 3) != 0) {
+                lerp_position(ma_position_start_m, ma_position_end_m, t_begin, ma_positions_m[0]);
+                lerp_position(ma_position_start_m, ma_position_end_m, t_end, ma_positions_m[1]);
+                part_position_start_m = begin > 0 ? ma_positions_m[0] : ma_position_start_m;
+                part_position_end_m = end < frame_count ? ma_positions_m[1] : ma_position_end_m;
+            }
+            for (int c = 0; c < out_count; c++) {
+                part_buffers[c] = ma_buffers[c] + begin;
+            }
+            process_scene(handle, part_in_buffers, part_positions_start_m, part_positions_end_m, in_count, ma_config,
+                          ma_scale, part_buffers, part_position_start_m, part_position_end_m, end - begin);
+        }
+    }
+    if (handle->stats_enabled) {
+        handle->stats_timing = 0;
+        stats_call(handle, begin_ns);
+    }
+    return 0;
+}
+
+int output_count(const dwm_ma_t *handle, const MA_CONFIG ma_config) {
+    if (handle->encoder != NULL) {
+        return handle->encoder->channel_count;
+    }
+    if (ma_config == MA_CONFIG_CUSTOM && handle->custom_layout != NULL) {
+        return handle->custom_layout->channel_count;
+    }
+    return ma_config_layout(ma_config)->channel_count;
+}
+
+void process_scene(dwm_ma_t *handle, const float *const *in_buffers, const float *const *in_positions_start_m,
+                   const float *const *in_positions_end_m, const int in_count, const MA_CONFIG ma_config,
+                   const float ma_scale, float *const *ma_buffers, const float *ma_position_start_m,
+                   const float *ma_position_end_m, const int frame_count) {
+    if (handle->host != NULL) {
+        handle->host->frame_count = frame_count;
+    } else {
+        handle->frame_count = frame_count;
+    }
+    dwm_convolution_t *convolution = handle->convolution;
+    if (convolution == NULL) {
+        process_live(handle, in_buffers, in_positions_start_m, in_positions_end_m, in_count, ma_config, ma_scale,
+                     ma_buffers, ma_position_start_m, ma_position_end_m);
+        return;
+    }
+
+    // The captured scene is rendered by the convolver, the mesh only producing the tail of its previous inputs (if
+    // any), which is then cleared so that live rendering restarts from silence
+    if (is_captured_scene(handle, in_positions_start_m, in_positions_end_m, in_count, ma_config, ma_scale,
+                          ma_position_start_m, ma_position_end_m)) {
+        const int mesh_tail = convolution->mesh_tail > 0;
+        if (mesh_tail) {
+            process_live(handle, NULL, NULL, NULL, 0, ma_config, ma_scale, ma_buffers, ma_position_start_m,
+                         ma_position_end_m);
+            convolution->mesh_tail -= frame_count;
+            if (convolution->mesh_tail <= 0) {
+                clear_state(handle);
+            }
+        }
+        dwm_ma_convolver_process(convolution->convolver, in_buffers, ma_buffers, frame_count, convolution->out_count,
+                                 mesh_tail);
+        stats_lap(handle, DWM_MA_PHASE_CONVOLUTION);
+        convolution->convolver_tail = convolution->rir_length;
+        return;
+    }
+
+    // Any other scene is simulated live, the convolver only producing the tail of its previous inputs (if any)
+    const int out_count = process_live(handle, in_buffers, in_positions_start_m, in_positions_end_m, in_count,
+                                       ma_config, ma_scale, ma_buffers, ma_position_start_m, ma_position_end_m);
+    convolution->mesh_tail = convolution->rir_length;
+    if (convolution->convolver_tail > 0) {
+        dwm_ma_convolver_process(convolution->convolver, NULL, ma_buffers, frame_count,
+                                 mini(out_count, convolution->out_count), 1);
+        stats_lap(handle, DWM_MA_PHASE_CONVOLUTION);
+        convolution->convolver_tail -= frame_count;
+    }
+}
+
+int process_live(dwm_ma_t *handle, const float *const *in_buffers, const float *const *in_positions_start_m,
+                 const float *const *in_positions_end_m, int in_count, const MA_CONFIG ma_config, float ma_scale,
+                 float *const *ma_buffers, const float *ma_position_start_m, const float *ma_position_end_m) {
+    // Protect against non-valid parameters
+    ma_scale = fclampf(ma_scale, 1.0f, 10.0f);
+    in_count = clampi(in_count, 0, DWM_MA_MAX_INPUT_COUNT);
+
+    // Resample the inputs to the mesh's rate, the mesh then reading and writing buffers of its own rate for as many
+    // steps as the input resampler has mesh samples for the call
+    if (handle->host != NULL) {
+        dwm_host_t *host = handle->host;
+        handle->frame_count = dwm_ma_resampler_available_count(host->in_resampler, host->frame_count);
+        for (int i = 0; i < in_count; i++) {
+            dwm_ma_resampler_process(host->in_resampler, i, in_buffers[i], host->frame_count, host->in_buffers[i],
+                                     handle->frame_count);
+        }
+        dwm_ma_resampler_advance(host->in_resampler, host->frame_count, handle->frame_count);
+        in_buffers = (const float *const *) host->in_buffers;
+    }
+
+    int input_moving[DWM_MA_MAX_INPUT_COUNT], inputs_moving = 0;
+    for (int i = 0; i < in_count; i++) {
+        input_moving[i] = memcmp(in_positions_start_m[i], in_positions_end_m[i], sizeof(float) * 3) != 0;
+        inputs_moving |= input_moving[i];
+    }
+    const int ma_moving = memcmp(ma_position_start_m, ma_position_end_m, sizeof(float) * 3) != 0;
+    const int any_moving = inputs_moving || ma_moving;
+    dwm_setup_t *setup = &handle->setup;
+    float(*input_int_percents)[3] = setup->input_int_percents;
+    int(*input_int_indices)[2][2][2] = setup->input_int_indices;
+    dwm_taps_t *taps = &setup->taps;
+    if (any_moving ||
+        !is_setup_cached(handle, in_positions_start_m, in_count, ma_config, ma_scale, ma_position_start_m)) {
+        // Preprocess each input coordinate's interpolation parameters and the output microphone array's, which stay
+        // the same during the entire call for still objects
+        for (int i = 0; i < in_count; i++) {
+            compute_interpolation_parameters_m(handle, in_positions_start_m[i], input_int_percents[i],
+                                               input_int_indices[i]);
+        }
+        setup->mics = select_mic_array(handle, ma_config, &setup->builtin);
+        compute_ma_interpolation_parameters(handle, setup->mics, ma_scale, ma_position_start_m);
+
+        // Sort the junctions written by the inputs and read by the microphones by Z-plane, for the stencil sweep to
+        // write and read them as it produces each plane
+        taps->mics = setup->mics;
+        build_source_taps(handle, in_count, input_int_percents, input_int_indices, taps);
+        build_mic_taps(handle, taps);
+
+        // Only the setup of still objects is kept for the next calls
+        setup->valid = !any_moving;
+        setup->in_count = in_count;
+        for (int i = 0; i < in_count; i++) {
+            memcpy(setup->in_positions_m[i], in_positions_start_m[i], sizeof(float[3]));
+        }
+        setup->ma_config = ma_config;
+        setup->ma_scale = ma_scale;
+        memcpy(setup->ma_position_m, ma_position_start_m, sizeof(float[3]));
+    }
+    dwm_mic_array_t *mics = setup->mics;
+    taps->in_buffers = in_buffers;
+    taps->ma_buffers = handle->encoder != NULL ? handle->encoder->mic_buffers
+                       : handle->host != NULL  ? handle->host->out_buffers
+                                               : ma_buffers;
+    handle->taps = taps;
+
+    // A call too short for any mesh step only outputs the host samples the output resampler kept from the previous ones
+    if (handle->frame_count == 0) {
+        handle->taps = NULL;
+        return write_outputs(handle, mics, ma_buffers);
+    }
+
+    // Activate the junctions of each still input which is not silent during the call and of each moving input whose
+    // first sample is not silent (silent inputs leave silent junctions untouched)
+    for (int i = 0; i < in_count; i++) {
+        for (int n = 0; n < (input_moving[i] ? 1 : handle->frame_count); n++) {
+            if (in_buffers[i][n] != 0.0f) {
+                extend_active_region(handle, input_int_indices[i]);
+                break;
+            }
+        }
+    }
+    stats_lap(handle, DWM_MA_PHASE_PRECOMPUTE);
+
+    // Run frame_count simulation iterations, either in temporal blocks (still objects only) or one at a time
+    if (handle->temporal_block_size > 1 && handle->pool == NULL && !any_moving) {
+        process_buffer_blocked(handle);
+        handle->taps = NULL;
+        end_boundary_ramps(handle);
+        const int out_count = write_outputs(handle, mics, ma_buffers);
+        stats_lap(handle, DWM_MA_PHASE_OUTPUT);
+        return out_count;
+    }
+    // The first sources are written ahead of the sweep, which then writes each following sample right after
+    // producing the planes it lies on
+    write_source_taps(handle, taps, handle->p, 0, 0, handle->size_z_j);
+    stats_lap(handle, DWM_MA_PHASE_INJECTION);
+    for (int n = 0; n < handle->frame_count; n++) {
+        // Move each moving object along its trajectory, sample n being at n / frame_count of the way between its start
+        // and end positions (the end position being the one of the next call's first sample): step n reads sample n
+        // of the microphones and writes sample n + 1 of the inputs
+        float position_m[3];
+        if (ma_moving && n > 0) {
+            lerp_position(ma_position_start_m, ma_position_end_m, (float) n / (float) handle->frame_count,
+                          position_m);
+            compute_ma_interpolation_parameters(handle, mics, ma_scale, position_m);
+            build_mic_taps(handle, taps);
+        }
+        taps->source_n = n + 1 < handle->frame_count ? n + 1 : -1;
+        taps->mic_n = n;
+        if (inputs_moving && taps->source_n >= 0) {
+            for (int i = 0; i < in_count; i++) {
+                if (input_moving[i]) {
+                    lerp_position(in_positions_start_m[i], in_positions_end_m[i],
+                                  (float) taps->source_n / (float) handle->frame_count, position_m);
+                    compute_interpolation_parameters_m(handle, position_m, input_int_percents[i],
+                                                       input_int_indices[i]);
+                }
+            }
+            build_source_taps(handle, in_count, input_int_percents, input_int_indices, taps);
+        }
+        if (any_moving) {
+            stats_lap(handle, DWM_MA_PHASE_PRECOMPUTE);
+        }
+
+        dilate_active_region(handle, 1, handle->update_begin, handle->update_end);
+        handle->b_step = n;
+        process_iteration(handle); // Single simulation interation
+        memcpy(handle->active_begin, handle->update_begin, sizeof(handle->active_begin));
+        memcpy(handle->active_end, handle->update_end, sizeof(handle->active_end));
+        for (int i = 0; i < in_count && taps->source_n >= 0; i++) {
+            if (input_moving[i] && in_buffers[i][taps->source_n] != 0.0f) {
+                extend_active_region(handle, input_int_indices[i]);
+            }
+        }
+        {
+            void *aux = handle->p; // Post iteration buffer swapping
+            handle->p = handle->p_aux;
+            handle->p_aux = aux;
+        }
+    }
+    handle->taps = NULL;
+    end_boundary_ramps(handle);
+    const int out_count = write_outputs(handle, mics, ma_buffers);
+    stats_lap(handle, DWM_MA_PHASE_OUTPUT);
+    return out_count;
+}
+
+int is_config_valid(const dwm_ma_mesh_config *config) {
+    return config->sample_rate >= 1 && config->buffer_size >= 1 && config->size_x_j >= 3 && config->size_y_j >= 3 &&
+           config->size_z_j >= 3 && config->sound_propagation_speed >= 1 &&
+           (config->storage == DWM_MA_STORAGE_FLOAT32 || config->storage == DWM_MA_STORAGE_FLOAT16 ||
+            config->storage == DWM_MA_STORAGE_BFLOAT16) &&
+           (config->topology == DWM_MA_TOPOLOGY_RECTILINEAR ||
+            (config->topology == DWM_MA_TOPOLOGY_INTERPOLATED && config->storage == DWM_MA_STORAGE_FLOAT32));
+}
+
+void get_mesh_config(const dwm_ma_t *handle, dwm_ma_mesh_config *config) {
+    config->sample_rate = handle->sample_rate;
+    config->buffer_size = handle->buffer_size;
+    config->size_x_j = handle->size_x_j;
+    config->size_y_j = handle->size_y_j;
+    config->size_z_j = handle->size_z_j;
+    config->sound_propagation_speed = handle->sound_propagation_speed;
+    config->storage = handle->storage;
+    config->topology = handle->topology;
+}
+
+void copy_state_to_block(const dwm_ma_t *handle, char *block) {
+    dwm_ma_mesh_config config;
+    get_mesh_config(handle, &config);
+    size_t b_offsets[6], p_offset, p_aux_offset;
+    compute_memory_layout(&config, b_offsets, &p_offset, &p_aux_offset);
+
+    // The boundary filters are contiguous, right after the handle of every instance
+    const size_t p_size = storage_size(handle->storage) * handle->size_x_j * handle->size_y_j * handle->size_z_j;
+    memcpy(block + b_offsets[0], (const char *) handle + b_offsets[0], p_offset - b_offsets[0]);
+    memcpy(block + p_offset, handle->p, p_size);
+    memcpy(block + p_aux_offset, handle->p_aux, p_size);
+}
+
+dwm_geometry_t *copy_geometry(const dwm_geometry_t *geometry) {
+    // The material parameters are the last array of the geometry's memory block
+    const char *begin = (const char *) geometry;
+    const size_t size = (size_t) ((const char *) (geometry->material_params + geometry->group_count - 6) - begin);
+    char *memory = malloc(size);
+    if (memory == NULL) {
+        return NULL;
+    }
+    memcpy(memory, geometry, size);
+    dwm_geometry_t *copy = (dwm_geometry_t *) memory;
+#define REBASE(FIELD) copy->FIELD = (void *) (memory + ((const char *) geometry->FIELD - begin))
+    REBASE(run_offsets);
+    REBASE(runs);
+    REBASE(edge_offsets);
+    REBASE(edges);
+    REBASE(link_offsets);
+    REBASE(link_junctions);
+    REBASE(links.t1);
+    REBASE(links.t2);
+    REBASE(links.t3);
+    REBASE(links.out);
+    REBASE(material_params);
+#undef REBASE
+    return copy;
+}
+
+int copy_settings(dwm_ma_t *copy, const dwm_ma_t *handle) {
+    if (handle->geometry != NULL) {
+        copy->geometry = copy_geometry(handle->geometry);
+        if (copy->geometry == NULL) {
+            return 1;
+        }
+        select_process_slab(copy);
+    }
+
+    // The custom layout is already sorted and its radius expressed in junctions, it is thus set as is
+    if (handle->custom_layout != NULL) {
+        const dwm_mic_array_t *mics = handle->custom_layout;
+        const ma_custom_layout layout = {mics->channel_count, mics->radius_m, (float(*)[3]) mics->mic_rel_xyz_j,
+                                         (int *) mics->channels};
+        if (dwm_ma_set_custom_layout(copy, &layout) != 0) {
+            return 1;
+        }
+    }
+    if (handle->encoder != NULL && dwm_ma_set_ambisonics_order(copy, handle->encoder->order) != 0) {
+        return 1;
+    }
+    if (handle->host != NULL) {
+        if (dwm_ma_set_host_sample_rate(copy, handle->host->sample_rate) != 0) {
+            return 1;
+        }
+        dwm_ma_resampler_copy_state(copy->host->in_resampler, handle->host->in_resampler);
+        dwm_ma_resampler_copy_state(copy->host->out_resampler, handle->host->out_resampler);
+    }
+    if (handle->pool != NULL) {
+        dwm_ma_set_thread_count(copy, dwm_ma_pool_get_thread_count(handle->pool));
+    }
+    for (int f = 0; f < 6; f++) {
+        const dwm_boundary_map_t *map = handle->b_maps[f];
+        if (map != NULL) {
+            const int n = face_size_j(handle, f);
+            copy->b_maps[f] = create_boundary_map(n);
+            if (copy->b_maps[f] == NULL) {
+                return 1;
+            }
+            memcpy(copy->b_maps[f]->r1, map->r1, sizeof(float) * n);
+            memcpy(copy->b_maps[f]->r2, map->r2, sizeof(float) * n);
+            memcpy(copy->b_maps[f]->from_r1, map->from_r1, sizeof(float) * n);
+            memcpy(copy->b_maps[f]->from_r2, map->from_r2, sizeof(float) * n);
+            copy->b_maps[f]->active = map->active;
+            copy->b_maps[f]->ramp = map->ramp;
+        }
+    }
+    memcpy(copy->b_params_from, handle->b_params_from, sizeof(copy->b_params_from));
+    memcpy(copy->b_ramp, handle->b_ramp, sizeof(copy->b_ramp));
+    copy->temporal_block_size = handle->temporal_block_size;
+    copy->stats_enabled = handle->stats_enabled;
+    copy->stats.deadline_ns = handle->stats.deadline_ns;
+    return 0;
+}
+
+size_t compute_memory_layout(const dwm_ma_mesh_config *config, size_t b_offsets[6], size_t *p_offset,
+                             size_t *p_aux_offset) {
+    const size_t x = config->size_x_j, y = config->size_y_j, z = config->size_z_j;
+    const size_t face_sizes[6] = {x * y, x * z, y * z, y * z, x * z, x * y};
+    const size_t p_size = storage_size(config->storage) * x * y * z;
+
+    // Handle first, then the boundary filters (4 arrays per face) and the junction pressures
+    size_t offset = align_size(sizeof(dwm_ma_t));
+    for (int f = 0; f < 6; f++) {
+        b_offsets[f] = offset;
+        offset += align_size(sizeof(float) * 4 * face_sizes[f]);
+    }
+    *p_offset = offset;
+    offset += align_size(p_size);
+
+    // The step stores to p_aux[i] next to loads from p around i, place p_aux half a page away from p modulo the page
+    // size so that those addresses never share their lower 12 bits (4K aliasing)
+    *p_aux_offset = offset + (*p_offset + 2048 - offset % 4096 + 4096) % 4096;
+    return *p_aux_offset + align_size(p_size);
+}
+
+size_t align_size(const size_t size) {
+    return (size + DWM_MA_MEMORY_ALIGNMENT - 1) & ~(size_t) (DWM_MA_MEMORY_ALIGNMENT - 1);
+}
+
+void clear_active_region(dwm_ma_t *handle) {
+    for (int k = 0; k < 3; k++) {
+        handle->active_begin[k] = 0;
+        handle->active_end[k] = 0;
+    }
+}
+
+void extend_active_region(dwm_ma_t *handle, const int interp_indices[2][2][2]) {
+    // The source's first and last interpolation junctions are the corners of the box it writes
+    const int size_j[3] = {handle->size_x_j, handle->size_y_j, handle->size_z_j};
+    const int first = interp_indices[0][0][0], last = interp_indices[1][1][1];
+    const int first_j[3] = {first % size_j[0], first / size_j[0] % size_j[1], first / (size_j[0] * size_j[1])};
+    const int last_j[3] = {last % size_j[0], last / size_j[0] % size_j[1], last / (size_j[0] * size_j[1])};
+    const int empty = handle->active_begin[0] >= handle->active_end[0];
+    for (int k = 0; k < 3; k++) {
+        handle->active_begin[k] = empty ? first_j[k] : mini(handle->active_begin[k], first_j[k]);
+        handle->active_end[k] = empty ? last_j[k] + 1 : maxi(handle->active_end[k], last_j[k] + 1);
+    }
+}
+
+void dilate_active_region(const dwm_ma_t *handle, const int steps, int begin[3], int end[3]) {
+    const int size_j[3] = {handle->size_x_j, handle->size_y_j, handle->size_z_j};
+    const int empty = handle->active_begin[0] >= handle->active_end[0];
+    for (int k = 0; k < 3; k++) {
+        const int active_begin = handle->active_begin[k], active_end = handle->active_end[k];
+        begin[k] = empty ? 0 : maxi(active_begin - steps, 0);
+        end[k] = empty ? 0 : mini(active_end + steps, size_j[k]);
+    }
+}
+
+static int linearized_index_xyz(const dwm_ma_t *handle, const int x_j, const int y_j, const int z_j) {
+    return (z_j * handle->size_y_j + y_j) * handle->size_x_j + x_j;
+}
+
+size_t storage_size(const DWM_MA_STORAGE storage) {
+    return storage == DWM_MA_STORAGE_FLOAT32 ? sizeof(float) : sizeof(uint16_t);
+}
+
+float load_junction(const void *p, const int i, const DWM_MA_STORAGE storage) {
+    switch (storage) {
+        case DWM_MA_STORAGE_FLOAT16:
+            return dwm_ma_f16_to_f32(((const uint16_t *) p)[i]);
+        case DWM_MA_STORAGE_BFLOAT16:
+            return dwm_ma_bf16_to_f32(((const uint16_t *) p)[i]);
+        default:
+            return ((const float *) p)[i];
+    }
+}
+
+void load_junctions(float *dst, const void *p, const int i, const int count, const int stride,
+                    const DWM_MA_STORAGE storage) {
+    if (storage == DWM_MA_STORAGE_FLOAT32 && stride == 1) {
+        memcpy(dst, (const float *) p + i, sizeof(float) * count);
+        return;
+    }
+    for (int k = 0; k < count; k++) {
+        dst[k] = load_junction(p, i + k * stride, storage);
+    }
+}
+
+void store_junction(void *p, const int i, const float value, const DWM_MA_STORAGE storage) {
+    switch (storage) {
+        case DWM_MA_STORAGE_FLOAT16:
+            ((uint16_t *) p)[i] = dwm_ma_f32_to_f16(value);
+            break;
+        case DWM_MA_STORAGE_BFLOAT16:
+            ((uint16_t *) p)[i] = dwm_ma_f32_to_bf16(value);
+            break;
+        default:
+            ((float *) p)[i] = value;
+    }
+}
+
+int face_size_j(const dwm_ma_t *handle, const int face) {
+    return dwm_ma_face_size_j(handle->size_x_j, handle->size_y_j, handle->size_z_j, face);
+}
+
+void compute_interpolation_parameters_m(const dwm_ma_t *handle, const float *pos_m, float interp_percents[3],
+                                        int interp_indices[2][2][2]) {
+    // Translate the metric coordinates to floating point junction coordinates
+    dwm_ma_compute_interpolation_parameters_j(handle->size_x_j, handle->size_y_j, handle->size_z_j,
+                                              pos_m[0] * handle->metric_2_junction - 0.5f,
+                                              pos_m[1] * handle->metric_2_junction - 0.5f,
+                                              pos_m[2] * handle->metric_2_junction - 0.5f, interp_percents,
+                                              interp_indices);
+}
+
+void compute_interpolation_parameters_ma(const dwm_ma_t *handle, const float *pos_j_rel, const float *pos_m_offset,
+                                         const float ma_scale, float interp_percents[3], int interp_indices[2][2][2]) {
+    // Translate the relative and metric coordinates to floating point junction coordinates
+    dwm_ma_compute_interpolation_parameters_j(
+            handle->size_x_j, handle->size_y_j, handle->size_z_j,
+            pos_j_rel[0] * ma_scale + pos_m_offset[0] * handle->metric_2_junction - 0.5f,
+            pos_j_rel[1] * ma_scale + pos_m_offset[1] * handle->metric_2_junction - 0.5f,
+            pos_j_rel[2] * ma_scale + pos_m_offset[2] * handle->metric_2_junction - 0.5f, interp_percents,
+            interp_indices);
+}
+
+dwm_mic_array_t *select_mic_array(dwm_ma_t *handle, const MA_CONFIG ma_config, dwm_builtin_mic_array_t *builtin) {
+    if (ma_config == MA_CONFIG_CUSTOM && handle->custom_layout != NULL) {
+        handle->custom_layout->encoder_matrix =
+                handle->encoder != NULL ? handle->encoder->matrices[MA_CONFIG_CUSTOM] : NULL;
+        return handle->custom_layout;
+    }
+
+    // Built-in layouts are read in channel order, with their radii expressed in compile-time junction sizes
+    const ma_layout *ma = ma_config_layout(ma_config);
+    const MA_CONFIG valid_config =
+            ma_config >= MA_CONFIG_MONO && ma_config < MA_CONFIG_CUSTOM ? ma_config : MA_CONFIG_MONO;
+    dwm_mic_array_t *mics = &builtin->mics;
+    mics->encoder_matrix = handle->encoder != NULL ? handle->encoder->matrices[valid_config] : NULL;
+    mics->channel_count = ma->channel_count;
+    mics->radius_m = ma->radius_m;
+    mics->radius_junction_m = DWM_MA_SIZE_JUNCTION_M;
+    for (int i = 0; i < ma->channel_count; i++) {
+        for (int k = 0; k < 3; k++) {
+            builtin->mic_rel_xyz_j[i][k] = (float) ma->mic_rel_xyz_j[i][k];
+        }
+        builtin->channels[i] = i;
+    }
+    mics->mic_rel_xyz_j = (const float(*)[3]) builtin->mic_rel_xyz_j;
+    mics->channels = builtin->channels;
+    mics->int_percents = builtin->int_percents;
+    mics->int_indices = builtin->int_indices;
+    mics->tap_planes = builtin->tap_planes;
+    mics->tap_mics = builtin->tap_mics;
+    mics->tap_halves = builtin->tap_halves;
+    mics->values = builtin->values;
+    return mics;
+}
+
+dwm_encoder_t *create_encoder(const dwm_ma_t *handle, const int order, const dwm_mic_array_t *custom_layout) {
+    // Allocate the encoder as a single memory block, with room for the microphones of any layout
+    const int channel_count = (order + 1) * (order + 1);
+    const int custom_count = custom_layout != NULL ? custom_layout->channel_count : 0;
+    const int mic_capacity = maxi(DWM_MA_MAX_OUTPUT_COUNT, custom_count);
+    int matrix_size = channel_count * custom_count;
+    for (int c = MA_CONFIG_MONO; c < MA_CONFIG_CUSTOM; c++) {
+        matrix_size += channel_count * ma_config_layout((MA_CONFIG) c)->channel_count;
+    }
+    const size_t offsets[] = {align_size(sizeof(dwm_encoder_t)), align_size(sizeof(float) * matrix_size),
+                              align_size(sizeof(float *) * mic_capacity),
+                              align_size(sizeof(float) * mic_capacity * handle->buffer_size)};
+    char *memory = malloc(offsets[0] + offsets[1] + offsets[2] + offsets[3]);
+    float(*custom_azi_elev)[2] = malloc(sizeof(float[2]) * maxi(custom_count, 1));
+    if (memory == NULL || custom_azi_elev == NULL) {
+        free(memory);
+        free(custom_azi_elev);
+        return NULL;
+    }
+    dwm_encoder_t *encoder = (dwm_encoder_t *) memory;
+    float *matrices = (float *) (memory + offsets[0]);
+    encoder->mic_buffers = (float **) (memory + offsets[0] + offsets[1]);
+    float *mic_samples = (float *) (memory + offsets[0] + offsets[1] + offsets[2]);
+    encoder->order = order;
+    encoder->channel_count = channel_count;
+    for (int i = 0; i < mic_capacity; i++) {
+        encoder->mic_buffers[i] = mic_samples + i * handle->buffer_size;
+    }
+
+    // Built-in layouts store their microphones' directions, while the custom layout's follow from its coordinates,
+    // with the same convention: azimuth 0 towards +Y and pi / 2 towards -X, elevation pi / 2 towards +Z
+    for (int c = MA_CONFIG_MONO; c < MA_CONFIG_CUSTOM; c++) {
+        const ma_layout *ma = ma_config_layout((MA_CONFIG) c);
+        ma_ambisonics_encoder(order, ma->mic_azi_elev, ma->channel_count, matrices);
+        encoder->matrices[c] = matrices;
+        matrices += channel_count * ma->channel_count;
+    }
+    encoder->matrices[MA_CONFIG_CUSTOM] = NULL;
+    if (custom_layout != NULL) {
+        for (int i = 0; i < custom_count; i++) {
+            const float *xyz_j = custom_layout->mic_rel_xyz_j[i];
+            custom_azi_elev[custom_layout->channels[i]][0] = atan2f(-xyz_j[0], xyz_j[1]);
+            custom_azi_elev[custom_layout->channels[i]][1] = atan2f(xyz_j[2], hypotf(xyz_j[0], xyz_j[1]));
+        }
+        if (ma_ambisonics_encoder(order, (const float(*)[2]) custom_azi_elev, custom_count, matrices) < 0) {
+            free(memory);
+            free(custom_azi_elev);
+            return NULL;
+        }
+        encoder->matrices[MA_CONFIG_CUSTOM] = matrices;
+    }
+    free(custom_azi_elev);
+    return encoder;
+}
+
+int write_outputs(const dwm_ma_t *handle, const dwm_mic_array_t *mics, float *const *ma_buffers) {
+    // Outputs at the mesh's rate go to the call's buffers, unless they are resampled afterwards
+    float *const *out_buffers = handle->host != NULL ? handle->host->out_buffers : ma_buffers;
+    int out_count = mics->channel_count;
+    if (handle->encoder != NULL) {
+        handle->encode_kernel(out_buffers, (const float *const *) handle->encoder->mic_buffers, mics->encoder_matrix,
+                              handle->encoder->channel_count, mics->channel_count, handle->frame_count);
+        out_count = handle->encoder->channel_count;
+    }
+    if (handle->host != NULL) {
+        dwm_host_t *host = handle->host;
+        for (int c = 0; c < out_count; c++) {
+            dwm_ma_resampler_process(host->out_resampler, c, out_buffers[c], handle->frame_count, ma_buffers[c],
+                                     host->frame_count);
+        }
+        dwm_ma_resampler_advance(host->out_resampler, handle->frame_count, host->frame_count);
+    }
+    return out_count;
+}
+
+dwm_host_t *create_host(const dwm_ma_t *handle, const int sample_rate, const dwm_mic_array_t *custom_layout) {
+    // A host buffer spans at most a mesh buffer, the resamplers carrying their phase from one call to the next
+    if (sample_rate <= 0 || (long long) handle->buffer_size * sample_rate < handle->sample_rate) {
+        return NULL;
+    }
+
+    // Allocate the buffers as a single memory block, with room for the outputs of any layout or Ambisonics order
+    const int out_capacity = maxi(maxi(DWM_MA_MAX_OUTPUT_COUNT, (MA_AMBISONICS_MAX_ORDER + 1) *
+                                                                    (MA_AMBISONICS_MAX_ORDER + 1)),
+                                  custom_layout != NULL ? custom_layout->channel_count : 0);
+    const size_t offsets[] = {align_size(sizeof(dwm_host_t)), align_size(sizeof(float *) * DWM_MA_MAX_INPUT_COUNT),
+                              align_size(sizeof(float *) * out_capacity),
+                              align_size(sizeof(float) * DWM_MA_MAX_INPUT_COUNT * handle->buffer_size),
+                              align_size(sizeof(float) * out_capacity * handle->buffer_size)};
+    char *memory = malloc(offsets[0] + offsets[1] + offsets[2] + offsets[3] + offsets[4]);
+    if (memory == NULL) {
+        return NULL;
+    }
+    dwm_host_t *host = (dwm_host_t *) memory;
+    host->in_buffers = (float **) (memory + offsets[0]);
+    host->out_buffers = (float **) (memory + offsets[0] + offsets[1]);
+    float *in_samples = (float *) (memory + offsets[0] + offsets[1] + offsets[2]);
+    float *out_samples = (float *) (memory + offsets[0] + offsets[1] + offsets[2] + offsets[3]);
+    for (int i = 0; i < DWM_MA_MAX_INPUT_COUNT; i++) {
+        host->in_buffers[i] = in_samples + i * handle->buffer_size;
+    }
+    for (int i = 0; i < out_capacity; i++) {
+        host->out_buffers[i] = out_samples + i * handle->buffer_size;
+    }
+    host->sample_rate = sample_rate;
+    host->buffer_size = (int) ((long long) handle->buffer_size * sample_rate / handle->sample_rate);
+    host->out_capacity = out_capacity;
+    host->in_resampler = NULL;
+    host->out_resampler = NULL;
+
+    // Each input and output channel is filtered independently, in blocks of up to a buffer
+    if (dwm_ma_resampler_create(&host->in_resampler, sample_rate, handle->sample_rate, DWM_MA_MAX_INPUT_COUNT,
+                                host->buffer_size) != 0 ||
+        dwm_ma_resampler_create(&host->out_resampler, handle->sample_rate, sample_rate, out_capacity,
+                                handle->buffer_size) != 0) {
+        destroy_host(host);
+        return NULL;
+    }
+    return host;
+}
+
+void destroy_host(dwm_host_t *host) {
+    if (host == NULL) {
+        return;
+    }
+    if (host->in_resampler != NULL) {
+        dwm_ma_resampler_destroy(&host->in_resampler);
+    }
+    if (host->out_resampler != NULL) {
+        dwm_ma_resampler_destroy(&host->out_resampler);
+    }
+    free(host);
+}
+
+void destroy_convolution(dwm_ma_t *handle) {
+    if (handle->convolution != NULL) {
+        dwm_ma_convolver_destroy(&handle->convolution->convolver);
+        free(handle->convolution);
+        handle->convolution = NULL;
+    }
+}
+
+int is_captured_scene(const dwm_ma_t *handle, const float *const *in_positions_start_m,
+                      const float *const *in_positions_end_m, const int in_count, const MA_CONFIG ma_config,
+                      const float ma_scale, const float *ma_position_start_m, const float *ma_position_end_m) {
+    const dwm_convolution_t *convolution = handle->convolution;
+    if (in_count != convolution->in_count || ma_config != convolution->ma_config ||
+        fclampf(ma_scale, 1.0f, 10.0f) != convolution->ma_scale ||
+        memcmp(handle->b_params, convolution->b_params, sizeof(handle->b_params)) != 0 ||
+        memcmp(ma_position_start_m, convolution->ma_position_m, sizeof(float[3])) != 0 ||
+        memcmp(ma_position_end_m, convolution->ma_position_m, sizeof(float[3])) != 0) {
+        return 0;
+    }
+    for (int i = 0; i < in_count; i++) {
+        if (memcmp(in_positions_start_m[i], convolution->in_positions_m[i], sizeof(float[3])) != 0 ||
+            memcmp(in_positions_end_m[i], convolution->in_positions_m[i], sizeof(float[3])) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int is_setup_cached(const dwm_ma_t *handle, const float *const *in_positions_m, const int in_count,
+                    const MA_CONFIG ma_config, const float ma_scale, const float *ma_position_m) {
+    const dwm_setup_t *setup = &handle->setup;
+    if (!setup->valid || in_count != setup->in_count || ma_config != setup->ma_config || ma_scale != setup->ma_scale ||
+        memcmp(ma_position_m, setup->ma_position_m, sizeof(float[3])) != 0) {
+        return 0;
+    }
+    for (int i = 0; i < in_count; i++) {
+        if (memcmp(in_positions_m[i], setup->in_positions_m[i], sizeof(float[3])) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void clear_state(dwm_ma_t *handle) {
+    // Assumes IEEE 754 float representation where 0-ed out bits correspond to 0.0f (as in every storage format)
+    const int x = handle->size_x_j, y = handle->size_y_j, z = handle->size_z_j;
+    memset(handle->p, 0, storage_size(handle->storage) * x * y * z);
+    memset(handle->p_aux, 0, storage_size(handle->storage) * x * y * z);
+    for (int f = 0; f < 6; f++) {
+        memset(handle->b[f].t1, 0, sizeof(float) * 3 * face_size_j(handle, f));
+    }
+    if (handle->geometry != NULL) {
+        const int link_count = handle->geometry->link_offsets[z * handle->geometry->group_count];
+        memset(handle->geometry->links.t1, 0, sizeof(float) * 3 * link_count);
+    }
+    clear_active_region(handle);
+    handle->snapshot_links = NULL;
+    if (handle->host != NULL) {
+        dwm_ma_resampler_reset(handle->host->in_resampler);
+        dwm_ma_resampler_reset(handle->host->out_resampler);
+    }
+}
+
+void transfer_face(dwm_ma_t *handle, const dwm_ma_t *src, const int face) {
+    // Faces are indexed by their junctions' coordinates on the two axes parallel to them, the second one being major
+    static const int axes[6][2] = {{0, 1}, {0, 2}, {1, 2}, {1, 2}, {0, 2}, {0, 1}};
+    const int size_j[3] = {handle->size_x_j, handle->size_y_j, handle->size_z_j};
+    const int src_size_j[3] = {src->size_x_j, src->size_y_j, src->size_z_j};
+    const int u_size = size_j[axes[face][0]], v_size = size_j[axes[face][1]];
+    const int src_u_size = src_size_j[axes[face][0]], src_v_size = src_size_j[axes[face][1]];
+    const float ratio = handle->junction_2_metric * src->metric_2_junction;
+    const dwm_boundary_t *src_b = &src->b[face];
+    const dwm_boundary_t *b = &handle->b[face];
+    for (int v = 0; v < v_size; v++) {
+        const float src_v = fclampf(((float) v + 0.5f) * ratio - 0.5f, 0.0f, src_v_size - 1.0f);
+        const int v_0 = (int) floorf(src_v), v_1 = (int) ceilf(src_v);
+        for (int u = 0; u < u_size; u++) {
+            const float src_u = fclampf(((float) u + 0.5f) * ratio - 0.5f, 0.0f, src_u_size - 1.0f);
+            const int u_0 = (int) floorf(src_u), u_1 = (int) ceilf(src_u);
+            const int i = v * u_size + u;
+            const int i_00 = v_0 * src_u_size + u_0, i_10 = v_0 * src_u_size + u_1;
+            const int i_01 = v_1 * src_u_size + u_0, i_11 = v_1 * src_u_size + u_1;
+            const float u_percent = src_u - (float) u_0, v_percent = src_v - (float) v_0;
+#define B(ARRAY) \
+    flerpf(flerpf(src_b->ARRAY[i_00], src_b->ARRAY[i_10], u_percent), \
+           flerpf(src_b->ARRAY[i_01], src_b->ARRAY[i_11], u_percent), v_percent)
+            b->t1[i] = B(t1);
+            b->t2[i] = B(t2);
+            b->t3[i] = B(t3);
+            b->out[i] = B(out);
+#undef B
+        }
+    }
+}
+
+void compute_ma_interpolation_parameters(const dwm_ma_t *handle, dwm_mic_array_t *mics, const float ma_scale,
+                                         const float *ma_position_m) {
+    // Restrict the array's center such that the entire radius is inside the mesh bounds, rescaling the array's radius
+    // to the instance's junction size
+    const float ma_radius_m = mics->radius_m * (handle->junction_2_metric / mics->radius_junction_m) * ma_scale;
+    float ma_position_m_restricted[3];
+    for (int i = 0; i < 3; i++) {
+        ma_position_m_restricted[i] = fclampf(ma_position_m[i], ma_radius_m, handle->size_m[i] - ma_radius_m);
+    }
+    for (int i = 0; i < mics->channel_count; i++) {
+        compute_interpolation_parameters_ma(handle, mics->mic_rel_xyz_j[i], ma_position_m_restricted, ma_scale,
+                                            mics->int_percents[i], mics->int_indices[i]);
+    }
+}
+
+void lerp_position(const float *start, const float *end, const float t, float position[3]) {
+    for (int i = 0; i < 3; i++) {
+        position[i] = flerpf(start[i], end[i], t);
+    }
+}
+
+float read_plane_interp_params(const dwm_ma_t *handle, const void *p, const float interp_percents[3],
+                               const int interp_indices[2][2][2], const int z_i) {
+#define V(X, Y) load_junction(p, interp_indices[X][Y][z_i], handle->storage)
+    return flerpf(flerpf(V(0, 0), V(1, 0), interp_percents[0]), flerpf(V(0, 1), V(1, 1), interp_percents[0]),
+                  interp_percents[1]);
+#undef V
+}
+
+void build_source_taps(const dwm_ma_t *handle, const int in_count, const float input_int_percents[][3],
+                       const int input_int_indices[][2][2][2], dwm_taps_t *taps) {
+    const int stride_z = handle->size_x_j * handle->size_y_j;
+    taps->source_count = 0;
+    for (int i = 0; i < in_count; i++) {
+        float weights[2][2][2], air_weight = 0.0f;
+        int air[2][2][2], solid_count = 0;
+        for (int z_i = 0; z_i < 2; z_i++) {
+            for (int y_i = 0; y_i < 2; y_i++) {
+                for (int x_i = 0; x_i < 2; x_i++) {
+                    const int junction = input_int_indices[i][x_i][y_i][z_i];
+                    air[x_i][y_i][z_i] =
+                            handle->geometry == NULL || is_air_junction(handle->geometry, junction, handle->size_x_j);
+                    weights[x_i][y_i][z_i] = (x_i ? input_int_percents[i][0] : 1 - input_int_percents[i][0]) *
+                                             (y_i ? input_int_percents[i][1] : 1 - input_int_percents[i][1]) *
+                                             (z_i ? input_int_percents[i][2] : 1 - input_int_percents[i][2]);
+                    air_weight += air[x_i][y_i][z_i] ? weights[x_i][y_i][z_i] : 0.0f;
+                    solid_count += !air[x_i][y_i][z_i];
+                }
+            }
+        }
+
+        // Solid junctions are never updated, their share goes to the air junctions (none is written if all are solid)
+        if (air_weight == 0.0f) {
+            continue;
+        }
+        for (int z_i = 0; z_i < 2; z_i++) {
+            for (int y_i = 0; y_i < 2; y_i++) {
+                for (int x_i = 0; x_i < 2; x_i++) {
+                    if (!air[x_i][y_i][z_i]) {
+                        continue;
+                    }
+
+                    // Insert after every tap of the same Z-plane
+                    const int junction = input_int_indices[i][x_i][y_i][z_i], plane = junction / stride_z;
+                    int k = taps->source_count++;
+                    for (; k > 0 && taps->source_planes[k - 1] > plane; k--) {
+                        taps->source_planes[k] = taps->source_planes[k - 1];
+                        taps->source_junctions[k] = taps->source_junctions[k - 1];
+                        taps->source_inputs[k] = taps->source_inputs[k - 1];
+                        taps->source_weights[k] = taps->source_weights[k - 1];
+                    }
+                    taps->source_planes[k] = plane;
+                    taps->source_junctions[k] = junction;
+                    taps->source_inputs[k] = i;
+                    taps->source_weights[k] =
+                            solid_count > 0 ? weights[x_i][y_i][z_i] / air_weight : weights[x_i][y_i][z_i];
+                }
+            }
+        }
+    }
+}
+
+void build_mic_taps(const dwm_ma_t *handle, dwm_taps_t *taps) {
+    const int stride_z = handle->size_x_j * handle->size_y_j;
+    dwm_mic_array_t *mics = taps->mics;
+    taps->mic_count = 0;
+    for (int i = 0; i < mics->channel_count; i++) {
+        for (int z_i = 0; z_i < 2; z_i++) {
+            // Insert after every tap of the same Z-plane
+            const int plane = mics->int_indices[i][0][0][z_i] / stride_z;
+            int k = taps->mic_count++;
+            for (; k > 0 && mics->tap_planes[k - 1] > plane; k--) {
+                mics->tap_planes[k] = mics->tap_planes[k - 1];
+                mics->tap_mics[k] = mics->tap_mics[k - 1];
+                mics->tap_halves[k] = mics->tap_halves[k - 1];
+            }
+            mics->tap_planes[k] = plane;
+            mics->tap_mics[k] = i;
+            mics->tap_halves[k] = z_i;
+        }
+    }
+}
+
+int first_tap(const int *planes, const int count, const int z_j) {
+    int low = 0, high = count;
+    while (low < high) {
+        const int mid = (low + high) / 2;
+        if (planes[mid] < z_j) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+int write_source_taps(const dwm_ma_t *handle, const dwm_taps_t *taps, void *p, const int n, int s, const int z_end) {
+    // Same weights as an unfused write, each input's junctions being lerped towards its sample
+    for (; s < taps->source_count && taps->source_planes[s] < z_end; s++) {
+        const int i = taps->source_junctions[s];
+        store_junction(p, i,
+                       flerpf(load_junction(p, i, handle->storage), taps->in_buffers[taps->source_inputs[s]][n],
+                              taps->source_weights[s]),
+                       handle->storage);
+    }
+    return s;
+}
+
+int read_mic_taps(const dwm_ma_t *handle, dwm_taps_t *taps, const void *p, int m, const int z_end) {
+    dwm_mic_array_t *mics = taps->mics;
+    for (; m < taps->mic_count && mics->tap_planes[m] < z_end; m++) {
+        const int i = mics->tap_mics[m], z_i = mics->tap_halves[m];
+        mics->values[i][z_i] = read_plane_interp_params(handle, p, mics->int_percents[i], mics->int_indices[i], z_i);
+        if (z_i == 1 && taps->ma_buffers != NULL) {
+            taps->ma_buffers[mics->channels[i]][taps->mic_n] =
+                    flerpf(mics->values[i][0], mics->values[i][1], mics->int_percents[i][2]);
+        }
+    }
+    return m;
+}
+
+void process_buffer_blocked(dwm_ma_t *handle) {
+    // Every Z-plane of step j only depends on the neighbouring planes of step j - 1 and on itself at step j - 2, which
+    // is overwritten in place: sweeping a wavefront along the Z-axis, where plane z of step j is processed right after
+    // plane z + 1 of step j - 1, advances the whole block while its planes are still cached.
+    // Sources of step j + 1 are written to a plane as soon as step j produced it, after the microphones read it, while
+    // each microphone is read in two halves, one for each of the Z-planes it samples
+    dwm_taps_t *taps = handle->taps;
+    const int size_z_j = handle->size_z_j;
+    for (int n_begin = 0; n_begin < handle->frame_count; n_begin += handle->temporal_block_size) {
+        const int steps = mini(handle->temporal_block_size, handle->frame_count - n_begin);
+        void *const p_even = handle->p, *const p_odd = handle->p_aux;
+
+        // The block's first sources are written ahead of the wavefront
+        write_source_taps(handle, taps, handle->p, n_begin, 0, size_z_j);
+        stats_lap(handle, DWM_MA_PHASE_INJECTION);
+
+        for (int k = 0; k < size_z_j + steps - 1; k++) {
+            for (int j = maxi(0, k - size_z_j + 1); j <= mini(k, steps - 1); j++) {
+                const int z = k - j;
+                handle->p = j % 2 == 0 ? p_even : p_odd;
+                handle->p_aux = j % 2 == 0 ? p_odd : p_even;
+                dilate_active_region(handle, j + 1, handle->update_begin, handle->update_end);
+                handle->b_step = n_begin + j;
+                handle->process_slab(handle, z, z + 1);
+                stats_lap(handle, DWM_MA_PHASE_ITERATION);
+
+                taps->mic_n = n_begin + j;
+                read_mic_taps(handle, taps, handle->p_aux, first_tap(taps->mics->tap_planes, taps->mic_count, z),
+                              z + 1);
+                stats_lap(handle, DWM_MA_PHASE_CAPTURE);
+                if (j + 1 < steps) {
+                    write_source_taps(handle, taps, handle->p_aux, n_begin + j + 1,
+                                      first_tap(taps->source_planes, taps->source_count, z), z + 1);
+                    stats_lap(handle, DWM_MA_PHASE_INJECTION);
+                }
+            }
+        }
+
+        // Leave the buffers and the active region as a step by step processing would
+        void *aux = handle->p;
+        handle->p = handle->p_aux;
+        handle->p_aux = aux;
+        dilate_active_region(handle, steps, handle->active_begin, handle->active_end);
+    }
+}
+
+void process_iteration(dwm_ma_t *handle) {
+    dwm_taps_t *taps = handle->taps;
+    if (handle->pool == NULL || handle->update_begin[0] >= handle->update_end[0]) {
+        process_slab_taps(handle, 0, handle->size_z_j); // Single thread, or whole mesh silent
+        return;
+    }
+
+    // The two halves of a microphone may be read by different threads, thus they are only combined once all are done.
+    // The phases of the threads are not timed, the whole step being accounted as an iteration
+    float *const *ma_buffers = taps->ma_buffers;
+    const int stats_timing = handle->stats_timing;
+    taps->ma_buffers = NULL;
+    handle->stats_timing = 0;
+    dwm_ma_pool_run(handle->pool, process_taps_task, handle);
+    handle->stats_timing = stats_timing;
+    stats_lap(handle, DWM_MA_PHASE_ITERATION);
+    taps->ma_buffers = ma_buffers;
+    const dwm_mic_array_t *mics = taps->mics;
+    for (int i = 0; i < mics->channel_count; i++) {
+        ma_buffers[mics->channels[i]][taps->mic_n] =
+                flerpf(mics->values[i][0], mics->values[i][1], mics->int_percents[i][2]);
+    }
+    stats_lap(handle, DWM_MA_PHASE_CAPTURE);
+}
+
+void process_slab_taps(dwm_ma_t *handle, const int z_begin, const int z_end) {
+    dwm_taps_t *taps = handle->taps;
+    const int silent = handle->update_begin[0] >= handle->update_end[0];
+    int s = taps->source_n >= 0 ? first_tap(taps->source_planes, taps->source_count, z_begin) : taps->source_count;
+    int m = first_tap(taps->mics->tap_planes, taps->mic_count, z_begin);
+    for (int z = z_begin; z < z_end;) {
+        // Sweep up to the next Z-plane holding taps, and then read and write its junctions while they are still cached
+        int z_next = z_end;
+        if (s < taps->source_count) {
+            z_next = mini(z_next, taps->source_planes[s] + 1);
+        }
+        if (m < taps->mic_count) {
+            z_next = mini(z_next, taps->mics->tap_planes[m] + 1);
+        }
+        if (!silent) {
+            handle->process_slab(handle, z, z_next);
+            stats_lap(handle, DWM_MA_PHASE_ITERATION);
+        }
+        m = read_mic_taps(handle, taps, handle->p_aux, m, z_next);
+        stats_lap(handle, DWM_MA_PHASE_CAPTURE);
+        s = write_source_taps(handle, taps, handle->p_aux, taps->source_n, s, z_next);
+        stats_lap(handle, DWM_MA_PHASE_INJECTION);
+        z = z_next;
+    }
+}
+
+void process_slab_sized(dwm_ma_t *handle, const int z_begin, const int z_end, const int size_x_j, const int size_y_j,
+                        const int size_z_j, const DWM_MA_STORAGE storage) {
+    // Restrict the slab to the update region, out of which junctions and boundary filters stay silent
+    const int x_begin = handle->update_begin[0], x_end = handle->update_end[0];
+    const int y_begin = handle->update_begin[1], y_end = handle->update_end[1];
+    const int z_first = maxi(z_begin, handle->update_begin[2]), z_last = mini(z_end, handle->update_end[2]);
+    if (z_first >= z_last) {
+        return;
+    }
+    stats_lap(handle, DWM_MA_PHASE_ITERATION);
+    process_boundaries(handle, z_first, z_last, size_x_j, size_y_j, size_z_j, storage);
+    stats_lap(handle, DWM_MA_PHASE_BOUNDARIES);
+
+    // Rows lying on a Y or Z face are updated junction by junction, while every other X row only has its first and last
+    // junctions peeled off: the row interior has no boundaries and is handed to the SIMD row kernel, and the peeled
+    // junctions read their X face's filtered value without branching
+    const int stride_z = size_x_j * size_y_j;
+    const int row_begin = maxi(x_begin, 1), row_end = mini(x_end, size_x_j - 1);
+    const void *p = handle->p;
+    void *p_aux = handle->p_aux;
+#define P(I) load_junction(p, I, storage)
+    for (int z = z_first; z < z_last; z++) {
+        for (int y = y_begin; y < y_end; y++) {
+            if (z == 0 || z == size_z_j - 1 || y == 0 || y == size_y_j - 1) {
+                for (int x = x_begin; x < x_end; x++) {
+                    process_junction(handle, x, y, z, size_x_j, size_y_j, size_z_j, storage);
+                }
+                continue;
+            }
+            const int i = (z * size_y_j + y) * size_x_j, j = i + size_x_j - 1;
+            if (x_begin == 0) {
+                const float xn = handle->b[2].out[z * size_y_j + y];
+                const float sum_i =
+                        P(i - stride_z) + P(i - size_x_j) + xn + P(i + 1) + P(i + size_x_j) + P(i + stride_z);
+                store_junction(p_aux, i, sum_i / 3.0f - load_junction(p_aux, i, storage), storage);
+            }
+            if (row_begin < row_end && storage == DWM_MA_STORAGE_FLOAT32) {
+                handle->row_kernel((float *) p_aux + i + row_begin, (const float *) p + i + row_begin,
+                                   row_end - row_begin, 1, size_x_j, stride_z);
+            } else if (row_begin < row_end) {
+                handle->row_kernel_16((uint16_t *) p_aux + i + row_begin, (const uint16_t *) p + i + row_begin,
+                                      row_end - row_begin, 1, size_x_j, stride_z);
+            }
+            if (x_end == size_x_j) {
+                const float xp = handle->b[3].out[z * size_y_j + y];
+                const float sum_j =
+                        P(j - stride_z) + P(j - size_x_j) + P(j - 1) + xp + P(j + size_x_j) + P(j + stride_z);
+                store_junction(p_aux, j, sum_j / 3.0f - load_junction(p_aux, j, storage), storage);
+            }
+        }
+    }
+#undef P
+}
+
+void process_boundaries(dwm_ma_t *handle, const int z_begin, const int z_end, const int size_x_j, const int size_y_j,
+                        const int size_z_j, const DWM_MA_STORAGE storage) {
+    // Gather the input samples of the slab's face junctions into the filters' outputs, Z faces only belong to the slabs
+    // holding the first and last Z-planes. Faces out of the update region are skipped, and the others are restricted to
+    // the update region's rows (filtering silent junctions with silent states keeps them silent)
+    const int stride_z = size_x_j * size_y_j;
+    const int y_begin = handle->update_begin[1], y_end = handle->update_end[1];
+    const int active[6] = {z_begin == 0,
+                           y_begin == 0,
+                           handle->update_begin[0] == 0,
+                           handle->update_end[0] == size_x_j,
+                           y_end == size_y_j,
+                           z_end == size_z_j};
+    const void *p = handle->p;
+    if (active[0]) {
+        load_junctions(&handle->b[0].out[y_begin * size_x_j], p, y_begin * size_x_j, (y_end - y_begin) * size_x_j, 1,
+                       storage);
+    }
+    if (active[5]) {
+        load_junctions(&handle->b[5].out[y_begin * size_x_j], p, (size_z_j - 1) * stride_z + y_begin * size_x_j,
+                       (y_end - y_begin) * size_x_j, 1, storage);
+    }
+    for (int z = z_begin; z < z_end; z++) {
+        if (active[1]) {
+            load_junctions(&handle->b[1].out[z * size_x_j], p, z * stride_z, size_x_j, 1, storage);
+        }
+        if (active[4]) {
+            load_junctions(&handle->b[4].out[z * size_x_j], p, z * stride_z + (size_y_j - 1) * size_x_j, size_x_j, 1,
+                           storage);
+        }
+        if (active[2]) {
+            load_junctions(&handle->b[2].out[z * size_y_j], p, z * stride_z, size_y_j, size_x_j, storage);
+        }
+        if (active[3]) {
+            load_junctions(&handle->b[3].out[z * size_y_j], p, z * stride_z + size_x_j - 1, size_y_j, size_x_j,
+                           storage);
+        }
+    }
+
+    // Filter each face's gathered samples in a single pass
+    for (int f = 0; f < 6; f++) {
+        int begin, count;
+        if (!active[f]) {
+            continue;
+        }
+        if (f == 0 || f == 5) {
+            begin = y_begin * size_x_j;
+            count = (y_end - y_begin) * size_x_j;
+        } else if (f == 1 || f == 4) {
+            begin = z_begin * size_x_j;
+            count = (z_end - z_begin) * size_x_j;
+        } else {
+            begin = z_begin * size_y_j;
+            count = (z_end - z_begin) * size_y_j;
+        }
+        dwm_boundary_t *b = &handle->b[f];
+        const dwm_boundary_map_t *map = handle->b_maps[f];
+        if (map != NULL && (map->active || map->ramp)) {
+            if (map->ramp) {
+                ramp_boundary_map(handle, map, begin, count);
+            }
+            handle->boundary_map_kernel(&b->out[begin], &b->t1[begin], &b->t2[begin], &b->t3[begin], count,
+                                        (map->ramp ? map->ramp_r1 : map->r1) + begin,
+                                        (map->ramp ? map->ramp_r2 : map->r2) + begin);
+        } else {
+            float r[2];
+            handle->boundary_kernel(&b->out[begin], &b->t1[begin], &b->t2[begin], &b->t3[begin], count,
+                                    uniform_boundary_params(handle, f, r));
+        }
+    }
+}
+
+void process_boundary_dampings(dwm_ma_t *handle, const int z_begin, const int z_end, const int size_x_j,
+                               const int size_y_j, const int size_z_j) {
+    // Faces out of the update region are skipped, and the others are restricted to the update region's rows, as
+    // process_boundaries does
+    const int y_begin = handle->update_begin[1], y_end = handle->update_end[1];
+    const int active[6] = {z_begin == 0,
+                           y_begin == 0,
+                           handle->update_begin[0] == 0,
+                           handle->update_end[0] == size_x_j,
+                           y_end == size_y_j,
+                           z_end == size_z_j};
+    for (int f = 0; f < 6; f++) {
+        int begin, count;
+        if (!active[f]) {
+            continue;
+        }
+        if (f == 0 || f == 5) {
+            begin = y_begin * size_x_j;
+            count = (y_end - y_begin) * size_x_j;
+        } else if (f == 1 || f == 4) {
+            begin = z_begin * size_x_j;
+            count = (z_end - z_begin) * size_x_j;
+        } else {
+            begin = z_begin * size_y_j;
+            count = (z_end - z_begin) * size_y_j;
+        }
+        const dwm_boundary_map_t *map = handle->b_maps[f];
+        if (map != NULL && (map->active || map->ramp)) {
+            if (map->ramp) {
+                ramp_boundary_map(handle, map, begin, count);
+            }
+            compute_boundary_dampings(&handle->b[f].out[begin], count, (map->ramp ? map->ramp_r1 : map->r1) + begin,
+                                      (map->ramp ? map->ramp_r2 : map->r2) + begin, 1);
+        } else {
+            float r[2];
+            const float *params = uniform_boundary_params(handle, f, r);
+            compute_boundary_dampings(&handle->b[f].out[begin], count, &params[0], &params[1], 0);
+        }
+    }
+}
+
+void compute_boundary_dampings(float *dampings, const int count, const float *r1, const float *r2, const int stride) {
+    for (int k = 0; k < count; k++) {
+        const float reflectance = fclampf(2.0f * r1[k * stride] + r2[k * stride], 0.0f, 1.0f);
+        dampings[k] = (1.0f - reflectance) / (1.0f + reflectance);
+    }
+}
+
+void process_slab_generic(dwm_ma_t *handle, const int z_begin, const int z_end) {
+    process_slab_sized(handle, z_begin, z_end, handle->size_x_j, handle->size_y_j, handle->size_z_j,
+                       DWM_MA_STORAGE_FLOAT32);
+}
+
+void process_slab_generic_f16(dwm_ma_t *handle, const int z_begin, const int z_end) {
+    process_slab_sized(handle, z_begin, z_end, handle->size_x_j, handle->size_y_j, handle->size_z_j,
+                       DWM_MA_STORAGE_FLOAT16);
+}
+
+void process_slab_generic_bf16(dwm_ma_t *handle, const int z_begin, const int z_end) {
+    process_slab_sized(handle, z_begin, z_end, handle->size_x_j, handle->size_y_j, handle->size_z_j,
+                       DWM_MA_STORAGE_BFLOAT16);
+}
+
+void process_slab_interpolated_sized(dwm_ma_t *handle, const int z_begin, const int z_end, const int size_x_j,
+                                     const int size_y_j, const int size_z_j) {
+    // Restrict the slab to the update region, as process_slab_sized does. The stencil reaches one junction along each
+    // axis as the rectilinear one does, only diagonally as well, thus the update region stays the same
+    const int x_begin = handle->update_begin[0], x_end = handle->update_end[0];
+    const int y_begin = handle->update_begin[1], y_end = handle->update_end[1];
+    const int z_first = maxi(z_begin, handle->update_begin[2]), z_last = mini(z_end, handle->update_end[2]);
+    if (z_first >= z_last) {
+        return;
+    }
+    stats_lap(handle, DWM_MA_PHASE_ITERATION);
+    process_boundary_dampings(handle, z_first, z_last, size_x_j, size_y_j, size_z_j);
+    stats_lap(handle, DWM_MA_PHASE_BOUNDARIES);
+
+    // Rows lying on a Y or Z face are updated through process_face_row_interpolated, and the others by the row kernel
+    // directly, but for their ends lying on an X face, which are updated as rows along the Y-axis
+    const int stride_z = size_x_j * size_y_j;
+    const int row_begin = maxi(x_begin, 1), row_end = mini(x_end, size_x_j - 1);
+    const float *p = handle->p;
+    float *p_aux = handle->p_aux;
+    for (int z = z_first; z < z_last; z++) {
+        for (int y = y_begin; y < y_end; y++) {
+            if (z == 0 || z == size_z_j - 1 || y == 0 || y == size_y_j - 1) {
+                process_face_row_interpolated(handle, x_begin, y, z, 0, x_end - x_begin, size_x_j, size_y_j, size_z_j);
+                continue;
+            }
+            const int i = (z * size_y_j + y) * size_x_j;
+            if (row_begin < row_end) {
+                handle->row_kernel(p_aux + i + row_begin, p + i + row_begin, row_end - row_begin, 1, size_x_j,
+                                   stride_z);
+            }
+        }
+        const int column_begin = maxi(y_begin, 1), column_end = mini(y_end, size_y_j - 1);
+        if (z == 0 || z == size_z_j - 1 || column_begin >= column_end) {
+            continue;
+        }
+        if (x_begin == 0) {
+            process_face_row_interpolated(handle, 0, column_begin, z, 1, column_end - column_begin, size_x_j, size_y_j,
+                                          size_z_j);
+        }
+        if (x_end == size_x_j) {
+            process_face_row_interpolated(handle, size_x_j - 1, column_begin, z, 1, column_end - column_begin, size_x_j,
+                                          size_y_j, size_z_j);
+        }
+    }
+}
+
+void process_slab_interpolated(dwm_ma_t *handle, const int z_begin, const int z_end) {
+    process_slab_interpolated_sized(handle, z_begin, z_end, handle->size_x_j, handle->size_y_j, handle->size_z_j);
+}
+
+void process_slab_masked_sized(dwm_ma_t *handle, const int z_begin, const int z_end, const int size_x_j,
+                               const int size_y_j, const DWM_MA_STORAGE storage) {
+    // Restrict the slab to the update region, as process_slab_sized does
+    const int x_begin = handle->update_begin[0], x_end = handle->update_end[0];
+    const int y_begin = handle->update_begin[1], y_end = handle->update_end[1];
+    const int z_first = maxi(z_begin, handle->update_begin[2]), z_last = mini(z_end, handle->update_end[2]);
+    if (z_first >= z_last) {
+        return;
+    }
+
+    // Edge junctions are updated one by one, and then runs of plain junctions are handed to the SIMD row kernel (the
+    // other way around, the row kernel's vector stores stall the neighbouring edge junctions' loads)
+    const dwm_geometry_t *geometry = handle->geometry;
+    const int stride_z = size_x_j * size_y_j;
+    const void *p = handle->p;
+    void *p_aux = handle->p_aux;
+    for (int z = z_first; z < z_last; z++) {
+        stats_lap(handle, DWM_MA_PHASE_ITERATION);
+        process_links(handle, z, z + 1, storage);
+        stats_lap(handle, DWM_MA_PHASE_BOUNDARIES);
+        for (int y = y_begin; y < y_end; y++) {
+            const int row = z * size_y_j + y, i = row * size_x_j;
+            const int edge_begin = geometry->edge_offsets[row];
+            process_edge_junctions(&geometry->edges[edge_begin], geometry->edge_offsets[row + 1] - edge_begin,
+                                   geometry->links.out, p, p_aux, i, x_begin, x_end, size_x_j, size_y_j, storage);
+            for (int r = geometry->run_offsets[row]; r < geometry->run_offsets[row + 1]; r++) {
+                const int begin = maxi(geometry->runs[r][0], x_begin), end = mini(geometry->runs[r][1], x_end);
+                if (begin < end && storage == DWM_MA_STORAGE_FLOAT32) {
+                    handle->row_kernel((float *) p_aux + i + begin, (const float *) p + i + begin, end - begin, 1,
+                                       size_x_j, stride_z);
+                } else if (begin < end) {
+                    handle->row_kernel_16((uint16_t *) p_aux + i + begin, (const uint16_t *) p + i + begin,
+                                          end - begin, 1, size_x_j, stride_z);
+                }
+            }
+        }
+    }
+}
+
+void process_slab_masked(dwm_ma_t *handle, const int z_begin, const int z_end) {
+    process_slab_masked_sized(handle, z_begin, z_end, handle->size_x_j, handle->size_y_j, DWM_MA_STORAGE_FLOAT32);
+}
+
+void process_slab_masked_f16(dwm_ma_t *handle, const int z_begin, const int z_end) {
+    process_slab_masked_sized(handle, z_begin, z_end, handle->size_x_j, handle->size_y_j, DWM_MA_STORAGE_FLOAT16);
+}
+
+void process_slab_masked_bf16(dwm_ma_t *handle, const int z_begin, const int z_end) {
+    process_slab_masked_sized(handle, z_begin, z_end, handle->size_x_j, handle->size_y_j, DWM_MA_STORAGE_BFLOAT16);
+}
+
+void select_process_slab(dwm_ma_t *handle) {
+    // Pick a specialized code path for the mesh size (32-bit storage, box-shaped rooms only) if any
+    const int x = handle->size_x_j, y = handle->size_y_j, z = handle->size_z_j;
+#define SPECIALIZED_PROCESS_SLAB(X, Y, Z)                                                                              \
+    if (x == (X) && y == (Y) && z == (Z)) {                                                                            \
+        handle->process_slab = process_slab_##X##_##Y##_##Z;                                                           \
+    } else
+#define SPECIALIZED_PROCESS_SLAB_INTERPOLATED(X, Y, Z)                                                                 \
+    if (x == (X) && y == (Y) && z == (Z)) {                                                                            \
+        handle->process_slab = process_slab_interpolated_##X##_##Y##_##Z;                                              \
+    } else
+    const int interpolated = handle->topology == DWM_MA_TOPOLOGY_INTERPOLATED;
+    if (handle->geometry != NULL) {
+        handle->process_slab = handle->storage == DWM_MA_STORAGE_FLOAT16    ? process_slab_masked_f16
+                               : handle->storage == DWM_MA_STORAGE_BFLOAT16 ? process_slab_masked_bf16
+                                                                            : process_slab_masked;
+    } else if (handle->storage == DWM_MA_STORAGE_FLOAT16) {
+        handle->process_slab = process_slab_generic_f16;
+    } else if (handle->storage == DWM_MA_STORAGE_BFLOAT16) {
+        handle->process_slab = process_slab_generic_bf16;
+    } else if (interpolated)
+        DWM_MA_SPECIALIZED_SIZES(SPECIALIZED_PROCESS_SLAB_INTERPOLATED) {
+            handle->process_slab = process_slab_interpolated;
+        }
+    else
+        DWM_MA_SPECIALIZED_SIZES(SPECIALIZED_PROCESS_SLAB) {
+            handle->process_slab = process_slab_generic;
+        }
+#undef SPECIALIZED_PROCESS_SLAB
+#undef SPECIALIZED_PROCESS_SLAB_INTERPOLATED
+}
+
+void process_taps_task(void *context, const int thread_index, const int thread_count) {
+    dwm_ma_t *handle = context;
+    process_slab_taps(handle, handle->size_z_j * thread_index / thread_count,
+                         handle->size_z_j * (thread_index + 1) / thread_count);
+}
+
+void process_junction(dwm_ma_t *handle, const int x_j, const int y_j, const int z_j, const int size_x_j,
+                      const int size_y_j, const int size_z_j, const DWM_MA_STORAGE storage) {
+    const int stride_z = size_x_j * size_y_j;
+    const int i = (z_j * size_y_j + y_j) * size_x_j + x_j;
+    const void *p = handle->p;
+
+    // Each boundary filter is indexed by the junction's coordinates on the two axes parallel to its face
+#define P(I) load_junction(p, I, storage)
+    const float zn = z_j == 0 ? handle->b[0].out[y_j * size_x_j + x_j] : P(i - stride_z);
+    const float yn = y_j == 0 ? handle->b[1].out[z_j * size_x_j + x_j] : P(i - size_x_j);
+    const float xn = x_j == 0 ? handle->b[2].out[z_j * size_y_j + y_j] : P(i - 1);
+    const float xp = x_j == size_x_j - 1 ? handle->b[3].out[z_j * size_y_j + y_j] : P(i + 1);
+    const float yp = y_j == size_y_j - 1 ? handle->b[4].out[z_j * size_x_j + x_j] : P(i + size_x_j);
+    const float zp = z_j == size_z_j - 1 ? handle->b[5].out[y_j * size_x_j + x_j] : P(i + stride_z);
+#undef P
+    store_junction(handle->p_aux, i,
+                   (zn + yn + xn + xp + yp + zp) / 3.0f - load_junction(handle->p_aux, i, storage), storage);
+}
+
+void process_face_row_interpolated(dwm_ma_t *handle, const int x_j, const int y_j, const int z_j, const int along_y,
+                                   const int count, const int size_x_j, const int size_y_j, const int size_z_j) {
+    // The scratch holds the 3x3 clamped neighbour rows of a chunk, indexed by their Z and cross offsets, each with one
+    // more junction at both ends
+    enum { PITCH = FACE_ROW_CHUNK + 2 };
+    float rows[9 * PITCH], updated[FACE_ROW_CHUNK], previous[FACE_ROW_CHUNK];
+    float dampings[FACE_ROW_CHUNK];
+    const int stride_z = size_x_j * size_y_j;
+    const int i = (z_j * size_y_j + y_j) * size_x_j + x_j;
+    const int stride = along_y ? size_x_j : 1, begin = along_y ? y_j : x_j, size = along_y ? size_y_j : size_x_j;
+    const int cross = along_y ? x_j : y_j, size_cross = along_y ? size_x_j : size_y_j;
+    const int stride_cross = along_y ? 1 : size_x_j;
+    const int offsets_cross[3] = {cross > 0 ? -stride_cross : 0, 0, cross < size_cross - 1 ? stride_cross : 0};
+    const int offsets_z[3] = {z_j > 0 ? -stride_z : 0, 0, z_j < size_z_j - 1 ? stride_z : 0};
+    for (int k_begin = 0; k_begin < count; k_begin += FACE_ROW_CHUNK) {
+        const int n = mini(count - k_begin, FACE_ROW_CHUNK);
+        const int before = begin + k_begin > 0 ? -stride : 0, after = begin + k_begin + n < size ? n * stride : 0;
+        for (int r = 0; r < 9; r++) {
+            const float *p = (const float *) handle->p + i + k_begin * stride + offsets_z[r / 3] + offsets_cross[r % 3];
+            float *row = rows + r * PITCH + 1;
+            for (int k = 0; k < n; k++) {
+                row[k] = p[k * stride];
+            }
+            row[-1] = p[before];
+            row[n] = p[after == 0 ? (n - 1) * stride : after];
+        }
+        const float *p_aux = (const float *) handle->p_aux + i + k_begin * stride;
+        for (int k = 0; k < n; k++) {
+            updated[k] = previous[k] = p_aux[k * stride];
+        }
+        handle->row_kernel(updated, rows + 4 * PITCH + 1, n, 1, PITCH, 3 * PITCH);
+
+        // Damp the undamped update u = S - 2p - p-, the damped one being (S - 2p - (1 - d) p-) / (1 + d)
+        row_dampings(handle, dampings, along_y ? x_j : x_j + k_begin, along_y ? y_j + k_begin : y_j, z_j, along_y, n,
+                     size_x_j, size_y_j, size_z_j);
+        float *p_next = (float *) handle->p_aux + i + k_begin * stride;
+        for (int k = 0; k < n; k++) {
+            p_next[k * stride] = (updated[k] + dampings[k] * previous[k]) / (1.0f + dampings[k]);
+        }
+    }
+}
+
+void row_dampings(const dwm_ma_t *handle, float *dampings, const int x_j, const int y_j, const int z_j,
+                  const int along_y, const int count, const int size_x_j, const int size_y_j, const int size_z_j) {
+    // Faces parallel to the row add a slice of their dampings, and faces across it only damp its ends
+    const dwm_boundary_t *b = handle->b;
+    const float *slices[4] = {z_j == 0 ? &b[0].out[y_j * size_x_j + x_j] : NULL,
+                              z_j == size_z_j - 1 ? &b[5].out[y_j * size_x_j + x_j] : NULL, NULL, NULL};
+    int stride = 1;
+    if (along_y) {
+        stride = size_x_j;
+        slices[2] = x_j == 0 ? &b[2].out[z_j * size_y_j + y_j] : NULL;
+        slices[3] = x_j == size_x_j - 1 ? &b[3].out[z_j * size_y_j + y_j] : NULL;
+    } else {
+        slices[2] = y_j == 0 ? &b[1].out[z_j * size_x_j + x_j] : NULL;
+        slices[3] = y_j == size_y_j - 1 ? &b[4].out[z_j * size_x_j + x_j] : NULL;
+    }
+    for (int k = 0; k < count; k++) {
+        dampings[k] = 0.0f;
+    }
+    for (int s = 0; s < 4; s++) {
+        if (slices[s] == NULL) {
+            continue;
+        }
+        const int slice_stride = s < 2 ? stride : 1;
+        for (int k = 0; k < count; k++) {
+            dampings[k] += slices[s][k * slice_stride];
+        }
+    }
+    if (along_y) {
+        dampings[0] += y_j == 0 ? b[1].out[z_j * size_x_j + x_j] : 0.0f;
+        dampings[count - 1] += y_j + count == size_y_j ? b[4].out[z_j * size_x_j + x_j] : 0.0f;
+    } else {
+        dampings[0] += x_j == 0 ? b[2].out[z_j * size_y_j + y_j] : 0.0f;
+        dampings[count - 1] += x_j + count == size_x_j ? b[3].out[z_j * size_y_j + y_j] : 0.0f;
+    }
+}
+
+void process_links(dwm_ma_t *handle, const int z_begin, const int z_end, const DWM_MA_STORAGE storage) {
+    // Gather the pressures of the slab's edge junctions into the links' outputs, then filter each Z-plane's group in a
+    // single pass
+    const dwm_geometry_t *geometry = handle->geometry;
+    const int group_count = geometry->group_count;
+    const dwm_boundary_t *links = &geometry->links;
+    const int first = geometry->link_offsets[z_begin * group_count];
+    const int last = geometry->link_offsets[z_end * group_count];
+    for (int l = first; l < last; l++) {
+        links->out[l] = load_junction(handle->p, geometry->link_junctions[l], storage);
+    }
+    for (int g = z_begin * group_count; g < z_end * group_count; g++) {
+        const int begin = geometry->link_offsets[g], count = geometry->link_offsets[g + 1] - begin;
+        const int group = g % group_count;
+        if (count > 0) {
+            float r[2];
+            handle->boundary_kernel(&links->out[begin], &links->t1[begin], &links->t2[begin], &links->t3[begin], count,
+                                    group < 6 ? uniform_boundary_params(handle, group, r)
+                                              : geometry->material_params[group - 6]);
+        }
+    }
+}
+
+void process_edge_junctions(const dwm_edge_t *edges, const int edge_count, const float *links_out, const void *p,
+                            void *p_aux, const int row_i, const int x_begin, const int x_end, const int size_x_j,
+                            const int size_y_j, const DWM_MA_STORAGE storage) {
+    const int stride_z = size_x_j * size_y_j;
+    const int strides[6] = {-stride_z, -size_x_j, -1, 1, size_x_j, stride_z};
+    for (int e = 0; e < edge_count; e++) {
+        const dwm_edge_t *edge = &edges[e];
+        if (edge->x < x_begin || edge->x >= x_end) {
+            continue;
+        }
+
+        // Same sum as process_junction, each side reading either its link's filtered value or its air neighbour
+        const int i = row_i + edge->x;
+#define V(D)                                                                                                           \
+    (edge->link[D] >= 0 ? links_out[edge->link[D]] : load_junction(p, i + strides[D], storage))
+        const float v[6] = {V(0), V(1), V(2), V(3), V(4), V(5)};
+#undef V
+        store_junction(p_aux, i, (v[0] + v[1] + v[2] + v[3] + v[4] + v[5]) / 3.0f - load_junction(p_aux, i, storage),
+                       storage);
+    }
+}
+
+int classify_junction(const dwm_ma_t *handle, const uint8_t *cells, const int x_j, const int y_j, const int z_j,
+                      int neighbour_groups[6]) {
+    const int size_x_j = handle->size_x_j, size_y_j = handle->size_y_j, size_z_j = handle->size_z_j;
+    const int stride_z = size_x_j * size_y_j;
+    const int i = (z_j * size_y_j + y_j) * size_x_j + x_j;
+    const int on_face[6] = {z_j == 0,
+                            y_j == 0,
+                            x_j == 0,
+                            x_j == size_x_j - 1,
+                            y_j == size_y_j - 1,
+                            z_j == size_z_j - 1};
+    const int strides[6] = {-stride_z, -size_x_j, -1, 1, size_x_j, stride_z};
+    int edge = 0;
+    for (int d = 0; d < 6; d++) {
+        // Mesh faces come first, solid neighbours' materials follow
+        neighbour_groups[d] = on_face[d] ? d : cells[i + strides[d]] != 0 ? 5 + cells[i + strides[d]] : -1;
+        edge |= neighbour_groups[d] >= 0;
+    }
+    return edge;
+}
+
+int is_air_junction(const dwm_geometry_t *geometry, const int i, const int size_x_j) {
+    // Runs and edge junctions are both sorted along their row
+    const int row = i / size_x_j, x = i % size_x_j;
+    int low = geometry->run_offsets[row], high = geometry->run_offsets[row + 1];
+    while (low < high) {
+        const int mid = (low + high) / 2;
+        if (geometry->runs[mid][1] <= x) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < geometry->run_offsets[row + 1] && geometry->runs[low][0] <= x) {
+        return 1;
+    }
+    low = geometry->edge_offsets[row];
+    high = geometry->edge_offsets[row + 1];
+    while (low < high) {
+        const int mid = (low + high) / 2;
+        if (geometry->edges[mid].x < x) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low < geometry->edge_offsets[row + 1] && geometry->edges[low].x == x;
+}
+
+uint64_t hash_cells(const uint8_t *cells, const int count) {
+    uint64_t hash = 0xcbf29ce484222325u;
+    for (int i = 0; i < count; i++) {
+        hash = (hash ^ cells[i]) * 0x100000001b3u;
+    }
+    return hash;
+}
+
+uint64_t now_ns(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * 1000000000u + (uint64_t) time.tv_nsec;
+}
+
+void stats_lap(dwm_ma_t *handle, const DWM_MA_PHASE phase) {
+    if (!handle->stats_timing) {
+        return;
+    }
+    const uint64_t lap_ns = now_ns();
+    handle->stats.phase_ns[phase] += lap_ns - handle->stats_lap_ns;
+    handle->stats_lap_ns = lap_ns;
+}
+
+uint64_t stats_deadline_ns(const dwm_ma_t *handle) {
+    // A null deadline stands for the duration of the call's samples
+    const int sample_rate = handle->host != NULL ? handle->host->sample_rate : handle->sample_rate;
+    return handle->stats.deadline_ns != 0
+                   ? handle->stats.deadline_ns
+                   : (uint64_t) handle->call_frame_count * 1000000000u / (uint64_t) sample_rate;
+}
+
+void stats_call(dwm_ma_t *handle, const uint64_t begin_ns) {
+    dwm_ma_stats *stats = &handle->stats;
+    const uint64_t call_ns = now_ns() - begin_ns;
+    const uint64_t deadline_ns = stats_deadline_ns(handle);
+    stats->call_count++;
+    stats->overrun_count += call_ns > deadline_ns;
+    stats->total_ns += call_ns;
+    stats->worst_ns = call_ns > stats->worst_ns ? call_ns : stats->worst_ns;
+    stats->last_ns = call_ns;
+
+    // Buckets are eighths of the deadline
+    const uint64_t bucket = deadline_ns != 0 ? call_ns * 8 / deadline_ns : DWM_MA_STATS_HISTOGRAM_SIZE;
+    stats->histogram[bucket < DWM_MA_STATS_HISTOGRAM_SIZE ? bucket : DWM_MA_STATS_HISTOGRAM_SIZE - 1]++;
+}
+
+void convert_boundary_params(const float params[2], const int params_normalized, float r[2]) {
+    if (params_normalized != 0) {
+        // If the parameters are given as normalized admittance & normalized low-pass cutoff, convert to R1 and R2
+        r[0] = (1 - params[1]) * 0.25f * params[0];
+        r[1] = params[0] * (1 - (1 - params[1]) * 0.5f);
+    } else {
+        // Otherwise copy R1, R2
+        r[0] = params[0];
+        r[1] = params[1];
+    }
+}
+
+void begin_boundary_ramp(dwm_ma_t *handle, const int face) {
+    if (handle->b_ramp[face]) {
+        return;
+    }
+    handle->b_ramp[face] = 1;
+    memcpy(handle->b_params_from[face], handle->b_params[face], sizeof(handle->b_params_from[face]));
+    dwm_boundary_map_t *map = handle->b_maps[face];
+    if (map != NULL && map->active) {
+        const int n = face_size_j(handle, face);
+        memcpy(map->from_r1, map->r1, sizeof(float) * n);
+        memcpy(map->from_r2, map->r2, sizeof(float) * n);
+        map->ramp = 1;
+    }
+}
+
+void end_boundary_ramps(dwm_ma_t *handle) {
+    for (int f = 0; f < 6; f++) {
+        handle->b_ramp[f] = 0;
+        if (handle->b_maps[f] != NULL) {
+            handle->b_maps[f]->ramp = 0;
+        }
+    }
+}
+
+const float *uniform_boundary_params(const dwm_ma_t *handle, const int face, float r[2]) {
+    if (!handle->b_ramp[face]) {
+        return handle->b_params[face];
+    }
+
+    // Step n of the call is n + 1 frame_count-ths of the way, the last one reaching the target values
+    const float f = (float) (handle->b_step + 1) / (float) handle->frame_count;
+    r[0] = flerpf(handle->b_params_from[face][0], handle->b_params[face][0], f);
+    r[1] = flerpf(handle->b_params_from[face][1], handle->b_params[face][1], f);
+    return r;
+}
+
+void ramp_boundary_map(const dwm_ma_t *handle, const dwm_boundary_map_t *map, const int begin, const int count) {
+    const float f = (float) (handle->b_step + 1) / (float) handle->frame_count;
+    for (int i = begin; i < begin + count; i++) {
+        map->ramp_r1[i] = flerpf(map->from_r1[i], map->r1[i], f);
+        map->ramp_r2[i] = flerpf(map->from_r2[i], map->r2[i], f);
+    }
+}
+
+dwm_boundary_map_t *create_boundary_map(const int face_size) {
+    // The six arrays follow the map itself
+    const size_t array_size = align_size(sizeof(float) * face_size);
+    char *memory = malloc(align_size(sizeof(dwm_boundary_map_t)) + 6 * array_size);
+    if (memory == NULL) {
+        return NULL;
+    }
+    dwm_boundary_map_t *map = (dwm_boundary_map_t *) memory;
+    float **arrays[6] = {&map->r1, &map->r2, &map->from_r1, &map->from_r2, &map->ramp_r1, &map->ramp_r2};
+    memory += align_size(sizeof(dwm_boundary_map_t));
+    for (int k = 0; k < 6; k++) {
+        *arrays[k] = (float *) (memory + k * array_size);
+    }
+    map->active = 0;
+    map->ramp = 0;
+    return map;
+}
@@ -3,6 +3,14 @@
 
 // User-redefinable definitions
 
+#ifdef DWM_MA_CONFIG_HEADER
+/**
+ * Path of an optional header holding the redefinitions below, for those which cannot be given on the compiler's
+ * command line (e.g. the function-like DWM_MA_SPECIALIZED_SIZES)
+ */
+#include DWM_MA_CONFIG_HEADER
+#endif
+
 #ifndef DWM_MA_SAMPLE_RATE
 /**
  * DSP sampling rate used by the dwm-ma implementation
@@ -52,9 +60,19 @@
 #define DWM_MA_MAX_INPUT_COUNT 16
 #endif
 
+#ifndef DWM_MA_SPECIALIZED_SIZES
+/**
+ * Junction sizes of the meshes processed by fully specialized code paths, as an X-macro list of X(X_J, Y_J, Z_J)
+ * entries where each size is an integer literal; every other size is processed by a generic code path
+ * @remark Include the DWM_MA_SIZE_?_J sizes in the list when redefining them
+ */
+#define DWM_MA_SPECIALIZED_SIZES(X) X(32, 32, 32) X(48, 48, 48) X(64, 64, 64)
+#endif
+
 // Non user-redefinable definitions
 
 #define _DWM_MA_SQRT_3F 1.73205080757f
+#define _DWM_MA_JUNCTION_SPACING(TOPOLOGY) ((TOPOLOGY) == DWM_MA_TOPOLOGY_INTERPOLATED ? 1.0f : _DWM_MA_SQRT_3F)
 #define _DWM_MA_METRIC_2_JUNCTION (DWM_MA_SAMPLE_RATE / (_DWM_MA_SQRT_3F * DWM_MA_SOUND_PROPAGATION_SPEED))
 #define _DWM_MA_JUNCTION_2_METRIC (_DWM_MA_SQRT_3F * DWM_MA_SOUND_PROPAGATION_SPEED / DWM_MA_SAMPLE_RATE)
 
@@ -82,6 +100,211 @@
 
 #include "ma_config.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Storage formats of the junction pressures of a mesh, which are always processed as 32-bit floating point values
+ * @details 16-bit formats halve the memory used by a mesh and the memory traffic of each simulation step, which pays
+ * off for meshes much larger than the last level cache (whose speed is bound by memory bandwidth). Smaller meshes are
+ * processed slower than with 32-bit storage, due to the conversions. \n
+ * Rounding errors accumulate on the recirculating mesh state, their effect was measured on 1 second impulse responses
+ * against DWM_MA_STORAGE_FLOAT32 (default 32x32x32 mesh at 16 kHz, MA_CONFIG_24_POINTS_SQRT_5 output, normalized
+ * admittance between 0.1 and 0.9 on all faces, see tests/dwm_ma_storage_test.c): \n
+ * + DWM_MA_STORAGE_FLOAT16: peak error below -50 dB of the response peak, error energy below -44 dB of the response
+ * energy, \n
+ * + DWM_MA_STORAGE_BFLOAT16: peak error below -20 dB of the response peak, error energy below -10 dB of the response
+ * energy. \n
+ * Interpolated meshes (see DWM_MA_TOPOLOGY_INTERPOLATED) only support DWM_MA_STORAGE_FLOAT32: their scheme runs at its
+ * stability limit, where 16-bit rounding errors excite its near-Nyquist modes until the mesh diverges
+ * @remark IEEE half precision values have a 11-bit significand but a limited range (normal values between 6.1e-5 and
+ * 65504), inputs must keep the mesh pressures well below 65504. bfloat16 values have the range of 32-bit floating
+ * point values but a 8-bit significand
+ */
+typedef enum {
+    /**
+     * 32-bit floating point storage
+     */
+    DWM_MA_STORAGE_FLOAT32 = 0,
+    /**
+     * IEEE 754 half precision storage
+     */
+    DWM_MA_STORAGE_FLOAT16,
+    /**
+     * bfloat16 storage
+     */
+    DWM_MA_STORAGE_BFLOAT16
+} DWM_MA_STORAGE;
+
+/**
+ * Junction topologies of a mesh, i.e. the neighbours each junction update reads and the spacing of the junctions
+ * @details The rectilinear scheme's numerical dispersion strongly depends on the direction of propagation, which has to
+ * be compensated by oversampling, while the interpolated scheme's is nearly isotropic. Measured as the bandwidth
+ * within which the phase velocity errs by less than 2% in every direction, the rectilinear scheme is accurate up to
+ * 0.075 times the sampling rate and the interpolated one up to 0.185 times: for the same accurate bandwidth and room,
+ * the interpolated scheme updates about 7 times fewer junctions per second, each costing 2 to 3 times as much (the most
+ * on small meshes, whose face junctions are slower to update). \n
+ * Junctions are sqrt(3) * sound_propagation_speed / sample_rate apart in rectilinear meshes and
+ * sound_propagation_speed / sample_rate apart in interpolated ones (see dwm_ma_junction_size_m), thus an interpolated
+ * mesh of the same room and junction sizes runs at a sampling rate sqrt(3) times lower, and still renders a wider
+ * accurate bandwidth
+ */
+typedef enum {
+    /**
+     * Rectilinear scheme, each junction being updated from its 6 face neighbours
+     */
+    DWM_MA_TOPOLOGY_RECTILINEAR = 0,
+    /**
+     * Interpolated scheme, each junction being updated from its 26 face, edge and corner neighbours, based on the
+     * interpolated wideband scheme described in
+     * Kowalczyk, Konrad and van Walstijn, Maarten. "Room acoustics simulation using 3-D compact explicit FDTD schemes."
+     * IEEE Transactions on Audio, Speech, and Language Processing 19.1 (2011): 34-46.
+     * @remark Faces are locally reacting boundaries whose frequency-independent damping follows the static reflectance
+     * of the boundary parameters (the normalized admittance, or 2 * R1 + R2, see dwm_ma_init), thus the low-pass
+     * cutoff has no effect. Unlike the rectilinear scheme's boundary filters, the damping keeps the scheme stable on
+     * the mesh's edges and corners
+     * @remark Not available with DWM_MA_STORAGE_FLOAT16 or DWM_MA_STORAGE_BFLOAT16, whose rounding errors make the
+     * scheme diverge, nor with a room geometry (see dwm_ma_set_geometry) nor in batches (see dwm_ma_batch.h)
+     * @remark Without inputs, the mesh energy decays steadily down to silence (see
+     * tests/dwm_ma_interpolated_decay_test.c)
+     */
+    DWM_MA_TOPOLOGY_INTERPOLATED
+} DWM_MA_TOPOLOGY;
+
+/**
+ * dwm-ma mesh configuration, the runtime counterpart of the user-redefinable definitions
+ */
+typedef struct {
+    /**
+     * DSP sampling rate
+     */
+    int sample_rate;
+    /**
+     * DSP buffer size, i.e. the amount of samples processed by each dwm_ma_process_interpolated call, and the largest
+     * amount a dwm_ma_process_frames call processes at once (longer calls being split in buffers)
+     */
+    int buffer_size;
+    /**
+     * Junctions size on the X-axis
+     */
+    int size_x_j;
+    /**
+     * Junctions size on the Y-axis
+     */
+    int size_y_j;
+    /**
+     * Junctions size on the Z-axis
+     */
+    int size_z_j;
+    /**
+     * Sound propagation speed
+     */
+    float sound_propagation_speed;
+    /**
+     * Storage format of the junction pressures (DWM_MA_STORAGE_FLOAT32 by default)
+     */
+    DWM_MA_STORAGE storage;
+    /**
+     * Junction topology (DWM_MA_TOPOLOGY_RECTILINEAR by default)
+     */
+    DWM_MA_TOPOLOGY topology;
+} dwm_ma_mesh_config;
+
+/**
+ * Amount of buckets of the call time histogram of dwm_ma_stats
+ */
+#define DWM_MA_STATS_HISTOGRAM_SIZE 16
+
+/**
+ * Phases of a dwm-ma processing call, as accounted by dwm_ma_stats
+ */
+typedef enum {
+    /**
+     * Input resampling, interpolation parameters and sorting of the junctions written and read during the sweep
+     */
+    DWM_MA_PHASE_PRECOMPUTE = 0,
+    /**
+     * Writing of the inputs into their junctions
+     */
+    DWM_MA_PHASE_INJECTION,
+    /**
+     * Junction updates of the simulation steps, boundary filters excluded
+     */
+    DWM_MA_PHASE_ITERATION,
+    /**
+     * Boundary filters of the mesh faces
+     */
+    DWM_MA_PHASE_BOUNDARIES,
+    /**
+     * Reading of the microphones from their junctions
+     */
+    DWM_MA_PHASE_CAPTURE,
+    /**
+     * Ambisonics encoding and output resampling
+     */
+    DWM_MA_PHASE_OUTPUT,
+    /**
+     * Convolution rendering of a captured scene
+     */
+    DWM_MA_PHASE_CONVOLUTION,
+    /**
+     * Amount of phases
+     */
+    DWM_MA_PHASE_COUNT
+} DWM_MA_PHASE;
+
+/**
+ * Runtime statistics of the processing calls of a dwm-ma instance, all times being in nanoseconds
+ */
+typedef struct {
+    /**
+     * Amount of processing calls
+     */
+    uint64_t call_count;
+    /**
+     * Amount of processing calls which took longer than deadline_ns
+     */
+    uint64_t overrun_count;
+    /**
+     * Deadline of a processing call
+     */
+    uint64_t deadline_ns;
+    /**
+     * Total time of all processing calls
+     */
+    uint64_t total_ns;
+    /**
+     * Time of the longest processing call
+     */
+    uint64_t worst_ns;
+    /**
+     * Time of the last processing call
+     */
+    uint64_t last_ns;
+    /**
+     * Total time spent in each phase, indexed by DWM_MA_PHASE
+     */
+    uint64_t phase_ns[DWM_MA_PHASE_COUNT];
+    /**
+     * Amount of processing calls by time, bucket b counting the calls which took between b / 8 and (b + 1) / 8 of
+     * deadline_ns (the last bucket counting all longer calls)
+     */
+    uint64_t histogram[DWM_MA_STATS_HISTOGRAM_SIZE];
+} dwm_ma_stats;
+
+/**
+ * Fills a mesh configuration with the values of the user-redefinable definitions
+ * @param config mesh configuration to be filled
+ */
+void dwm_ma_mesh_config_default(dwm_ma_mesh_config *config);
+
+/**
+ * Metric size of a single junction of a mesh configuration
+ * @param config mesh configuration
+ * @return the distance between two neighbouring junctions, DWM_MA_SIZE_JUNCTION_M for the default configuration
+ */
+float dwm_ma_junction_size_m(const dwm_ma_mesh_config *config);
+
 /**
  * Creates a new dwm-ma instance
  * @param dwm_ma address of dwm-ma handle
@@ -90,12 +313,327 @@
  */
 void dwm_ma_create(void **dwm_ma);
 
+/**
+ * Creates a new dwm-ma instance with a runtime mesh configuration
+ * @param dwm_ma address of dwm-ma handle
+ * @param config mesh configuration, with the same constraints as the user-redefinable definitions
+ * @return 0 on success, non-zero if the configuration is not valid or the instance cannot be allocated (the handle is
+ * then set to NULL)
+ * @details The instance is allocated as a single memory block, laid out as by dwm_ma_create_in
+ * @note Meshes whose size is listed in DWM_MA_SPECIALIZED_SIZES are processed by code specialized for that size, the
+ * others by a generic (slightly slower) code path
+ * @note Metric sizes follow from the configuration as in the DWM_MA_SIZE_?_M definitions, with the junction size of
+ * its topology (see dwm_ma_junction_size_m), and all the DWM_MA_SIZE_* and DWM_MA_BUFFER_SIZE mentions of the other
+ * functions refer to the configuration's values instead
+ */
+int dwm_ma_create_ex(void **dwm_ma, const dwm_ma_mesh_config *config);
+
+/**
+ * Alignment in bytes of each section of a dwm-ma instance's memory block (one cache line)
+ */
+#define DWM_MA_MEMORY_ALIGNMENT 64
+
+/**
+ * Computes the size of the memory block needed by dwm_ma_create_in
+ * @param config mesh configuration, with the same constraints as in dwm_ma_create_ex
+ * @return size in bytes, 0 if the configuration is not valid
+ * @note The size includes the slack needed to align a block of any alignment to DWM_MA_MEMORY_ALIGNMENT
+ */
+size_t dwm_ma_memory_requirements(const dwm_ma_mesh_config *config);
+
+/**
+ * Creates a new dwm-ma instance inside a caller-provided memory block, without allocating any memory
+ * @param dwm_ma address of dwm-ma handle
+ * @param config mesh configuration, with the same constraints as in dwm_ma_create_ex
+ * @param memory memory block holding the whole instance (the handle included), which must outlive the instance
+ * @param memory_size size in bytes of the memory block
+ * @return 0 on success, non-zero if the configuration is not valid or the memory block is NULL or smaller than
+ * dwm_ma_memory_requirements(config) (the handle is then set to NULL)
+ * @details The handle, the boundary filters and the junction pressures are laid out at DWM_MA_MEMORY_ALIGNMENT
+ * aligned offsets from the first aligned address of the block, with the two pressure buffers half a page apart modulo
+ * the page size to avoid 4K aliasing between the loads and stores of each step. The caller controls the placement of
+ * the instance, e.g. on huge pages, locked in memory or inside a bigger arena
+ * @note Safe to call from a real-time thread. dwm_ma_destroy releases the instance's worker threads but never the
+ * memory block, which stays owned by the caller
+ */
+int dwm_ma_create_in(void **dwm_ma, const dwm_ma_mesh_config *config, void *memory, size_t memory_size);
+
 /**
  * Destroys a dwm-ma instance
  * @param dwm_ma address of a valid dwm-ma handle
  */
 void dwm_ma_destroy(void **dwm_ma);
 
+/**
+ * Magic bytes opening every dwm-ma snapshot file
+ */
+#define DWM_MA_SNAPSHOT_MAGIC "DWMASNP1"
+
+/**
+ * Version of the dwm-ma snapshot format, incremented whenever the layout of the file or of the instance memory block
+ * changes
+ */
+#define DWM_MA_SNAPSHOT_VERSION 4
+
+/**
+ * Size in bytes reserved for the header of a dwm-ma snapshot file (one page)
+ */
+#define DWM_MA_SNAPSHOT_HEADER_SIZE 4096
+
+/**
+ * Header of a dwm-ma snapshot file, all fields being stored in the host's byte order
+ * @details The header is padded to DWM_MA_SNAPSHOT_HEADER_SIZE bytes and followed by an image of the instance's memory
+ * block of block_size bytes, laid out as by dwm_ma_create_in (the handle itself left blank) with the junction
+ * pressures and the mesh faces' boundary filter states, and then by the filter states of the geometry links (3 x
+ * link_count 32-bit floats), if any, at the links_offset following the image rounded up to DWM_MA_MEMORY_ALIGNMENT,
+ * geometry_hash identifying the geometry they belong to. The image is only valid
+ * for the same version, built with the same compiler
+ */
+typedef struct {
+    char magic[8];
+    int32_t version;
+    int32_t sample_rate;
+    int32_t buffer_size;
+    int32_t size_x_j;
+    int32_t size_y_j;
+    int32_t size_z_j;
+    float sound_propagation_speed;
+    int32_t storage;
+    int32_t topology;
+    float b_params[6][2];
+    int32_t active_begin[3];
+    int32_t active_end[3];
+    int32_t link_count;
+    uint64_t block_size;
+    uint64_t links_offset;
+    uint64_t geometry_hash;
+} dwm_ma_snapshot_header;
+
+/**
+ * Saves the simulation state of a dwm-ma instance into a snapshot file
+ * @param dwm_ma valid dwm-ma handle
+ * @param path path of the snapshot file, which is created or overwritten
+ * @return 0 on success, non-zero if the file cannot be written (the file at path is then left untouched)
+ * @details The snapshot is written into the temporary file path followed by ".tmp", which is renamed over path once
+ * complete and synchronized to disk, and removed on failure. \n
+ * The snapshot holds the mesh configuration, the junction pressures, the boundary filter states (mesh faces
+ * and geometry links) and the boundary parameters, i.e. the whole reverberant field
+ * @note Performs file I/O, thus it must not be called from a real-time thread
+ */
+int dwm_ma_save_snapshot(const void *dwm_ma, const char *path);
+
+/**
+ * Creates a new dwm-ma instance from a snapshot file, resuming the simulation where the snapshot was saved
+ * @param dwm_ma address of dwm-ma handle
+ * @param path path of the snapshot file
+ * @return 0 on success, non-zero if the file cannot be mapped or is not valid (the handle is then set to NULL)
+ * @details The file is mapped privately and its image becomes the instance's memory block, without reading or copying
+ * it: pages are loaded on first access and copied on first write, and the file itself is never modified. The boundary
+ * parameters are restored too, dwm_ma_init must not be called (it would clear the restored state)
+ * @note The geometry, the boundary maps, the custom layout, the Ambisonics order, the host's sampling rate and the
+ * captured responses are settings rather than state and are not saved, they are set again after loading (none of those
+ * functions clears the mesh). Setting the same geometry as the saved instance's restores its links' filter states
+ * (any other geometry starts them from silence), and the host resamplers restart from silence
+ * @note Maps the file and allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_load_snapshot(void **dwm_ma, const char *path);
+
+/**
+ * Creates a copy of a dwm-ma instance, which then evolves independently
+ * @param clone address of the copy's handle
+ * @param dwm_ma valid dwm-ma handle
+ * @return 0 on success, non-zero if the copy cannot be allocated (the handle is then set to NULL)
+ * @details The copy has the same mesh configuration, simulation state, boundary parameters and maps, geometry, custom
+ * layout, Ambisonics order, host's sampling rate (resampler histories included), amount of threads, temporal block size
+ * and statistics settings, so that both produce the same output for the same processing calls until either is changed
+ * (e.g. to compare parameter variants of a live room)
+ * @note Captured responses (see dwm_ma_capture_convolution) are not copied, the copy rendering every scene live
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_clone(void **clone, const void *dwm_ma);
+
+/**
+ * Sets the simulation state of a dwm-ma instance to the one of another instance of the same room, meshed at any other
+ * resolution (e.g. a different sampling rate)
+ * @param dwm_ma valid dwm-ma handle, whose state is replaced
+ * @param source valid dwm-ma handle, whose state is read
+ * @details Both junction pressure buffers are resampled in space by sampling the source's at each junction's metric
+ * position with trilinear interpolation, inside the source's active region (grown to the instance's junctions it
+ * reaches). The mesh faces' boundary filter states are resampled likewise with bilinear interpolation over each face,
+ * while the geometry's links and the resampler histories restart from silence. The resampled buffers are taken as
+ * consecutive steps of the instance whatever the ratio of both time steps, so that the switch keeps the wavefronts'
+ * positions and amplitudes but not their exact velocities: the few artifacts this produces are meant to be hidden by a
+ * crossfade (see dwm_ma_lod.h)
+ * @note Does not allocate memory, but costs about a simulation step of the instance
+ */
+void dwm_ma_transfer_state(void *dwm_ma, const void *source);
+
+/**
+ * Sets the amount of threads used to process each simulation step of a dwm-ma instance
+ * @param dwm_ma address of a valid dwm-ma handle
+ * @param thread_count amount of threads, including the one calling dwm_ma_process_interpolated (1 by default)
+ * @details Each step is split in thread_count slabs along the Z-axis, processed by a persistent pool of pinned worker
+ * threads which synchronize once per step; sources are written and microphones are read by the calling thread only
+ * @note Creates and destroys threads, thus it must not be called from a real-time thread
+ * @note The amount of threads is clamped to [1, DWM_MA_SIZE_Z_J], if the threads cannot be created the instance keeps
+ * running on the calling thread only
+ */
+void dwm_ma_set_thread_count(void *dwm_ma, int thread_count);
+
+/**
+ * Sets the amount of simulation steps advanced by each pass over the mesh of a dwm-ma instance
+ * @param dwm_ma address of a valid dwm-ma handle
+ * @param temporal_block_size amount of steps per pass (1 by default, which disables temporal blocking)
+ * @details Meshes whose pressures (two values of the storage format per junction) do not fit in the last-level cache
+ * are bound by memory bandwidth when processed one step at a time. With temporal blocking the mesh is swept by a
+ * wavefront along the Z-axis which advances temporal_block_size steps at a time, so that each Z-plane is loaded from
+ * memory once per pass instead of once per step, the wavefront's working set being about 2 x (temporal_block_size + 2)
+ * Z-planes
+ * @note Blocking only pays off for meshes larger than the last-level cache: the wavefront's skewed sweep costs more
+ * than the bandwidth it saves on meshes which already fit, e.g. a float 128 x 128 x 128 mesh fitting in L3 cache ran at
+ * 1158 million junctions per second step by step, and at 1033, 1056 and 866 with blocks of 4, 16 and 64 steps. Keep
+ * the default on meshes which fit, and measure the block size on larger ones with dwm-ma-bench --block
+ * @note Sources and microphones are written and read at their step inside the wavefront, the output is identical to
+ * step by step processing
+ * @note Temporal blocking is only used when the instance runs on a single thread (see dwm_ma_set_thread_count)
+ * @note The block size is clamped to [1, DWM_MA_BUFFER_SIZE]
+ */
+void dwm_ma_set_temporal_block_size(void *dwm_ma, int temporal_block_size);
+
+/**
+ * Sets the voxelized room geometry of a dwm-ma instance, made of air and solid junctions
+ * @param dwm_ma valid dwm-ma handle
+ * @param cells material of each junction, 0 for air and m in [1, material_count] for a solid made of the m-th material
+ * (dimensionality DWM_MA_SIZE_Z_J x DWM_MA_SIZE_Y_J x DWM_MA_SIZE_X_J), or NULL for a box-shaped room
+ * @param material_params boundary parameters of each material, as in dwm_ma_init (dimensionality material_count x 2)
+ * @param material_count amount of materials (no more than 255)
+ * @param material_params_normalized controls how material_params are interpreted, as in dwm_ma_init
+ * @return 0 on success, non-zero if a cell's material is not valid, the instance's topology is
+ * DWM_MA_TOPOLOGY_INTERPOLATED or the geometry cannot be allocated (the previous geometry is then kept)
+ * @details The walls of solids are frequency-dependent boundaries, as the mesh faces are: every side of an air
+ * junction facing a solid junction has a boundary filter, using the solid's material. Air junctions are precomputed as
+ * runs of junctions surrounded by air, processed by the SIMD row kernel, and edge junctions, so that solid junctions
+ * cost nothing
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ * @note Solid junctions are silenced and the boundary filters of the new geometry start from silence, while air
+ * junctions keep their state. Sources and microphones are expected to lie in air: an input's share of the solid
+ * junctions around it is written to the air junctions around it, and an input surrounded by solid junctions is
+ * dropped
+ * @note Box-shaped rooms (whose cells are all air) produce the same output as without geometry, only slower
+ */
+int dwm_ma_set_geometry(void *dwm_ma, const uint8_t *cells, const float material_params[][2], int material_count,
+                        int material_params_normalized);
+
+/**
+ * Sets the runtime microphone array layout a dwm-ma instance reads when processing with MA_CONFIG_CUSTOM
+ * @param dwm_ma valid dwm-ma handle
+ * @param layout valid layout, or NULL to remove the instance's layout (MA_CONFIG_CUSTOM then resulting in
+ * MA_CONFIG_MONO being used)
+ * @return 0 on success, non-zero if the layout cannot be allocated (the previous layout is then kept)
+ * @details The instance keeps a copy of the layout, which may be destroyed afterwards, along with the per microphone
+ * working memory of a processing call, so that any amount of channels is read without allocating memory. Microphones
+ * are read in the layout's sorted order, walking the mesh memory forwards
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ * @note The layout's radius is expressed in junctions, and is scaled by ma_scale as the microphone positions are
+ */
+int dwm_ma_set_custom_layout(void *dwm_ma, const ma_custom_layout *layout);
+
+/**
+ * Sets the Ambisonics order a dwm-ma instance encodes its microphone array output to
+ * @param dwm_ma valid dwm-ma handle
+ * @param order Ambisonics order, in [0, MA_AMBISONICS_MAX_ORDER], or negative to output the microphones themselves (by
+ * default)
+ * @return 0 on success, non-zero if the order is not valid or the encoder cannot be allocated (the previous order is
+ * then kept)
+ * @details Processing calls then output the (order + 1)^2 Ambisonics channels (ACN channel ordering, SN3D
+ * normalization) of the microphone array in place of its microphones. Each layout's encoding matrix is precomputed
+ * with ma_ambisonics_encoder, from the layout's mic_azi_elev (or, for the custom layout, from its coordinates), and
+ * applied to each buffer by a SIMD matrix product
+ * @note Channels of orders higher than a layout resolves are silent, see ma_ambisonics_encoder
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_set_ambisonics_order(void *dwm_ma, int order);
+
+/**
+ * Sets the sampling rate of the buffers a dwm-ma instance exchanges with its host
+ * @param dwm_ma valid dwm-ma handle
+ * @param host_sample_rate host's sampling rate, or 0 to exchange buffers at the mesh's own rate (by default)
+ * @return 0 on success, non-zero if a buffer spans less than a host sample or the resamplers cannot be allocated (the
+ * previous rate is then kept)
+ * @details Processing calls then take and output buffers of buffer_size * host_sample_rate / sample_rate samples
+ * (rounded down): the inputs are resampled to the mesh's rate before the simulation, and its outputs (after Ambisonics
+ * encoding, if any) back to the host's rate, by polyphase resamplers whose history and phase are cleared by
+ * dwm_ma_init. This lets a mesh run at a fraction of a 48kHz or 44.1kHz host's rate, which divides its junction count
+ * by the cube of the ratio. The resamplers carry their phase from one call to the next, so that calls need not span a
+ * whole amount of mesh samples: each call runs as many mesh steps as its host samples complete, and outputs exactly its
+ * own amount of host samples
+ * @note The resamplers (see dwm_ma_resampler.h) add a latency of DWM_MA_RESAMPLER_ZERO_CROSSINGS samples at the lower
+ * of the two rates to each direction, and attenuate the content above 90% of the lower rate's Nyquist frequency
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_set_host_sample_rate(void *dwm_ma, int host_sample_rate);
+
+/**
+ * Captures the responses of a still scene, which processing calls then render by convolution instead of simulating it
+ * @param dwm_ma valid dwm-ma handle
+ * @param in_positions_m metric positions of each input (dimensionality in_count x 3)
+ * @param in_count amount of inputs (no more than DWM_MA_MAX_INPUT_COUNT)
+ * @param ma_config microphone array configuration
+ * @param ma_scale microphone array scale
+ * @param ma_position_m microphone array's center position (dimensionality 1 x 3)
+ * @param rir_length amount of samples of each response (rounded up to whole buffers), or 0 to discard the captured
+ * responses
+ * @return 0 on success, non-zero if the responses cannot be allocated (any previous capture is then discarded)
+ * @details A still scene is a fixed linear filter: the response of each input to each output channel is simulated
+ * once, with an impulse emitted by that input (in_count simulations of rir_length samples), and processing calls
+ * whose objects are all still at the captured positions, with the same in_count, ma_config, ma_scale and boundary
+ * parameters, are then rendered by a uniformly partitioned FFT convolution of their buffers with those responses (see
+ * dwm_ma_convolver.h), whose cost does not depend on the mesh size. Any other call simulates the mesh live. Switching
+ * keeps both renderings' tails: the one not rendering the call keeps producing the response of its previous inputs
+ * for rir_length samples, which is added to the output
+ * @note Responses are truncated to rir_length samples, which should cover the room's reverberation
+ * @note The simulation state is cleared, as dwm_ma_init does (keeping the boundary parameters), and the captured
+ * responses are discarded by dwm_ma_set_geometry, dwm_ma_set_custom_layout, dwm_ma_set_ambisonics_order and
+ * dwm_ma_set_host_sample_rate
+ * @note Allocates memory and simulates in_count * rir_length samples, thus it must not be called from a real-time
+ * thread
+ */
+int dwm_ma_capture_convolution(void *dwm_ma, const float *const *in_positions_m, int in_count, MA_CONFIG ma_config,
+                               float ma_scale, const float *ma_position_m, int rir_length);
+
+/**
+ * Enables or disables the runtime statistics of a dwm-ma instance
+ * @param dwm_ma valid dwm-ma handle
+ * @param enabled non-zero to enable the statistics, disabled by default
+ * @details Enabled statistics time every processing call and each of its phases with a monotonic clock, read a few
+ * times per simulation step (more with temporal blocking, at every Z-plane), which costs a few percent on small meshes
+ * and less on larger ones. Disabled statistics only cost a branch per phase
+ * @note The phases of multithreaded simulation steps (see dwm_ma_set_thread_count) are not told apart, they are all
+ * accounted to DWM_MA_PHASE_ITERATION
+ */
+void dwm_ma_set_stats_enabled(void *dwm_ma, int enabled);
+
+/**
+ * Sets the deadline a dwm-ma instance's processing calls are compared to by the runtime statistics
+ * @param dwm_ma valid dwm-ma handle
+ * @param deadline_ns deadline of a processing call in nanoseconds, or 0 for the duration of a buffer (by default)
+ */
+void dwm_ma_set_stats_deadline(void *dwm_ma, uint64_t deadline_ns);
+
+/**
+ * Reads the runtime statistics of a dwm-ma instance, accumulated since it was created or they were last reset
+ * @param dwm_ma valid dwm-ma handle
+ * @param stats statistics to be filled
+ * @note Must be called from the thread calling the processing functions, or while none of them runs
+ */
+void dwm_ma_get_stats(const void *dwm_ma, dwm_ma_stats *stats);
+
+/**
+ * Resets the runtime statistics of a dwm-ma instance, keeping its deadline
+ * @param dwm_ma valid dwm-ma handle
+ */
+void dwm_ma_reset_stats(void *dwm_ma);
+
 /**
  * Initializes a dwm-ma instance to the initial state
  * @param dwm_ma address of a valid dwm-ma handle
@@ -113,6 +651,37 @@ void dwm_ma_destroy(void **dwm_ma);
  */
 void dwm_ma_init(void *dwm_ma, const float dwm_bound_params[6][2], int dwm_bound_params_normalized);
 
+/**
+ * Changes the boundary parameters of a running dwm-ma instance, without clearing its state
+ * @param dwm_ma valid dwm-ma handle
+ * @param dwm_bound_params dwm boundary parameters, as in dwm_ma_init
+ * @param dwm_bound_params_normalized controls how dwm_bound_params are interpreted, as in dwm_ma_init
+ * @details The filter values of each face ramp linearly from their previous values to the new ones over the next
+ * processed buffer, reaching them on its last step, so that a material change is not heard as a step. Faces with a
+ * boundary map (see dwm_ma_set_boundary_map) ramp from the map to the uniform values, the map being discarded
+ * @note Does not allocate memory: it may be called from the real-time thread, between two processing calls
+ */
+void dwm_ma_set_boundary_params(void *dwm_ma, const float dwm_bound_params[6][2], int dwm_bound_params_normalized);
+
+/**
+ * Sets per junction boundary parameters on a face of a running dwm-ma instance, without clearing its state
+ * @param dwm_ma valid dwm-ma handle
+ * @param face face index, in order [Z-,Y-,X-,X+,Y+,Z+]
+ * @param params boundary parameters of each junction of the face, as in dwm_ma_init, or NULL to go back to the face's
+ * uniform parameters. Z faces are indexed by y * DWM_MA_SIZE_X_J + x, Y faces by z * DWM_MA_SIZE_X_J + x and X faces
+ * by z * DWM_MA_SIZE_Y_J + y (dimensionality face junction count x 2)
+ * @param params_normalized controls how params are interpreted, as in dwm_ma_init
+ * @return 0 on success, non-zero if the face is not valid or the map cannot be allocated (the previous parameters are
+ * then kept)
+ * @details Maps are stored as arrays of R1 and R2 values in the order of the face's filter states, which the boundary
+ * pass streams through along with them. Changes ramp over the next processed buffer, as with
+ * dwm_ma_set_boundary_params. dwm_ma_init discards every map
+ * @note Maps apply to the mesh faces of box-shaped rooms, the faces of a geometry (see dwm_ma_set_geometry) keep their
+ * uniform parameters
+ * @note Allocates memory the first time a face gets a map, thus it must not be called from a real-time thread
+ */
+int dwm_ma_set_boundary_map(void *dwm_ma, int face, const float (*params)[2], int params_normalized);
+
 /**
  * Processes DWM_MA_BUFFER_SIZE samples inside a dwm-ma, with dwm coordinates expressed in metric units
  * @param dwm_ma address of a valid dwm-ma handle
@@ -121,15 +690,86 @@ void dwm_ma_init(void *dwm_ma, const float dwm_bound_params[6][2], int dwm_bound
  * @param in_count amount of inputs processed (no more than DWM_MA_MAX_INPUT_COUNT)
  * @param ma_config microphone array configuration used
  * @param ma_scale microphone array scale
- * @param ma_buffers samples outputted by each microphone (dimensionality ma_config->channel_count x DWM_MA_BUFFER_SIZE)
+ * @param ma_buffers samples outputted by each microphone (dimensionality ma_config->channel_count x
+ * DWM_MA_BUFFER_SIZE), or by each Ambisonics channel if the instance has an Ambisonics order (see
+ * dwm_ma_set_ambisonics_order)
  * @param ma_position_m microphone array's center position (dimensionality 1 x 3)
  * @note Non-valid coordinates are clamped to valid mesh coordinates, the microphone array's center is also moved to the
  * nearest valid position inside the mesh to avoid sampling of non-valid coordinates
  * @note Positions between discrete junctions are read/written with trilinear interpolation
- * @note Non-valid ma_config values result in MA_CONFIG_MONO being used
+ * @note Non-valid ma_config values, as well as MA_CONFIG_CUSTOM on an instance without a custom layout (see
+ * dwm_ma_set_custom_layout), result in MA_CONFIG_MONO being used
+ * @note Parts of the mesh not yet reached by any wavefront since dwm_ma_init are not processed (the output is the same
+ * as if they were), so a mesh whose sources are silent costs nothing and its cost grows with the sound's extent
+ * @note Sources are written and microphones read during the simulation sweep itself, as it produces each Z-plane they
+ * lie on, rather than in separate passes over the mesh
  */
 void dwm_ma_process_interpolated(void *dwm_ma, const float *const *in_buffers, const float *const *in_positions_m,
                                  int in_count, MA_CONFIG ma_config, float ma_scale, float *const *ma_buffers,
                                  const float *ma_position_m);
 
+/**
+ * Processes DWM_MA_BUFFER_SIZE samples inside a dwm-ma while moving the inputs and the microphone array, with dwm
+ * coordinates expressed in metric units
+ * @param dwm_ma address of a valid dwm-ma handle
+ * @param in_buffers samples introduced by each input (dimensionality in_count x DWM_MA_BUFFER_SIZE)
+ * @param in_positions_start_m metric positions of each input at the buffer's first sample (dimensionality in_count x 3)
+ * @param in_positions_end_m metric positions of each input at the next buffer's first sample (dimensionality
+ * in_count x 3)
+ * @param in_count amount of inputs processed (no more than DWM_MA_MAX_INPUT_COUNT)
+ * @param ma_config microphone array configuration used
+ * @param ma_scale microphone array scale
+ * @param ma_buffers samples outputted by each microphone (dimensionality ma_config->channel_count x
+ * DWM_MA_BUFFER_SIZE), or by each Ambisonics channel if the instance has an Ambisonics order (see
+ * dwm_ma_set_ambisonics_order)
+ * @param ma_position_start_m microphone array's center position at the buffer's first sample (dimensionality 1 x 3)
+ * @param ma_position_end_m microphone array's center position at the next buffer's first sample (dimensionality 1 x 3)
+ * @details Each object moves along a straight line at constant speed, sample n being written/read at n /
+ * DWM_MA_BUFFER_SIZE of the way between its start and end positions, and its interpolation parameters are updated on
+ * every sample. Passing each buffer's end positions as the next buffer's start positions results in continuous
+ * trajectories, without any buffer-rate steps
+ * @note Same behaviour as dwm_ma_process_interpolated for still objects (equal start and end positions), which is
+ * equivalent to this function with the same start and end positions
+ * @note Temporal blocking (see dwm_ma_set_temporal_block_size) is only used when all objects are still
+ */
+void dwm_ma_process_trajectory(void *dwm_ma, const float *const *in_buffers, const float *const *in_positions_start_m,
+                               const float *const *in_positions_end_m, int in_count, MA_CONFIG ma_config,
+                               float ma_scale, float *const *ma_buffers, const float *ma_position_start_m,
+                               const float *ma_position_end_m);
+
+/**
+ * Processes a variable amount of samples inside a dwm-ma while moving the inputs and the microphone array, with dwm
+ * coordinates expressed in metric units
+ * @param dwm_ma address of a valid dwm-ma handle
+ * @param in_buffers samples introduced by each input (dimensionality in_count x frame_count)
+ * @param in_positions_start_m metric positions of each input at the call's first sample (dimensionality in_count x 3)
+ * @param in_positions_end_m metric positions of each input at the next call's first sample (dimensionality
+ * in_count x 3)
+ * @param in_count amount of inputs processed (no more than DWM_MA_MAX_INPUT_COUNT)
+ * @param ma_config microphone array configuration used
+ * @param ma_scale microphone array scale
+ * @param ma_buffers samples outputted by each microphone (dimensionality ma_config->channel_count x frame_count), or
+ * by each Ambisonics channel if the instance has an Ambisonics order (see dwm_ma_set_ambisonics_order)
+ * @param ma_position_start_m microphone array's center position at the call's first sample (dimensionality 1 x 3)
+ * @param ma_position_end_m microphone array's center position at the next call's first sample (dimensionality 1 x 3)
+ * @param frame_count amount of samples processed, non-negative
+ * @return 0 on success, non-zero if frame_count is negative (nothing is then processed, and ma_buffers are left
+ * untouched)
+ * @details Same as dwm_ma_process_trajectory over frame_count samples, each call mapping to frame_count mesh steps
+ * that read and write the caller's buffers directly, so that hosts whose callbacks vary in size (e.g. 441, 480 or 1024
+ * frames) need no FIFO. Calls longer than a buffer (buffer_size samples, or the host's buffer size if the instance has
+ * a host sampling rate) are processed as consecutive buffers. Objects move at n / frame_count of the way between their
+ * start and end positions at sample n, and boundary parameter changes ramp over the first buffer following them
+ * @note Instances with a host sampling rate (see dwm_ma_set_host_sample_rate) run the mesh steps the call's host
+ * samples complete, its resamplers carrying their phase from one call to the next, and a captured scene (see
+ * dwm_ma_capture_convolution) is convolved in parts of its blocks without latency, at the cost of an FFT per part
+ * @note The interpolation parameters and taps of still objects are kept from one call to the next, and only computed
+ * again once an object moves or the scene (in_count, ma_config, ma_scale, positions, custom layout or Ambisonics
+ * order) changes, which keeps small calls from paying for the same setup over and over
+ */
+int dwm_ma_process_frames(void *dwm_ma, const float *const *in_buffers, const float *const *in_positions_start_m,
+                          const float *const *in_positions_end_m, int in_count, MA_CONFIG ma_config, float ma_scale,
+                          float *const *ma_buffers, const float *ma_position_start_m, const float *ma_position_end_m,
+                          int frame_count);
+
 #endif
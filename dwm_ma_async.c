@@ -0,0 +1,234 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "dwm_ma_async.h"
+#include "dwm_ma_internal.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal structs and functions declarations
+
+/**
+ * Internal ring slot, holding the arguments of a processing call and its outputs
+ */
+typedef struct {
+    float *in_samples, *out_samples;
+    float in_positions_start_m[DWM_MA_MAX_INPUT_COUNT][3];
+    float in_positions_end_m[DWM_MA_MAX_INPUT_COUNT][3];
+    float ma_position_start_m[3], ma_position_end_m[3];
+    int in_count;
+    MA_CONFIG ma_config;
+    float ma_scale;
+} dwm_ma_async_slot_t;
+
+/**
+ * Internal asynchronous front-end implementation. Buffer indices grow forever (wrapping around) and are mapped to
+ * slots modulo slot_count: submitted is only written by the calling thread, completed only by the worker thread, and
+ * consumed is private to the calling thread. out_buffers is the worker's table of output pointers (dimensionality
+ * out_count)
+ */
+typedef struct {
+    void *dwm_ma;
+    int buffer_size, out_count, depth, slot_count;
+    dwm_ma_async_slot_t *slots;
+    float *samples;
+    float **out_buffers;
+    atomic_uint submitted, completed;
+    atomic_int signal, sleeping, stop;
+    unsigned consumed;
+    atomic_uint_fast64_t underrun_count, dropped_count;
+    pthread_t thread;
+} dwm_ma_async_t;
+
+/**
+ * Worker thread entry point, processing every submitted buffer in order
+ */
+static void *worker_main(void *arg);
+
+/**
+ * Silences the outputs of a processing call
+ */
+static void clear_outputs(const dwm_ma_async_t *handle, float *const *ma_buffers);
+
+// Function definitions
+
+int dwm_ma_async_create(void **async, void *const dwm_ma, const int buffer_size, const int out_count,
+                        const int depth) {
+    if (dwm_ma == NULL || buffer_size < 1 || out_count < 1 || depth < 1) {
+        *async = NULL;
+        return 1;
+    }
+    dwm_ma_async_t *handle = malloc(sizeof(dwm_ma_async_t));
+    if (handle == NULL) {
+        *async = NULL;
+        return 1;
+    }
+
+    // One slot of slack lets a late buffer finish while the next ones are pushed, and a power of two slot count keeps
+    // the slot mapping continuous when the indices wrap around
+    int slot_count = 1;
+    while (slot_count < depth + 2) {
+        slot_count *= 2;
+    }
+    const size_t slot_samples = (size_t) (DWM_MA_MAX_INPUT_COUNT + out_count) * buffer_size;
+    handle->slots = calloc(slot_count, sizeof(dwm_ma_async_slot_t));
+    handle->samples = calloc(slot_samples * slot_count, sizeof(float));
+    handle->out_buffers = malloc(sizeof(float *) * out_count);
+    if (handle->slots == NULL || handle->samples == NULL || handle->out_buffers == NULL) {
+        free(handle->slots);
+        free(handle->samples);
+        free(handle->out_buffers);
+        free(handle);
+        *async = NULL;
+        return 1;
+    }
+    for (int i = 0; i < slot_count; i++) {
+        handle->slots[i].in_samples = handle->samples + slot_samples * i;
+        handle->slots[i].out_samples = handle->slots[i].in_samples + (size_t) DWM_MA_MAX_INPUT_COUNT * buffer_size;
+    }
+    handle->dwm_ma = dwm_ma;
+    handle->buffer_size = buffer_size;
+    handle->out_count = out_count;
+    handle->depth = depth;
+    handle->slot_count = slot_count;
+    atomic_init(&handle->submitted, 0);
+    atomic_init(&handle->completed, 0);
+    atomic_init(&handle->signal, 0);
+    atomic_init(&handle->sleeping, 0);
+    atomic_init(&handle->stop, 0);
+    handle->consumed = 0;
+    atomic_init(&handle->underrun_count, 0);
+    atomic_init(&handle->dropped_count, 0);
+    if (pthread_create(&handle->thread, NULL, worker_main, handle) != 0) {
+        free(handle->slots);
+        free(handle->samples);
+        free(handle->out_buffers);
+        free(handle);
+        *async = NULL;
+        return 1;
+    }
+    *async = handle;
+    return 0;
+}
+
+void dwm_ma_async_destroy(void **async) {
+    dwm_ma_async_t *handle = *async;
+
+    // Signal the worker to stop and wait for it to exit
+    atomic_store(&handle->stop, 1);
+    dwm_ma_advance_counter(&handle->signal, &handle->sleeping, 1);
+    pthread_join(handle->thread, NULL);
+    free(handle->slots);
+    free(handle->samples);
+    free(handle->out_buffers);
+    free(handle);
+    *async = NULL;
+}
+
+int dwm_ma_async_process(void *async, const float *const *in_buffers, const float *const *in_positions_start_m,
+                         const float *const *in_positions_end_m, int in_count, const MA_CONFIG ma_config,
+                         const float ma_scale, float *const *ma_buffers, const float *ma_position_start_m,
+                         const float *ma_position_end_m) {
+    dwm_ma_async_t *handle = async;
+    const int buffer_size = handle->buffer_size;
+    in_count = in_count < 0 ? 0 : in_count > DWM_MA_MAX_INPUT_COUNT ? DWM_MA_MAX_INPUT_COUNT : in_count;
+
+    // Push the buffer, unless its slot still holds one the worker has not finished
+    unsigned submitted = atomic_load_explicit(&handle->submitted, memory_order_relaxed);
+    const unsigned completed = atomic_load_explicit(&handle->completed, memory_order_acquire);
+    int dropped = 0;
+    if (submitted - completed < (unsigned) handle->slot_count) {
+        dwm_ma_async_slot_t *slot = &handle->slots[submitted % handle->slot_count];
+        for (int i = 0; i < in_count; i++) {
+            memcpy(slot->in_samples + (size_t) buffer_size * i, in_buffers[i], sizeof(float) * buffer_size);
+            memcpy(slot->in_positions_start_m[i], in_positions_start_m[i], sizeof(float[3]));
+            memcpy(slot->in_positions_end_m[i], in_positions_end_m[i], sizeof(float[3]));
+        }
+        memcpy(slot->ma_position_start_m, ma_position_start_m, sizeof(float[3]));
+        memcpy(slot->ma_position_end_m, ma_position_end_m, sizeof(float[3]));
+        slot->in_count = in_count;
+        slot->ma_config = ma_config;
+        slot->ma_scale = ma_scale;
+        atomic_store_explicit(&handle->submitted, ++submitted, memory_order_release);
+        dwm_ma_advance_counter(&handle->signal, &handle->sleeping, 1);
+    } else {
+        atomic_fetch_add_explicit(&handle->dropped_count, 1, memory_order_relaxed);
+        dropped = 1;
+    }
+
+    // Pop the buffer pushed depth calls earlier, the first depth calls being silent
+    if (submitted - handle->consumed <= (unsigned) handle->depth && !dropped) {
+        clear_outputs(handle, ma_buffers);
+        return 0;
+    }
+    const int finished = (int) (atomic_load_explicit(&handle->completed, memory_order_acquire) - handle->consumed) > 0;
+    if (dropped || !finished) {
+        // A late buffer is skipped rather than delayed, so that the latency stays constant
+        handle->consumed += !dropped;
+        atomic_fetch_add_explicit(&handle->underrun_count, 1, memory_order_relaxed);
+        clear_outputs(handle, ma_buffers);
+        return 1;
+    }
+    const dwm_ma_async_slot_t *slot = &handle->slots[handle->consumed++ % handle->slot_count];
+    for (int i = 0; i < handle->out_count; i++) {
+        memcpy(ma_buffers[i], slot->out_samples + (size_t) buffer_size * i, sizeof(float) * buffer_size);
+    }
+    return 0;
+}
+
+uint64_t dwm_ma_async_get_underrun_count(const void *async) {
+    const dwm_ma_async_t *handle = async;
+    return atomic_load_explicit(&handle->underrun_count, memory_order_relaxed);
+}
+
+uint64_t dwm_ma_async_get_dropped_count(const void *async) {
+    const dwm_ma_async_t *handle = async;
+    return atomic_load_explicit(&handle->dropped_count, memory_order_relaxed);
+}
+
+void *worker_main(void *arg) {
+    dwm_ma_async_t *handle = arg;
+    const int buffer_size = handle->buffer_size;
+    const float *in_buffers[DWM_MA_MAX_INPUT_COUNT];
+    const float *in_positions_start_m[DWM_MA_MAX_INPUT_COUNT];
+    const float *in_positions_end_m[DWM_MA_MAX_INPUT_COUNT];
+    float **out_buffers = handle->out_buffers;
+    unsigned completed = 0;
+    for (;;) {
+        // The signal is read before the submitted index, so that no push is missed before sleeping
+        const int seen = atomic_load(&handle->signal);
+        if (atomic_load(&handle->stop)) {
+            break;
+        }
+        if (atomic_load_explicit(&handle->submitted, memory_order_acquire) == completed) {
+            dwm_ma_wait_counter(&handle->signal, &handle->sleeping, seen);
+            continue;
+        }
+
+        // Process the oldest submitted buffer in place
+        dwm_ma_async_slot_t *slot = &handle->slots[completed % handle->slot_count];
+        for (int i = 0; i < slot->in_count; i++) {
+            in_buffers[i] = slot->in_samples + (size_t) buffer_size * i;
+            in_positions_start_m[i] = slot->in_positions_start_m[i];
+            in_positions_end_m[i] = slot->in_positions_end_m[i];
+        }
+        for (int i = 0; i < handle->out_count; i++) {
+            out_buffers[i] = slot->out_samples + (size_t) buffer_size * i;
+        }
+        dwm_ma_process_trajectory(handle->dwm_ma, in_buffers, in_positions_start_m, in_positions_end_m, slot->in_count,
+                                  slot->ma_config, slot->ma_scale, out_buffers, slot->ma_position_start_m,
+                                  slot->ma_position_end_m);
+        atomic_store_explicit(&handle->completed, ++completed, memory_order_release);
+    }
+    return NULL;
+}
+
+void clear_outputs(const dwm_ma_async_t *handle, float *const *ma_buffers) {
+    for (int i = 0; i < handle->out_count; i++) {
+        memset(ma_buffers[i], 0, sizeof(float) * handle->buffer_size);
+    }
+}
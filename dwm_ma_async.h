@@ -0,0 +1,72 @@
+#ifndef DWM_MA_ASYNC_H
+#define DWM_MA_ASYNC_H
+
+#include "dwm_ma.h"
+
+/**
+ * Creates an asynchronous front-end, which processes a dwm-ma instance on a dedicated worker thread
+ * @param async address of front-end handle
+ * @param dwm_ma valid dwm-ma handle, processed by the worker thread from then on
+ * @param buffer_size amount of samples per processing call of the instance (DWM_MA_BUFFER_SIZE, or the configuration's
+ * or the host's buffer size, see dwm_ma_create_ex and dwm_ma_set_host_sample_rate)
+ * @param out_count amount of output channels, no fewer than the instance's processing calls write
+ * @param depth amount of buffers of latency added by the pipeline (at least 1)
+ * @return 0 on success, non-zero if the sizes are not valid, or the front-end cannot be allocated or its worker thread
+ * cannot be created (the handle is then set to NULL)
+ * @details Each dwm_ma_async_process call copies its inputs and trajectories into a single-producer single-consumer
+ * ring of at least depth + 2 buffers, wakes the worker thread, and copies out the outputs of the buffer pushed depth
+ * calls earlier. The worker runs dwm_ma_process_trajectory on the pushed buffers in order, so that a buffer's
+ * simulation may take up to depth buffers' worth of time before it is needed, and only averages out against the
+ * real-time budget
+ * @note The dwm-ma instance must not be used by any other thread until the front-end is destroyed
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_async_create(void **async, void *dwm_ma, int buffer_size, int out_count, int depth);
+
+/**
+ * Stops and joins the worker thread, then destroys the front-end, discarding any buffer not yet processed
+ * @param async address of a valid front-end handle
+ * @note The dwm-ma instance is not destroyed
+ */
+void dwm_ma_async_destroy(void **async);
+
+/**
+ * Pushes buffer_size samples to be processed by the worker thread and pops the outputs of the buffer pushed depth calls
+ * earlier, with the same arguments as dwm_ma_process_trajectory
+ * @param async valid front-end handle
+ * @param in_buffers samples introduced by each input (dimensionality in_count x buffer_size)
+ * @param in_positions_start_m metric positions of each input at the buffer's first sample (dimensionality in_count x 3)
+ * @param in_positions_end_m metric positions of each input at the next buffer's first sample (dimensionality
+ * in_count x 3)
+ * @param in_count amount of inputs processed (no more than DWM_MA_MAX_INPUT_COUNT)
+ * @param ma_config microphone array configuration used
+ * @param ma_scale microphone array scale
+ * @param ma_buffers samples outputted by each channel (dimensionality out_count x buffer_size)
+ * @param ma_position_start_m microphone array's center position at the buffer's first sample (dimensionality 1 x 3)
+ * @param ma_position_end_m microphone array's center position at the next buffer's first sample (dimensionality 1 x 3)
+ * @return 0 if ma_buffers hold processed samples or one of the first depth calls' silence, non-zero on an underrun
+ * @details On an underrun, that is when the worker thread has not yet finished the buffer to be popped, ma_buffers are
+ * silenced and that buffer's outputs are discarded once finished, keeping the latency constant. If the worker thread
+ * is so late that the ring is full, the pushed buffer is dropped as well and never reaches the mesh
+ * @note Wait-free apart from a non-blocking wake-up system call when the worker thread sleeps, thus it may be called
+ * from a real-time thread
+ */
+int dwm_ma_async_process(void *async, const float *const *in_buffers, const float *const *in_positions_start_m,
+                         const float *const *in_positions_end_m, int in_count, MA_CONFIG ma_config, float ma_scale,
+                         float *const *ma_buffers, const float *ma_position_start_m, const float *ma_position_end_m);
+
+/**
+ * Amount of underruns of a front-end
+ * @param async valid front-end handle
+ * @return the amount of dwm_ma_async_process calls which silenced their outputs because of the worker thread
+ */
+uint64_t dwm_ma_async_get_underrun_count(const void *async);
+
+/**
+ * Amount of dropped buffers of a front-end
+ * @param async valid front-end handle
+ * @return the amount of dwm_ma_async_process calls whose inputs never reached the mesh because the ring was full
+ */
+uint64_t dwm_ma_async_get_dropped_count(const void *async);
+
+#endif
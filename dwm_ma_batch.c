@@ -0,0 +1,344 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "dwm_ma_batch.h"
+#include "dwm_ma_internal.h"
+#include "dwm_ma_simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Internal structs and functions declarations
+
+/**
+ * Internal group of DWM_MA_BATCH_LANES instances: every junction value is stored as DWM_MA_BATCH_LANES contiguous lane
+ * values, and each boundary filter state is stored as three arrays (t1, t2 and t3) of interleaved lane values
+ */
+typedef struct {
+    float *p, *p_aux;
+    float *b_state[6][3];
+    float b_params[6][2][DWM_MA_BATCH_LANES];
+} dwm_ma_batch_group_t;
+
+/**
+ * Internal dwm-ma batch implementation, faces are always ordered as [Z-,Y-,X-,X+,Y+,Z+]
+ */
+typedef struct {
+    int size_x_j, size_y_j, size_z_j;
+    int buffer_size;
+    float metric_2_junction, junction_2_metric;
+    float size_m[3];
+    int instance_count, group_count;
+    dwm_ma_batch_group_t *groups;
+    dwm_ma_row_kernel_t row_kernel;
+} dwm_ma_batch_t;
+
+/**
+ * Writes a value to a single lane using pre-computed interpolation parameters
+ */
+static void write_lane_interp_params(float *p, int lane, float value, const float interp_percents[3],
+                                     const int interp_indices[2][2][2]);
+
+/**
+ * Reads a value from a single lane using pre-computed interpolation parameters
+ */
+static float read_lane_interp_params(const float *p, int lane, const float interp_percents[3],
+                                     const int interp_indices[2][2][2]);
+
+/**
+ * Progress the simulation state of a group by one step on the whole mesh
+ */
+static void process_group_iteration(const dwm_ma_batch_t *batch, dwm_ma_batch_group_t *group);
+
+/**
+ * Progress the simulation state of a group by one step on a single junction, handling any boundary the junction lies on
+ */
+static void process_group_junction(const dwm_ma_batch_t *batch, dwm_ma_batch_group_t *group, int x_j, int y_j,
+                                   int z_j);
+
+/**
+ * Progress all lanes of a boundary's simulation state by one step and filter their input samples
+ * @param group group handle
+ * @param face boundary face
+ * @param i_face junction index inside the face
+ * @param in input lane samples
+ * @param out filtered lane samples
+ * @return out
+ */
+static const float *process_group_boundary(dwm_ma_batch_group_t *group, int face, int i_face,
+                                           const float *restrict in, float *restrict out);
+
+// Function definitions
+
+int dwm_ma_batch_create(void **batch, const dwm_ma_mesh_config *config, const int instance_count) {
+    if (config->sample_rate < 1 || config->buffer_size < 1 || config->size_x_j < 3 || config->size_y_j < 3 ||
+        config->size_z_j < 3 || !(config->sound_propagation_speed >= 1) || config->storage != DWM_MA_STORAGE_FLOAT32 ||
+        config->topology != DWM_MA_TOPOLOGY_RECTILINEAR || instance_count < 1) {
+        *batch = NULL;
+        return 1;
+    }
+
+    // Store the mesh geometry, with the same metric conversions as dwm_ma_create_ex
+    dwm_ma_batch_t *handle = malloc(sizeof(dwm_ma_batch_t));
+    if (handle == NULL) {
+        *batch = NULL;
+        return 1;
+    }
+    handle->size_x_j = config->size_x_j;
+    handle->size_y_j = config->size_y_j;
+    handle->size_z_j = config->size_z_j;
+    handle->buffer_size = config->buffer_size;
+    handle->metric_2_junction = (float) config->sample_rate / (_DWM_MA_SQRT_3F * config->sound_propagation_speed);
+    handle->junction_2_metric = _DWM_MA_SQRT_3F * config->sound_propagation_speed / (float) config->sample_rate;
+    handle->size_m[0] = (float) handle->size_x_j * handle->junction_2_metric;
+    handle->size_m[1] = (float) handle->size_y_j * handle->junction_2_metric;
+    handle->size_m[2] = (float) handle->size_z_j * handle->junction_2_metric;
+    handle->instance_count = instance_count;
+    handle->group_count = (instance_count + DWM_MA_BATCH_LANES - 1) / DWM_MA_BATCH_LANES;
+    handle->row_kernel = dwm_ma_simd_select_row_kernel();
+
+    // Allocate all resources zeroed, so that the lanes left unused by the last group stay silent
+    const size_t junction_count = (size_t) handle->size_x_j * handle->size_y_j * handle->size_z_j;
+    handle->groups = calloc(handle->group_count, sizeof(dwm_ma_batch_group_t));
+    if (handle->groups == NULL) {
+        free(handle);
+        *batch = NULL;
+        return 1;
+    }
+    int failed = 0;
+    for (int g = 0; g < handle->group_count; g++) {
+        dwm_ma_batch_group_t *group = &handle->groups[g];
+        group->p = calloc(junction_count * DWM_MA_BATCH_LANES, sizeof(float));
+        group->p_aux = calloc(junction_count * DWM_MA_BATCH_LANES, sizeof(float));
+        for (int f = 0; f < 6; f++) {
+            for (int t = 0; t < 3; t++) {
+                const int n = dwm_ma_face_size_j(handle->size_x_j, handle->size_y_j, handle->size_z_j, f);
+                group->b_state[f][t] = calloc((size_t) n * DWM_MA_BATCH_LANES, sizeof(float));
+                failed |= group->b_state[f][t] == NULL;
+            }
+        }
+        failed |= group->p == NULL || group->p_aux == NULL;
+    }
+    if (failed) {
+        dwm_ma_batch_destroy((void **) &handle);
+        *batch = NULL;
+        return 1;
+    }
+    *batch = handle;
+    return 0;
+}
+
+void dwm_ma_batch_destroy(void **batch) {
+    dwm_ma_batch_t *handle = *batch;
+
+    // Free all resources
+    for (int g = 0; g < handle->group_count; g++) {
+        free(handle->groups[g].p);
+        free(handle->groups[g].p_aux);
+        for (int f = 0; f < 6; f++) {
+            for (int t = 0; t < 3; t++) {
+                free(handle->groups[g].b_state[f][t]);
+            }
+        }
+    }
+    free(handle->groups);
+    free(handle);
+    *batch = NULL;
+}
+
+int dwm_ma_batch_init(void *batch, const int instance, const float dwm_bound_params[6][2],
+                      const int dwm_bound_params_normalized) {
+    dwm_ma_batch_t *handle = batch;
+    if (instance < 0 || instance >= handle->instance_count) {
+        return 1;
+    }
+    dwm_ma_batch_group_t *group = &handle->groups[instance / DWM_MA_BATCH_LANES];
+    const int lane = instance % DWM_MA_BATCH_LANES;
+
+    // Set the instance's lane of every junction and boundary filter to the initial state
+    const int junction_count = handle->size_x_j * handle->size_y_j * handle->size_z_j;
+    for (int i = 0; i < junction_count; i++) {
+        group->p[i * DWM_MA_BATCH_LANES + lane] = 0.0f;
+        group->p_aux[i * DWM_MA_BATCH_LANES + lane] = 0.0f;
+    }
+    for (int f = 0; f < 6; f++) {
+        const int n = dwm_ma_face_size_j(handle->size_x_j, handle->size_y_j, handle->size_z_j, f);
+        for (int t = 0; t < 3; t++) {
+            for (int i = 0; i < n; i++) {
+                group->b_state[f][t][i * DWM_MA_BATCH_LANES + lane] = 0.0f;
+            }
+        }
+    }
+
+    // Handle the boundary parameters, as in dwm_ma_init
+    for (int f = 0; f < 6; f++) {
+        if (dwm_bound_params_normalized != 0) {
+            group->b_params[f][0][lane] = (1 - dwm_bound_params[f][1]) * 0.25f * dwm_bound_params[f][0];
+            group->b_params[f][1][lane] = dwm_bound_params[f][0] * (1 - (1 - dwm_bound_params[f][1]) * 0.5f);
+        } else {
+            group->b_params[f][0][lane] = dwm_bound_params[f][0];
+            group->b_params[f][1][lane] = dwm_bound_params[f][1];
+        }
+    }
+    return 0;
+}
+
+void dwm_ma_batch_process_interpolated(void *batch, const dwm_ma_batch_io *io) {
+    dwm_ma_batch_t *handle = batch;
+
+    for (int g = 0; g < handle->group_count; g++) {
+        dwm_ma_batch_group_t *group = &handle->groups[g];
+        const int lane_count = mini(DWM_MA_BATCH_LANES, handle->instance_count - g * DWM_MA_BATCH_LANES);
+        const dwm_ma_batch_io *lane_io = &io[g * DWM_MA_BATCH_LANES];
+
+        // Preprocess each lane's interpolation parameters as dwm_ma_process_interpolated does
+        int in_counts[DWM_MA_BATCH_LANES];
+        const ma_layout *layouts[DWM_MA_BATCH_LANES];
+        float input_int_percents[DWM_MA_BATCH_LANES][DWM_MA_MAX_INPUT_COUNT][3];
+        int input_int_indices[DWM_MA_BATCH_LANES][DWM_MA_MAX_INPUT_COUNT][2][2][2];
+        float output_int_percents[DWM_MA_BATCH_LANES][DWM_MA_MAX_OUTPUT_COUNT][3];
+        int output_int_indices[DWM_MA_BATCH_LANES][DWM_MA_MAX_OUTPUT_COUNT][2][2][2];
+        for (int l = 0; l < lane_count; l++) {
+            const float ma_scale = fclampf(lane_io[l].ma_scale, 1.0f, 10.0f);
+            in_counts[l] = clampi(lane_io[l].in_count, 0, DWM_MA_MAX_INPUT_COUNT);
+            for (int i = 0; i < in_counts[l]; i++) {
+                const float *pos_m = lane_io[l].in_positions_m[i];
+                dwm_ma_compute_interpolation_parameters_j(
+                        handle->size_x_j, handle->size_y_j, handle->size_z_j,
+                        pos_m[0] * handle->metric_2_junction - 0.5f, pos_m[1] * handle->metric_2_junction - 0.5f,
+                        pos_m[2] * handle->metric_2_junction - 0.5f, input_int_percents[l][i], input_int_indices[l][i]);
+            }
+
+            layouts[l] = ma_config_layout(lane_io[l].ma_config);
+            const float ma_radius_m =
+                    layouts[l]->radius_m * (handle->junction_2_metric / DWM_MA_SIZE_JUNCTION_M) * ma_scale;
+            float ma_position_m_restricted[3];
+            for (int a = 0; a < 3; a++) {
+                ma_position_m_restricted[a] =
+                        fclampf(lane_io[l].ma_position_m[a], ma_radius_m, handle->size_m[a] - ma_radius_m);
+            }
+            for (int i = 0; i < layouts[l]->channel_count; i++) {
+                float pos_j[3];
+                for (int a = 0; a < 3; a++) {
+                    pos_j[a] = (float) layouts[l]->mic_rel_xyz_j[i][a] * ma_scale +
+                               ma_position_m_restricted[a] * handle->metric_2_junction - 0.5f;
+                }
+                dwm_ma_compute_interpolation_parameters_j(handle->size_x_j, handle->size_y_j, handle->size_z_j,
+                                                          pos_j[0], pos_j[1], pos_j[2], output_int_percents[l][i],
+                                                          output_int_indices[l][i]);
+            }
+        }
+
+        // Run buffer_size simulation iterations on the whole group
+        for (int n = 0; n < handle->buffer_size; n++) {
+            for (int l = 0; l < lane_count; l++) {
+                for (int i = 0; i < in_counts[l]; i++) {
+                    write_lane_interp_params(group->p, l, lane_io[l].in_buffers[i][n], input_int_percents[l][i],
+                                             input_int_indices[l][i]);
+                }
+            }
+            process_group_iteration(handle, group);
+            for (int l = 0; l < lane_count; l++) {
+                for (int i = 0; i < layouts[l]->channel_count; i++) {
+                    lane_io[l].ma_buffers[i][n] = read_lane_interp_params(group->p_aux, l, output_int_percents[l][i],
+                                                                          output_int_indices[l][i]);
+                }
+            }
+            float *aux = group->p; // Post iteration buffer swapping
+            group->p = group->p_aux;
+            group->p_aux = aux;
+        }
+    }
+}
+
+void write_lane_interp_params(float *p, const int lane, const float value, const float interp_percents[3],
+                              const int interp_indices[2][2][2]) {
+    // Same junction order and weights as the dwm-ma interpolated write
+    for (int z_i = 0; z_i < 2; z_i++) {
+        for (int y_i = 0; y_i < 2; y_i++) {
+            for (int x_i = 0; x_i < 2; x_i++) {
+                float *v = &p[interp_indices[x_i][y_i][z_i] * DWM_MA_BATCH_LANES + lane];
+                *v = flerpf(*v, value,
+                            (x_i ? interp_percents[0] : 1 - interp_percents[0]) *
+                                    (y_i ? interp_percents[1] : 1 - interp_percents[1]) *
+                                    (z_i ? interp_percents[2] : 1 - interp_percents[2]));
+            }
+        }
+    }
+}
+
+float read_lane_interp_params(const float *p, const int lane, const float interp_percents[3],
+                              const int interp_indices[2][2][2]) {
+#define V(X, Y, Z) p[interp_indices[X][Y][Z] * DWM_MA_BATCH_LANES + lane]
+    return flerpf(flerpf(flerpf(V(0, 0, 0), V(1, 0, 0), interp_percents[0]),
+                         flerpf(V(0, 1, 0), V(1, 1, 0), interp_percents[0]), interp_percents[1]),
+                  flerpf(flerpf(V(0, 0, 1), V(1, 0, 1), interp_percents[0]),
+                         flerpf(V(0, 1, 1), V(1, 1, 1), interp_percents[0]), interp_percents[1]),
+                  interp_percents[2]);
+#undef V
+}
+
+void process_group_iteration(const dwm_ma_batch_t *batch, dwm_ma_batch_group_t *group) {
+    // Same traversal as the dwm-ma slab update: with interleaved lanes, the interior of an X row is a contiguous run of
+    // (size_x_j - 2) x DWM_MA_BATCH_LANES values, which the row kernel updates with DWM_MA_BATCH_LANES sized strides
+    const int size_x_j = batch->size_x_j, size_y_j = batch->size_y_j, size_z_j = batch->size_z_j;
+    for (int z = 0; z < size_z_j; z++) {
+        for (int y = 0; y < size_y_j; y++) {
+            if (z == 0 || z == size_z_j - 1 || y == 0 || y == size_y_j - 1) {
+                for (int x = 0; x < size_x_j; x++) {
+                    process_group_junction(batch, group, x, y, z);
+                }
+            } else {
+                const int i = ((z * size_y_j + y) * size_x_j + 1) * DWM_MA_BATCH_LANES;
+                process_group_junction(batch, group, 0, y, z);
+                batch->row_kernel(&group->p_aux[i], &group->p[i], (size_x_j - 2) * DWM_MA_BATCH_LANES,
+                                  DWM_MA_BATCH_LANES, size_x_j * DWM_MA_BATCH_LANES,
+                                  size_x_j * size_y_j * DWM_MA_BATCH_LANES);
+                process_group_junction(batch, group, size_x_j - 1, y, z);
+            }
+        }
+    }
+}
+
+void process_group_junction(const dwm_ma_batch_t *batch, dwm_ma_batch_group_t *group, const int x_j, const int y_j,
+                            const int z_j) {
+    const int size_x_j = batch->size_x_j, size_y_j = batch->size_y_j, size_z_j = batch->size_z_j;
+    const int stride_y = size_x_j * DWM_MA_BATCH_LANES, stride_z = size_x_j * size_y_j * DWM_MA_BATCH_LANES;
+    const int i = ((z_j * size_y_j + y_j) * size_x_j + x_j) * DWM_MA_BATCH_LANES;
+    const float *p = &group->p[i];
+    float filtered[6][DWM_MA_BATCH_LANES];
+
+    // Neighbour lane values, in the [Z-,Y-,X-,X+,Y+,Z+] summation order of the dwm-ma junction update
+    const float *n[6];
+    n[0] = z_j == 0 ? process_group_boundary(group, 0, y_j * size_x_j + x_j, p, filtered[0]) : p - stride_z;
+    n[1] = y_j == 0 ? process_group_boundary(group, 1, z_j * size_x_j + x_j, p, filtered[1]) : p - stride_y;
+    n[2] = x_j == 0 ? process_group_boundary(group, 2, z_j * size_y_j + y_j, p, filtered[2]) : p - DWM_MA_BATCH_LANES;
+    n[3] = x_j == size_x_j - 1 ? process_group_boundary(group, 3, z_j * size_y_j + y_j, p, filtered[3])
+                               : p + DWM_MA_BATCH_LANES;
+    n[4] = y_j == size_y_j - 1 ? process_group_boundary(group, 4, z_j * size_x_j + x_j, p, filtered[4]) : p + stride_y;
+    n[5] = z_j == size_z_j - 1 ? process_group_boundary(group, 5, y_j * size_x_j + x_j, p, filtered[5]) : p + stride_z;
+
+    const float *restrict zn = n[0], *restrict yn = n[1], *restrict xn = n[2];
+    const float *restrict xp = n[3], *restrict yp = n[4], *restrict zp = n[5];
+    float *restrict p_aux = &group->p_aux[i];
+    for (int l = 0; l < DWM_MA_BATCH_LANES; l++) {
+        p_aux[l] = (zn[l] + yn[l] + xn[l] + xp[l] + yp[l] + zp[l]) / 3.0f - p_aux[l];
+    }
+}
+
+const float *process_group_boundary(dwm_ma_batch_group_t *group, const int face, const int i_face,
+                                    const float *restrict in, float *restrict out) {
+    float *restrict t1 = &group->b_state[face][0][i_face * DWM_MA_BATCH_LANES];
+    float *restrict t2 = &group->b_state[face][1][i_face * DWM_MA_BATCH_LANES];
+    float *restrict t3 = &group->b_state[face][2][i_face * DWM_MA_BATCH_LANES];
+    const float *restrict r1 = group->b_params[face][0], *restrict r2 = group->b_params[face][1];
+    for (int l = 0; l < DWM_MA_BATCH_LANES; l++) {
+        const float aux = in[l] - t1[l];
+        out[l] = r1[l] * (aux + t3[l]) + (1 + r2[l]) * t2[l];
+        t3[l] = t2[l];
+        t1[l] = out[l] - t2[l];
+        t2[l] = aux;
+    }
+    return out;
+}
@@ -0,0 +1,85 @@
+#ifndef DWM_MA_BATCH_H
+#define DWM_MA_BATCH_H
+
+#include "dwm_ma.h"
+
+#ifndef DWM_MA_BATCH_LANES
+/**
+ * Amount of dwm-ma instances stored interleaved and advanced together by each SIMD stencil sweep
+ */
+#define DWM_MA_BATCH_LANES 8
+#endif
+
+/**
+ * Per instance processing parameters of a batch, with the same meaning as the dwm_ma_process_interpolated arguments
+ */
+typedef struct {
+    /**
+     * Samples introduced by each input (dimensionality in_count x buffer_size)
+     */
+    const float *const *in_buffers;
+    /**
+     * Metric positions of each input (dimensionality in_count x 3)
+     */
+    const float *const *in_positions_m;
+    /**
+     * Amount of inputs processed (no more than DWM_MA_MAX_INPUT_COUNT)
+     */
+    int in_count;
+    /**
+     * Microphone array configuration used
+     * @remark Batches have no custom layouts, MA_CONFIG_CUSTOM results in MA_CONFIG_MONO being used
+     */
+    MA_CONFIG ma_config;
+    /**
+     * Microphone array scale
+     */
+    float ma_scale;
+    /**
+     * Samples outputted by each microphone (dimensionality ma_config->channel_count x buffer_size)
+     */
+    float *const *ma_buffers;
+    /**
+     * Microphone array's center position (dimensionality 1 x 3)
+     */
+    const float *ma_position_m;
+} dwm_ma_batch_io;
+
+/**
+ * Creates a new batch of independent, same-sized dwm-ma instances
+ * @param batch address of batch handle
+ * @param config mesh configuration shared by all instances
+ * @param instance_count amount of instances in the batch
+ * @return 0 on success, non-zero if the configuration or the instance count are not valid or the batch cannot be
+ * allocated (the handle is then set to NULL)
+ * @details Instances are stored in groups of DWM_MA_BATCH_LANES, interleaved junction by junction, so that a single
+ * stencil sweep advances a whole group and every junction update is a SIMD operation across instances
+ * @note Only DWM_MA_STORAGE_FLOAT32 storage and DWM_MA_TOPOLOGY_RECTILINEAR topology are supported
+ */
+int dwm_ma_batch_create(void **batch, const dwm_ma_mesh_config *config, int instance_count);
+
+/**
+ * Destroys a batch
+ * @param batch address of a valid batch handle
+ */
+void dwm_ma_batch_destroy(void **batch);
+
+/**
+ * Initializes a single instance of a batch to the initial state, see dwm_ma_init
+ * @param batch valid batch handle
+ * @param instance index of the instance to be initialized
+ * @param dwm_bound_params dwm boundary parameters, in order [Z-,Y-,X-,X+,Y+,Z+]
+ * @param dwm_bound_params_normalized controls how dwm_bound_params are interpreted, as in dwm_ma_init
+ * @return 0 on success, non-zero if the instance index is not in [0, instance_count - 1] (nothing is then initialized)
+ */
+int dwm_ma_batch_init(void *batch, int instance, const float dwm_bound_params[6][2], int dwm_bound_params_normalized);
+
+/**
+ * Processes buffer_size samples inside every instance of a batch, with dwm coordinates expressed in metric units
+ * @param batch valid batch handle
+ * @param io processing parameters of each instance (dimensionality instance_count)
+ * @note Each instance produces exactly the output a dwm-ma instance would produce with dwm_ma_process_interpolated
+ */
+void dwm_ma_batch_process_interpolated(void *batch, const dwm_ma_batch_io *io);
+
+#endif
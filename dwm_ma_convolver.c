@@ -0,0 +1,369 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "dwm_ma_convolver.h"
+#include "dwm_ma_internal.h"
+#include "dwm_ma_simd.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PI 3.141592653589793
+
+// Internal structs and functions declarations
+
+/**
+ * Internal convolver implementation
+ * @details Spectra only keep the bin_count = fft_size / 2 + 1 bins of a real signal, as split real and imaginary
+ * arrays. frames holds the last fft_size samples of each input, delay_line the spectra of each input's last
+ * partition_count frames (a ring whose newest entry is at position), and responses the spectra of the partitions of
+ * each input and output pair, indexed as [in][partition] and [in][out][partition] respectively. fill counts the samples
+ * of the current block processed so far, and tails holds each output's contribution of the partitions past the first
+ * to the current block while it is processed in parts
+ */
+typedef struct {
+    dwm_ma_cmac_kernel_t cmac_kernel;
+    int block_size, fft_size, bin_count;
+    int rir_length, partition_count;
+    int in_count, out_count;
+    int position, fill;
+    float *cos_table, *sin_table;
+    int *bit_reversal;
+    float *frames;
+    float *delay_line_re, *delay_line_im;
+    float *responses_re, *responses_im;
+    float *acc_re, *acc_im;
+    float *work_re, *work_im;
+    float *tails;
+} dwm_ma_convolver_t;
+
+/**
+ * In-place iterative radix-2 complex FFT over split real and imaginary arrays
+ * @param handle convolver handle, holding the twiddle factors and the bit reversal permutation
+ * @param re real parts (dimensionality fft_size)
+ * @param im imaginary parts (dimensionality fft_size)
+ * @param inverse non-zero for the (unscaled) inverse transform
+ */
+static void fft(const dwm_ma_convolver_t *handle, float *re, float *im, int inverse);
+
+/**
+ * Transforms two real signals, zero-padded to fft_size samples, with a single complex FFT, storing their bin_count bins
+ * @param handle convolver handle
+ * @param x1 first signal
+ * @param count1 amount of samples of the first signal
+ * @param x2 second signal, or NULL if there is none
+ * @param count2 amount of samples of the second signal
+ * @param re1 resulting real parts of the first signal
+ * @param im1 resulting imaginary parts of the first signal
+ * @param re2 resulting real parts of the second signal, unused if x2 is NULL
+ * @param im2 resulting imaginary parts of the second signal, unused if x2 is NULL
+ */
+static void forward_pair(dwm_ma_convolver_t *handle, const float *x1, int count1, const float *x2, int count2,
+                         float *re1, float *im1, float *re2, float *im2);
+
+/**
+ * Convolves the part of a block that follows its first fill samples
+ * @param handle convolver handle
+ * @param in_buffers samples of each input, or NULL for silent inputs
+ * @param out_buffers samples of each output
+ * @param offset index of the part's first sample in in_buffers and out_buffers
+ * @param frame_count amount of samples of the part, no more than block_size - fill
+ * @param out_count amount of outputs written
+ * @param accumulate non-zero to add the outputs to out_buffers instead of overwriting them
+ */
+static void process_part(dwm_ma_convolver_t *handle, const float *const *in_buffers, float *const *out_buffers,
+                         int offset, int frame_count, int out_count, int accumulate);
+
+/**
+ * Sums the products of the delay line and the responses of a range of partitions for one or two outputs, and transforms
+ * them back into the real and imaginary parts of work_re and work_im (unscaled)
+ * @param handle convolver handle
+ * @param o index of the first output
+ * @param pair_count amount of outputs, 1 or 2
+ * @param partition_begin first partition
+ * @param partition_end partition past the last one
+ */
+static void inverse_pair(dwm_ma_convolver_t *handle, int o, int pair_count, int partition_begin, int partition_end);
+
+// Function definitions
+
+int dwm_ma_convolver_create(void **convolver, const int block_size, const int rir_length, const int in_count,
+                            const int out_count) {
+    *convolver = NULL;
+    if (block_size < 1 || rir_length < 1 || in_count < 1 || out_count < 1) {
+        return 1;
+    }
+    int fft_size = 2;
+    while (fft_size < 2 * block_size) {
+        fft_size *= 2;
+    }
+    const int bin_count = fft_size / 2 + 1;
+    const int partition_count = (rir_length + block_size - 1) / block_size;
+    const size_t delay_line_size = (size_t) in_count * partition_count * bin_count;
+    const size_t responses_size = delay_line_size * out_count;
+    dwm_ma_convolver_t *handle = malloc(sizeof(dwm_ma_convolver_t));
+    if (handle == NULL) {
+        return 1;
+    }
+    handle->cmac_kernel = dwm_ma_simd_select_cmac_kernel();
+    handle->block_size = block_size;
+    handle->fft_size = fft_size;
+    handle->bin_count = bin_count;
+    handle->rir_length = rir_length;
+    handle->partition_count = partition_count;
+    handle->in_count = in_count;
+    handle->out_count = out_count;
+    handle->position = 0;
+    handle->cos_table = malloc(sizeof(float) * fft_size / 2);
+    handle->sin_table = malloc(sizeof(float) * fft_size / 2);
+    handle->bit_reversal = malloc(sizeof(int) * fft_size);
+    handle->frames = malloc(sizeof(float) * in_count * fft_size);
+    handle->delay_line_re = malloc(sizeof(float) * delay_line_size);
+    handle->delay_line_im = malloc(sizeof(float) * delay_line_size);
+    handle->responses_re = calloc(responses_size, sizeof(float));
+    handle->responses_im = calloc(responses_size, sizeof(float));
+    handle->acc_re = malloc(sizeof(float) * 2 * bin_count);
+    handle->acc_im = malloc(sizeof(float) * 2 * bin_count);
+    handle->work_re = malloc(sizeof(float) * fft_size);
+    handle->work_im = malloc(sizeof(float) * fft_size);
+    handle->tails = malloc(sizeof(float) * out_count * block_size);
+    if (handle->cos_table == NULL || handle->sin_table == NULL || handle->bit_reversal == NULL ||
+        handle->frames == NULL || handle->delay_line_re == NULL || handle->delay_line_im == NULL ||
+        handle->responses_re == NULL || handle->responses_im == NULL || handle->acc_re == NULL ||
+        handle->acc_im == NULL || handle->work_re == NULL || handle->work_im == NULL ||
+        handle->tails == NULL) {
+        dwm_ma_convolver_destroy((void **) &handle);
+        return 1;
+    }
+
+    // Twiddle factors exp(-2 pi i k / fft_size) and the bit reversal permutation of the FFT
+    for (int k = 0; k < fft_size / 2; k++) {
+        handle->cos_table[k] = (float) cos(2.0 * PI * k / fft_size);
+        handle->sin_table[k] = (float) -sin(2.0 * PI * k / fft_size);
+    }
+    int bits = 0;
+    while ((1 << bits) < fft_size) {
+        bits++;
+    }
+    for (int k = 0; k < fft_size; k++) {
+        int reversed = 0;
+        for (int b = 0; b < bits; b++) {
+            reversed |= ((k >> b) & 1) << (bits - 1 - b);
+        }
+        handle->bit_reversal[k] = reversed;
+    }
+    dwm_ma_convolver_reset(handle);
+    *convolver = handle;
+    return 0;
+}
+
+void dwm_ma_convolver_destroy(void **convolver) {
+    dwm_ma_convolver_t *handle = *convolver;
+    free(handle->cos_table);
+    free(handle->sin_table);
+    free(handle->bit_reversal);
+    free(handle->frames);
+    free(handle->delay_line_re);
+    free(handle->delay_line_im);
+    free(handle->responses_re);
+    free(handle->responses_im);
+    free(handle->acc_re);
+    free(handle->acc_im);
+    free(handle->work_re);
+    free(handle->work_im);
+    free(handle->tails);
+    free(handle);
+    *convolver = NULL;
+}
+
+void dwm_ma_convolver_set_response(void *convolver, const int in, const int out, const float *rir) {
+    dwm_ma_convolver_t *handle = convolver;
+    const int block_size = handle->block_size, bin_count = handle->bin_count;
+    const size_t pair = ((size_t) in * handle->out_count + out) * handle->partition_count;
+
+    // Partitions are zero-padded to fft_size samples and transformed two at a time, the last one being possibly
+    // shorter and without a partner
+    for (int p = 0; p < handle->partition_count; p += 2) {
+        const int count1 = mini(block_size, handle->rir_length - p * block_size);
+        const int count2 = p + 1 < handle->partition_count ? mini(block_size, handle->rir_length - (p + 1) * block_size)
+                                                           : 0;
+        float *re = handle->responses_re + (pair + p) * bin_count, *im = handle->responses_im + (pair + p) * bin_count;
+        forward_pair(handle, rir + p * block_size, count1, count2 > 0 ? rir + (p + 1) * block_size : NULL, count2, re,
+                     im, re + bin_count, im + bin_count);
+    }
+}
+
+void dwm_ma_convolver_reset(void *convolver) {
+    dwm_ma_convolver_t *handle = convolver;
+    const size_t delay_line_size = (size_t) handle->in_count * handle->partition_count * handle->bin_count;
+    memset(handle->frames, 0, sizeof(float) * handle->in_count * handle->fft_size);
+    memset(handle->delay_line_re, 0, sizeof(float) * delay_line_size);
+    memset(handle->delay_line_im, 0, sizeof(float) * delay_line_size);
+    handle->position = 0;
+    handle->fill = 0;
+}
+
+void dwm_ma_convolver_process(void *convolver, const float *const *in_buffers, float *const *out_buffers,
+                              const int frame_count, const int out_count, const int accumulate) {
+    dwm_ma_convolver_t *handle = convolver;
+    for (int offset = 0; offset < frame_count;) {
+        const int count = mini(frame_count - offset, handle->block_size - handle->fill);
+        process_part(handle, in_buffers, out_buffers, offset, count, out_count, accumulate);
+        offset += count;
+    }
+}
+
+void process_part(dwm_ma_convolver_t *handle, const float *const *in_buffers, float *const *out_buffers,
+                  const int offset, const int frame_count, const int out_count, const int accumulate) {
+    const int block_size = handle->block_size, fft_size = handle->fft_size;
+    const int partition_count = handle->partition_count, in_count = handle->in_count;
+    const int fill = handle->fill;
+
+    // A block's first samples shift the frames and take the next position of the delay line, the newest spectra going
+    // one position back so that delay p is found at position + p; the samples the block does not have yet stay silent
+    if (fill == 0) {
+        handle->position = (handle->position + partition_count - 1) % partition_count;
+        for (int i = 0; i < in_count; i++) {
+            float *frame = handle->frames + i * fft_size;
+            memmove(frame, frame + block_size, sizeof(float) * (fft_size - block_size));
+            memset(frame + fft_size - block_size, 0, sizeof(float) * block_size);
+        }
+    }
+    for (int i = 0; i < in_count && in_buffers != NULL; i++) {
+        memcpy(handle->frames + i * fft_size + fft_size - block_size + fill, in_buffers[i] + offset,
+               sizeof(float) * frame_count);
+    }
+    for (int i = 0; i < in_count; i += 2) {
+        const size_t slot = ((size_t) i * partition_count + handle->position) * handle->bin_count;
+        const size_t next_slot = slot + (size_t) partition_count * handle->bin_count;
+        forward_pair(handle, handle->frames + i * fft_size, fft_size,
+                     i + 1 < in_count ? handle->frames + (i + 1) * fft_size : NULL, i + 1 < in_count ? fft_size : 0,
+                     handle->delay_line_re + slot, handle->delay_line_im + slot, handle->delay_line_re + next_slot,
+                     handle->delay_line_im + next_slot);
+    }
+
+    // The partitions past the first only read previous blocks, thus a partial block renders their sum once for all its
+    // samples, each call then only adding the first partition's
+    const int partial = fill > 0 || frame_count < block_size;
+    const float scale = 1.0f / (float) fft_size;
+    if (partial && fill == 0) {
+        for (int o = 0; o < handle->out_count; o += 2) {
+            const int pair_count = o + 1 < handle->out_count ? 2 : 1;
+            inverse_pair(handle, o, pair_count, 1, partition_count);
+            for (int j = 0; j < pair_count; j++) {
+                const float *y = (j == 0 ? handle->work_re : handle->work_im) + fft_size - block_size;
+                float *tail = handle->tails + (size_t) (o + j) * block_size;
+                for (int n = 0; n < block_size; n++) {
+                    tail[n] = y[n] * scale;
+                }
+            }
+        }
+    }
+    for (int o = 0; o < out_count; o += 2) {
+        const int pair_count = o + 1 < out_count ? 2 : 1;
+        inverse_pair(handle, o, pair_count, 0, partial ? 1 : partition_count);
+
+        // Only the last block_size samples are free of circular aliasing
+        for (int j = 0; j < pair_count; j++) {
+            const float *y = (j == 0 ? handle->work_re : handle->work_im) + fft_size - block_size + fill;
+            const float *tail = handle->tails + (size_t) (o + j) * block_size + fill;
+            float *out = out_buffers[o + j] + offset;
+            for (int n = 0; n < frame_count; n++) {
+                const float value = partial ? tail[n] + y[n] * scale : y[n] * scale;
+                out[n] = accumulate ? out[n] + value : value;
+            }
+        }
+    }
+    handle->fill = (fill + frame_count) % block_size;
+}
+
+void inverse_pair(dwm_ma_convolver_t *handle, const int o, const int pair_count, const int partition_begin,
+                  const int partition_end) {
+    const int fft_size = handle->fft_size, bin_count = handle->bin_count;
+    const int partition_count = handle->partition_count;
+    memset(handle->acc_re, 0, sizeof(float) * 2 * bin_count);
+    memset(handle->acc_im, 0, sizeof(float) * 2 * bin_count);
+    for (int i = 0; i < handle->in_count; i++) {
+        for (int p = partition_begin; p < partition_end; p++) {
+            const size_t slot = ((size_t) i * partition_count + (handle->position + p) % partition_count) * bin_count;
+            for (int j = 0; j < pair_count; j++) {
+                const size_t partition = (((size_t) i * handle->out_count + o + j) * partition_count + p) * bin_count;
+                handle->cmac_kernel(handle->acc_re + j * bin_count, handle->acc_im + j * bin_count,
+                                    handle->delay_line_re + slot, handle->delay_line_im + slot,
+                                    handle->responses_re + partition, handle->responses_im + partition, bin_count);
+            }
+        }
+    }
+
+    // Rebuild the full spectrum of y1 + i * y2 from the Hermitian symmetry of both outputs, the second being silent
+    // without a partner
+    const float *y1_re = handle->acc_re, *y1_im = handle->acc_im;
+    const float *y2_re = handle->acc_re + bin_count, *y2_im = handle->acc_im + bin_count;
+    for (int k = 0; k < bin_count; k++) {
+        handle->work_re[k] = y1_re[k] - y2_im[k];
+        handle->work_im[k] = y1_im[k] + y2_re[k];
+    }
+    for (int k = bin_count; k < fft_size; k++) {
+        const int j = fft_size - k;
+        handle->work_re[k] = y1_re[j] + y2_im[j];
+        handle->work_im[k] = y2_re[j] - y1_im[j];
+    }
+    fft(handle, handle->work_re, handle->work_im, 1);
+}
+
+void fft(const dwm_ma_convolver_t *handle, float *re, float *im, const int inverse) {
+    const int n = handle->fft_size;
+    for (int k = 0; k < n; k++) {
+        const int j = handle->bit_reversal[k];
+        if (j > k) {
+            const float t_re = re[k], t_im = im[k];
+            re[k] = re[j];
+            im[k] = im[j];
+            re[j] = t_re;
+            im[j] = t_im;
+        }
+    }
+
+    // Butterflies of doubling size, the inverse transform using the conjugate twiddle factors
+    for (int size = 2; size <= n; size *= 2) {
+        const int half = size / 2, step = n / size;
+        for (int begin = 0; begin < n; begin += size) {
+            for (int j = 0; j < half; j++) {
+                const float w_re = handle->cos_table[j * step];
+                const float w_im = inverse ? -handle->sin_table[j * step] : handle->sin_table[j * step];
+                const int a = begin + j, b = a + half;
+                const float t_re = re[b] * w_re - im[b] * w_im;
+                const float t_im = re[b] * w_im + im[b] * w_re;
+                re[b] = re[a] - t_re;
+                im[b] = im[a] - t_im;
+                re[a] = re[a] + t_re;
+                im[a] = im[a] + t_im;
+            }
+        }
+    }
+}
+
+void forward_pair(dwm_ma_convolver_t *handle, const float *x1, const int count1, const float *x2, const int count2,
+                  float *re1, float *im1, float *re2, float *im2) {
+    const int fft_size = handle->fft_size;
+    for (int k = 0; k < fft_size; k++) {
+        handle->work_re[k] = k < count1 ? x1[k] : 0.0f;
+        handle->work_im[k] = x2 != NULL && k < count2 ? x2[k] : 0.0f;
+    }
+    fft(handle, handle->work_re, handle->work_im, 0);
+
+    // Separate both spectra, X1[k] = (Z[k] + conj(Z[-k])) / 2 and X2[k] = (Z[k] - conj(Z[-k])) / 2i
+    for (int k = 0; k < handle->bin_count; k++) {
+        const int j = (fft_size - k) & (fft_size - 1);
+        const float a_re = handle->work_re[k], a_im = handle->work_im[k];
+        const float b_re = handle->work_re[j], b_im = handle->work_im[j];
+        re1[k] = 0.5f * (a_re + b_re);
+        im1[k] = 0.5f * (a_im - b_im);
+        if (x2 != NULL) {
+            re2[k] = 0.5f * (a_im + b_im);
+            im2[k] = 0.5f * (b_re - a_re);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef DWM_MA_CONVOLVER_H
+#define DWM_MA_CONVOLVER_H
+
+/**
+ * Creates a multichannel uniformly partitioned convolver, whose every output is the sum of each input convolved with
+ * the response of that input and output pair
+ * @param convolver address of convolver handle
+ * @param block_size amount of samples per block, which is also the partition size of the responses
+ * @param rir_length amount of samples of each response
+ * @param in_count amount of inputs
+ * @param out_count amount of outputs
+ * @return 0 on success, non-zero if the sizes are not valid or the convolver cannot be allocated (the handle is then
+ * set to NULL)
+ * @details Responses are split into ceil(rir_length / block_size) partitions of block_size samples, each transformed
+ * once by an FFT of the smallest power of two size no smaller than 2 * block_size. Every block then transforms each
+ * input once into a frequency domain delay line, multiply-accumulates the spectra of every partition, and transforms
+ * each output back (overlap-save): the cost of a block grows with the amount of partitions, not with the responses'
+ * length times the block size as direct convolution does, and there is no latency. Real signals are transformed in
+ * pairs, as the real and imaginary parts of a single complex FFT
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_convolver_create(void **convolver, int block_size, int rir_length, int in_count, int out_count);
+
+/**
+ * Destroys a convolver
+ * @param convolver address of a valid convolver handle
+ */
+void dwm_ma_convolver_destroy(void **convolver);
+
+/**
+ * Sets the response of an input and output pair, silent by default
+ * @param convolver valid convolver handle
+ * @param in index of the input
+ * @param out index of the output
+ * @param rir response samples (dimensionality rir_length)
+ */
+void dwm_ma_convolver_set_response(void *convolver, int in, int out, const float *rir);
+
+/**
+ * Clears the delay line of every input, as if only silence had been processed
+ * @param convolver valid convolver handle
+ */
+void dwm_ma_convolver_reset(void *convolver);
+
+/**
+ * Convolves any amount of samples
+ * @param convolver valid convolver handle
+ * @param in_buffers samples of each input (dimensionality in_count x frame_count), or NULL for silent inputs
+ * @param out_buffers samples of each output (dimensionality out_count x frame_count)
+ * @param frame_count amount of samples
+ * @param out_count amount of outputs written, no more than the convolver's amount of outputs
+ * @param accumulate non-zero to add the outputs to out_buffers instead of overwriting them
+ * @details Samples are convolved in blocks, which calls need not be aligned to: a block given in several parts is
+ * convolved without latency, its first part rendering the contribution of the partitions past the first (which only
+ * depend on the previous blocks) for the whole block, and every part then transforming the block's samples so far to
+ * add the contribution of the first partition, which costs an FFT per input and output pair and per part. Whole blocks
+ * take a single pass over the partitions
+ */
+void dwm_ma_convolver_process(void *convolver, const float *const *in_buffers, float *const *out_buffers,
+                              int frame_count, int out_count, int accumulate);
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef DWM_MA_INTERNAL_H
+#define DWM_MA_INTERNAL_H
+
+#include <math.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+// Helpers shared by the dwm-ma implementation files, not part of the public interface. Files including this header
+// define _GNU_SOURCE before any include, for syscall
+
+/**
+ * Amount of spin iterations a thread waits on a counter before going to sleep, see dwm_ma_wait_counter
+ */
+#define DWM_MA_SPIN_COUNT (1 << 14)
+
+/**
+ * Minimum of two integers
+ */
+static inline int mini(const int a, const int b) { return a < b ? a : b; }
+
+/**
+ * Maximum of two integers
+ */
+static inline int maxi(const int a, const int b) { return a > b ? a : b; }
+
+/**
+ * First value limited to be between the second and third arguments
+ */
+static inline int clampi(const int v, const int min, const int max) { return mini(maxi(v, min), max); }
+
+/**
+ * First value limited to be between the second and third arguments
+ * @note min must be less or equal than max
+ */
+static inline float fclampf(const float v, const float min, const float max) { return fminf(fmaxf(v, min), max); }
+
+/**
+ * Floating point unclamped linear interpolation between a and b controlled by percentage f
+ */
+static inline float flerpf(const float a, const float b, const float f) { return a * (1.0f - f) + (b * f); }
+
+/**
+ * Computes the amount of junctions lying on a face of a mesh
+ * @param size_x_j junctions size on the X-axis
+ * @param size_y_j junctions size on the Y-axis
+ * @param size_z_j junctions size on the Z-axis
+ * @param face face index, in order [Z-,Y-,X-,X+,Y+,Z+]
+ */
+static inline int dwm_ma_face_size_j(const int size_x_j, const int size_y_j, const int size_z_j, const int face) {
+    switch (face) {
+        case 0:
+        case 5:
+            return size_x_j * size_y_j;
+        case 1:
+        case 4:
+            return size_x_j * size_z_j;
+        default:
+            return size_y_j * size_z_j;
+    }
+}
+
+/**
+ * Computes the interpolation parameters for a junction units coordinate of a mesh
+ * @param size_x_j junctions size on the X-axis
+ * @param size_y_j junctions size on the Y-axis
+ * @param size_z_j junctions size on the Z-axis
+ * @param x_j X junction units position, in the same (unclamped) units as the dwm-ma metric conversions
+ * @param y_j Y junction units position
+ * @param z_j Z junction units position
+ * @param interp_percents resulting XYZ interpolation percentages
+ * @param interp_indices resulting X[0,1]-Y[0,1]-Z[0,1] interpolation junction linearized index
+ * @note coordinates outside the mesh are clamped inside to valid coordinates
+ */
+static inline void dwm_ma_compute_interpolation_parameters_j(const int size_x_j, const int size_y_j,
+                                                             const int size_z_j, float x_j, float y_j, float z_j,
+                                                             float interp_percents[3], int interp_indices[2][2][2]) {
+    // Clamp the junction coordinates to valid floating point junction coordinates
+    x_j = fclampf(x_j, 0.0f, size_x_j - 1.0f);
+    y_j = fclampf(y_j, 0.0f, size_y_j - 1.0f);
+    z_j = fclampf(z_j, 0.0f, size_z_j - 1.0f);
+
+    // Return the linearized junction sampling indices of the next and previous junction coordinates
+    const int x_j_i[2] = {(int) floorf(x_j), (int) ceilf(x_j)};
+    const int y_j_i[2] = {(int) floorf(y_j), (int) ceilf(y_j)};
+    const int z_j_i[2] = {(int) floorf(z_j), (int) ceilf(z_j)};
+    for (int z_i = 0; z_i < 2; z_i++) {
+        for (int y_i = 0; y_i < 2; y_i++) {
+            for (int x_i = 0; x_i < 2; x_i++) {
+                interp_indices[x_i][y_i][z_i] = (z_j_i[z_i] * size_y_j + y_j_i[y_i]) * size_x_j + x_j_i[x_i];
+            }
+        }
+    }
+
+    float _; // Return each axis' interpolation percentages
+    interp_percents[0] = modff(x_j, &_);
+    interp_percents[1] = modff(y_j, &_);
+    interp_percents[2] = modff(z_j, &_);
+}
+
+/**
+ * Hints the CPU that the calling thread is spinning, sparing resources of its sibling hyperthread
+ */
+static inline void dwm_ma_cpu_relax(void) {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    _mm_pause();
+#endif
+}
+
+/**
+ * Waits until a counter differs from a previously seen value, spinning first and then sleeping
+ * @param counter counter advanced by dwm_ma_advance_counter
+ * @param sleeping amount of threads sleeping on the counter
+ * @param seen previously seen value of the counter
+ */
+static inline void dwm_ma_wait_counter(atomic_int *counter, atomic_int *sleeping, const int seen) {
+    for (int i = 0; i < DWM_MA_SPIN_COUNT; i++) {
+        if (atomic_load_explicit(counter, memory_order_acquire) != seen) {
+            return;
+        }
+        dwm_ma_cpu_relax();
+    }
+
+    // Sequentially consistent accesses pair with dwm_ma_advance_counter, so that either the new value is observed here
+    // or the sleeping thread is observed there
+    atomic_fetch_add(sleeping, 1);
+    while (atomic_load(counter) == seen) {
+#ifdef __linux__
+        syscall(SYS_futex, (int *) counter, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+#else
+        sched_yield();
+#endif
+    }
+    atomic_fetch_sub(sleeping, 1);
+}
+
+/**
+ * Increments a counter, waking threads waiting on it with dwm_ma_wait_counter only if any of them went to sleep
+ * @param counter counter waited on
+ * @param sleeping amount of threads sleeping on the counter
+ * @param wake_count maximum amount of sleeping threads woken
+ */
+static inline void dwm_ma_advance_counter(atomic_int *counter, atomic_int *sleeping, const int wake_count) {
+    atomic_fetch_add(counter, 1);
+#ifdef __linux__
+    if (atomic_load(sleeping) != 0) {
+        syscall(SYS_futex, (int *) counter, FUTEX_WAKE_PRIVATE, wake_count, NULL, NULL, 0);
+    }
+#else
+    (void) sleeping;
+    (void) wake_count;
+#endif
+}
+
+#endif
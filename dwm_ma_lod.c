@@ -0,0 +1,323 @@
+#include "dwm_ma_lod.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+/**
+ * Smoothing factor of a room's load, the weight of each call's load in its average
+ */
+#define LOAD_SMOOTHING 0.125f
+
+/**
+ * Amount of calls a room waits after switching before it may switch again
+ */
+#define SWITCH_HOLD_CALLS 16
+
+/**
+ * Amount of buffers of every room the rooms wait after a switch before switching
+ */
+#define SWITCH_HOLD_BUFFERS 8
+
+/**
+ * Expected load ratio of a level to the next coarser one
+ */
+#define LEVEL_COST_RATIO 16.0f
+
+// Internal structs and functions declarations
+
+/**
+ * Internal level of detail scheduler implementation. Loads are summed in millionths of a core, call_count counts the
+ * processing calls of all rooms and switch_call is the call_count of the last switch of any room
+ */
+typedef struct {
+    float budget;
+    atomic_llong load_ppm;
+    atomic_int room_count;
+    atomic_ullong call_count;
+    atomic_ullong switch_call;
+} dwm_ma_lod_scheduler_t;
+
+/**
+ * Internal room implementation, only accounted to its scheduler (set) once fully created. load is the room's averaged
+ * load (unset while load_valid is not), of which published_ppm is accounted to the scheduler, and hold the amount of
+ * calls before the room may switch again. level is the level processing the room and next_level the one the next call
+ * switches to, both atomic as they are set and read from other threads than the processing one
+ */
+typedef struct {
+    dwm_ma_lod_scheduler_t *scheduler;
+    void *instances[DWM_MA_LOD_MAX_LEVEL_COUNT];
+    int level_count;
+    atomic_int level, next_level;
+    int buffer_size, out_count;
+    uint64_t buffer_ns;
+    float load;
+    int load_valid;
+    long long published_ppm;
+    int hold;
+    float *fade_samples;
+    float **fade_buffers;
+} dwm_ma_lod_t;
+
+/**
+ * Accounts the load of a processing call to a room and to its scheduler
+ * @param handle room handle
+ * @param instance instance which processed the call, whose statistics hold the call's duration
+ */
+static void update_load(dwm_ma_lod_t *handle, const void *instance);
+
+/**
+ * Picks the level the next processing call of a room switches to, if any
+ * @param handle room handle
+ * @param call index of the processing call among the calls of all rooms of the scheduler
+ */
+static void schedule_level(dwm_ma_lod_t *handle, unsigned long long call);
+
+// Function definitions
+
+int dwm_ma_lod_scheduler_create(void **scheduler, const float budget) {
+    dwm_ma_lod_scheduler_t *handle = budget > 0.0f ? malloc(sizeof(dwm_ma_lod_scheduler_t)) : NULL;
+    if (handle == NULL) {
+        *scheduler = NULL;
+        return 1;
+    }
+    handle->budget = budget;
+    atomic_init(&handle->load_ppm, 0);
+    atomic_init(&handle->room_count, 0);
+    atomic_init(&handle->call_count, 0);
+    atomic_init(&handle->switch_call, 0);
+    *scheduler = handle;
+    return 0;
+}
+
+void dwm_ma_lod_scheduler_destroy(void **scheduler) {
+    free(*scheduler);
+    *scheduler = NULL;
+}
+
+float dwm_ma_lod_scheduler_get_load(const void *scheduler) {
+    const dwm_ma_lod_scheduler_t *handle = scheduler;
+    return (float) atomic_load_explicit(&handle->load_ppm, memory_order_relaxed) * 1e-6f;
+}
+
+int dwm_ma_lod_create(void **lod, void *scheduler, const dwm_ma_mesh_config *config, const int level_count,
+                      const int out_count) {
+    if (scheduler == NULL || level_count < 1 || level_count > DWM_MA_LOD_MAX_LEVEL_COUNT || out_count < 1 ||
+        config->sample_rate % (1 << (level_count - 1)) != 0 || config->buffer_size % (1 << (level_count - 1)) != 0) {
+        *lod = NULL;
+        return 1;
+    }
+    dwm_ma_lod_t *handle = calloc(1, sizeof(dwm_ma_lod_t));
+    if (handle == NULL) {
+        *lod = NULL;
+        return 1;
+    }
+    handle->level_count = level_count;
+    atomic_init(&handle->level, 0);
+    atomic_init(&handle->next_level, 0);
+    handle->buffer_size = config->buffer_size;
+    handle->out_count = out_count;
+    handle->buffer_ns = (uint64_t) config->buffer_size * 1000000000u / (uint64_t) config->sample_rate;
+    handle->fade_samples = malloc(sizeof(float) * out_count * config->buffer_size);
+    handle->fade_buffers = malloc(sizeof(float *) * out_count);
+    int failed = handle->fade_samples == NULL || handle->fade_buffers == NULL;
+    for (int i = 0; i < out_count && !failed; i++) {
+        handle->fade_buffers[i] = handle->fade_samples + i * config->buffer_size;
+    }
+
+    // Every coarser level halves the rate and the junctions along each axis, and exchanges buffers at level 0's rate
+    for (int k = 0; k < level_count && !failed; k++) {
+        dwm_ma_mesh_config level_config = *config;
+        level_config.sample_rate = config->sample_rate >> k;
+        level_config.buffer_size = config->buffer_size >> k;
+        level_config.size_x_j = (config->size_x_j + (1 << k) / 2) >> k;
+        level_config.size_y_j = (config->size_y_j + (1 << k) / 2) >> k;
+        level_config.size_z_j = (config->size_z_j + (1 << k) / 2) >> k;
+        level_config.size_x_j = level_config.size_x_j < 3 ? 3 : level_config.size_x_j;
+        level_config.size_y_j = level_config.size_y_j < 3 ? 3 : level_config.size_y_j;
+        level_config.size_z_j = level_config.size_z_j < 3 ? 3 : level_config.size_z_j;
+        failed = dwm_ma_create_ex(&handle->instances[k], &level_config) != 0 ||
+                 (k > 0 && dwm_ma_set_host_sample_rate(handle->instances[k], config->sample_rate) != 0);
+
+        // The statistics time the processing calls the loads are computed from
+        if (!failed) {
+            dwm_ma_set_stats_enabled(handle->instances[k], 1);
+        }
+    }
+    if (failed) {
+        dwm_ma_lod_destroy((void **) &handle);
+        *lod = NULL;
+        return 1;
+    }
+    handle->scheduler = scheduler;
+    atomic_fetch_add(&handle->scheduler->room_count, 1);
+    *lod = handle;
+    return 0;
+}
+
+void dwm_ma_lod_destroy(void **lod) {
+    dwm_ma_lod_t *handle = *lod;
+
+    // Only a fully created room is accounted to its scheduler
+    if (handle->scheduler != NULL) {
+        atomic_fetch_sub(&handle->scheduler->load_ppm, handle->published_ppm);
+        atomic_fetch_sub(&handle->scheduler->room_count, 1);
+    }
+    for (int k = 0; k < handle->level_count; k++) {
+        if (handle->instances[k] != NULL) {
+            dwm_ma_destroy(&handle->instances[k]);
+        }
+    }
+    free(handle->fade_samples);
+    free(handle->fade_buffers);
+    free(handle);
+    *lod = NULL;
+}
+
+void *dwm_ma_lod_get_instance(void *lod, const int level) {
+    const dwm_ma_lod_t *handle = lod;
+    return level >= 0 && level < handle->level_count ? handle->instances[level] : NULL;
+}
+
+int dwm_ma_lod_get_level(const void *lod) {
+    const dwm_ma_lod_t *handle = lod;
+    return atomic_load_explicit(&handle->level, memory_order_relaxed);
+}
+
+void dwm_ma_lod_set_level(void *lod, const int level) {
+    dwm_ma_lod_t *handle = lod;
+    atomic_store_explicit(&handle->next_level,
+                          level < 0 ? 0 : level >= handle->level_count ? handle->level_count - 1 : level,
+                          memory_order_relaxed);
+}
+
+void dwm_ma_lod_init(void *lod, const float dwm_bound_params[6][2], const int dwm_bound_params_normalized) {
+    const dwm_ma_lod_t *handle = lod;
+    for (int k = 0; k < handle->level_count; k++) {
+        dwm_ma_init(handle->instances[k], dwm_bound_params, dwm_bound_params_normalized);
+    }
+}
+
+int dwm_ma_lod_set_custom_layout(void *lod, const ma_custom_layout *layout) {
+    const dwm_ma_lod_t *handle = lod;
+    int failed = dwm_ma_set_custom_layout(handle->instances[0], layout) != 0;
+    if (layout == NULL) {
+        for (int k = 1; k < handle->level_count; k++) {
+            failed |= dwm_ma_set_custom_layout(handle->instances[k], NULL) != 0;
+        }
+        return failed;
+    }
+
+    // Coarser levels get the layout with their junctions' coordinates, in output channel order
+    float(*mic_xyz_j)[3] = malloc(sizeof(float[3]) * layout->channel_count);
+    if (mic_xyz_j == NULL) {
+        return 1;
+    }
+    for (int k = 1; k < handle->level_count; k++) {
+        const float scale = 1.0f / (float) (1 << k);
+        for (int i = 0; i < layout->channel_count; i++) {
+            for (int a = 0; a < 3; a++) {
+                mic_xyz_j[layout->channels[i]][a] = layout->mic_rel_xyz_j[i][a] * scale;
+            }
+        }
+        ma_custom_layout *level_layout;
+        if (ma_custom_layout_create(&level_layout, (const float(*)[3]) mic_xyz_j, layout->channel_count) != 0) {
+            failed = 1;
+            continue;
+        }
+        level_layout->radius_j = layout->radius_j * scale;
+        failed |= dwm_ma_set_custom_layout(handle->instances[k], level_layout) != 0;
+        ma_custom_layout_destroy(&level_layout);
+    }
+    free(mic_xyz_j);
+    return failed;
+}
+
+int dwm_ma_lod_set_ambisonics_order(void *lod, const int order) {
+    const dwm_ma_lod_t *handle = lod;
+    int failed = 0;
+    for (int k = 0; k < handle->level_count; k++) {
+        failed |= dwm_ma_set_ambisonics_order(handle->instances[k], order) != 0;
+    }
+    return failed;
+}
+
+void dwm_ma_lod_process(void *lod, const float *const *in_buffers, const float *const *in_positions_start_m,
+                        const float *const *in_positions_end_m, const int in_count, const MA_CONFIG ma_config,
+                        const float ma_scale, float *const *ma_buffers, const float *ma_position_start_m,
+                        const float *ma_position_end_m) {
+    dwm_ma_lod_t *handle = lod;
+    const unsigned long long call = atomic_fetch_add_explicit(&handle->scheduler->call_count, 1, memory_order_relaxed);
+    const int level = atomic_load_explicit(&handle->level, memory_order_relaxed);
+    const int next_level = atomic_load_explicit(&handle->next_level, memory_order_relaxed);
+    void *instance = handle->instances[level];
+    if (next_level == level) {
+        dwm_ma_process_trajectory(instance, in_buffers, in_positions_start_m, in_positions_end_m, in_count, ma_config,
+                                  ma_scale, ma_buffers, ma_position_start_m, ma_position_end_m);
+        update_load(handle, instance);
+        schedule_level(handle, call);
+        return;
+    }
+
+    // Switch by resampling the state the buffer starts from, then crossfade from the current level's outputs to the
+    // next level's over the buffer
+    void *next_instance = handle->instances[next_level];
+    dwm_ma_transfer_state(next_instance, instance);
+    dwm_ma_process_trajectory(instance, in_buffers, in_positions_start_m, in_positions_end_m, in_count, ma_config,
+                              ma_scale, ma_buffers, ma_position_start_m, ma_position_end_m);
+    dwm_ma_process_trajectory(next_instance, in_buffers, in_positions_start_m, in_positions_end_m, in_count,
+                              ma_config, ma_scale, handle->fade_buffers, ma_position_start_m, ma_position_end_m);
+    for (int c = 0; c < handle->out_count; c++) {
+        for (int n = 0; n < handle->buffer_size; n++) {
+            const float f = (float) (n + 1) / (float) handle->buffer_size;
+            ma_buffers[c][n] = ma_buffers[c][n] * (1.0f - f) + handle->fade_buffers[c][n] * f;
+        }
+    }
+    atomic_store_explicit(&handle->level, next_level, memory_order_relaxed);
+
+    // The switching call is not representative of the new level, whose load is measured from the next call on
+    handle->load_valid = 0;
+    handle->hold = SWITCH_HOLD_CALLS;
+}
+
+void update_load(dwm_ma_lod_t *handle, const void *instance) {
+    dwm_ma_stats stats;
+    dwm_ma_get_stats(instance, &stats);
+    const float load = (float) stats.last_ns / (float) handle->buffer_ns;
+    handle->load = handle->load_valid ? handle->load + (load - handle->load) * LOAD_SMOOTHING : load;
+    handle->load_valid = 1;
+    const long long ppm = (long long) (handle->load * 1e6f);
+    atomic_fetch_add_explicit(&handle->scheduler->load_ppm, ppm - handle->published_ppm, memory_order_relaxed);
+    handle->published_ppm = ppm;
+}
+
+void schedule_level(dwm_ma_lod_t *handle, const unsigned long long call) {
+    if (handle->hold > 0) {
+        handle->hold--;
+        return;
+    }
+
+    // Coarsen the most loaded rooms while over budget, refine a room while its expected load fits with some margin
+    dwm_ma_lod_scheduler_t *scheduler = handle->scheduler;
+    const float load = (float) atomic_load_explicit(&scheduler->load_ppm, memory_order_relaxed) * 1e-6f;
+    const int room_count = atomic_load_explicit(&scheduler->room_count, memory_order_relaxed);
+    const int current_level = atomic_load_explicit(&handle->level, memory_order_relaxed);
+    int level = current_level;
+    if (load > scheduler->budget && level + 1 < handle->level_count && handle->load * (float) room_count >= load) {
+        level++;
+    } else if (level > 0 && load + handle->load * (LEVEL_COST_RATIO - 1.0f) < 0.75f * scheduler->budget) {
+        level--;
+    }
+    if (level == current_level) {
+        return;
+    }
+
+    // A single room switches at a time, claiming the switch from the others, which wait for SWITCH_HOLD_BUFFERS calls
+    // of every room (switch_call is offset by one, zero standing for no switch yet)
+    unsigned long long switch_call = atomic_load(&scheduler->switch_call);
+    if (switch_call != 0 && call + 1 - switch_call < (unsigned long long) SWITCH_HOLD_BUFFERS * room_count) {
+        return;
+    }
+    if (atomic_compare_exchange_strong(&scheduler->switch_call, &switch_call, call + 1)) {
+        atomic_store_explicit(&handle->next_level, level, memory_order_relaxed);
+    }
+}
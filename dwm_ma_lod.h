@@ -0,0 +1,150 @@
+#ifndef DWM_MA_LOD_H
+#define DWM_MA_LOD_H
+
+#include "dwm_ma.h"
+
+/**
+ * Maximum amount of levels of detail of a room
+ */
+#define DWM_MA_LOD_MAX_LEVEL_COUNT 4
+
+/**
+ * Creates a level of detail scheduler, which shares a CPU budget between all the rooms created with it
+ * @param scheduler address of scheduler handle
+ * @param budget CPU budget of all rooms together, in cores (e.g. 0.5 for half of a core)
+ * @return 0 on success, non-zero if the budget is not positive or the scheduler cannot be allocated (the handle is then
+ * set to NULL)
+ * @details The load of a room is the share of real time its processing calls take, as timed by the runtime statistics
+ * of its levels (see dwm_ma_get_stats) and averaged over the last few calls, and the scheduler's load is the sum of its
+ * rooms' loads. While it exceeds the budget, the rooms whose load is no lower than the average move to their next
+ * coarser level, and while it stays under three quarters of the budget with the expected load of a finer level (16
+ * times the current one: twice the junctions along each axis at twice the rate), a room moves back to its next finer
+ * level. A single room switches at a time, all rooms then waiting for 8 processing calls of each room so that the loads
+ * account for the switch before the next decision
+ * @note Rooms may be processed concurrently from any threads, the scheduler only being accessed through atomics
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_lod_scheduler_create(void **scheduler, float budget);
+
+/**
+ * Destroys a scheduler
+ * @param scheduler address of a valid scheduler handle, whose rooms were all destroyed
+ */
+void dwm_ma_lod_scheduler_destroy(void **scheduler);
+
+/**
+ * Load of a scheduler
+ * @param scheduler valid scheduler handle
+ * @return the sum of the loads of its rooms, in cores
+ */
+float dwm_ma_lod_scheduler_get_load(const void *scheduler);
+
+/**
+ * Creates a room simulated at several levels of detail, each a dwm-ma instance of the same metric room meshed with
+ * junctions twice as far apart as the previous one's
+ * @param lod address of room handle
+ * @param scheduler valid scheduler handle, whose budget the room shares
+ * @param config mesh configuration of the finest level (level 0)
+ * @param level_count amount of levels, in [1, DWM_MA_LOD_MAX_LEVEL_COUNT]
+ * @param out_count amount of output channels, no fewer than the processing calls write
+ * @return 0 on success, non-zero if the configuration or the amounts are not valid, or the instances cannot be created
+ * (the handle is then set to NULL)
+ * @details Level k runs at sample_rate / 2^k with buffers of buffer_size / 2^k samples (both of which must be whole)
+ * and a mesh of size / 2^k junctions along each axis (rounded, at least 3), i.e. with 8^k times fewer junctions
+ * updated half as often per level, for a bandwidth halved per level. Every level exchanges buffers at the finest
+ * level's sampling rate (see dwm_ma_set_host_sample_rate), so that switching levels does not change the processing
+ * calls. The room starts at level 0
+ * @note Coarser levels add the latency of their resamplers, and do not render the content above their Nyquist frequency
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_lod_create(void **lod, void *scheduler, const dwm_ma_mesh_config *config, int level_count, int out_count);
+
+/**
+ * Destroys a room and its instances, removing its load from its scheduler
+ * @param lod address of a valid room handle
+ */
+void dwm_ma_lod_destroy(void **lod);
+
+/**
+ * Instance of a level of a room, to be configured like any other instance for the settings the room does not forward
+ * to all of its levels (boundary maps, geometry, threads...)
+ * @param lod valid room handle
+ * @param level level of detail, in [0, level_count - 1]
+ * @return the level's dwm-ma handle, or NULL if the level is not valid
+ * @note Geometries and boundary maps are given per junction, thus at each level's own resolution: they are not
+ * forwarded, and must be set on every level's instance
+ * @note The room enables the runtime statistics of its instances (see dwm_ma_set_stats_enabled), which must stay
+ * enabled for the scheduler to measure the room's load
+ */
+void *dwm_ma_lod_get_instance(void *lod, int level);
+
+/**
+ * Current level of detail of a room
+ * @param lod valid room handle
+ * @return the level whose instance processes the room
+ */
+int dwm_ma_lod_get_level(const void *lod);
+
+/**
+ * Requests a room to switch to a level of detail at its next processing call
+ * @param lod valid room handle
+ * @param level level of detail, clamped to [0, level_count - 1]
+ * @note The scheduler may then move the room again, as after any switch
+ * @note May be called from any thread, concurrently with the room's processing calls
+ */
+void dwm_ma_lod_set_level(void *lod, int level);
+
+/**
+ * Initializes every level of a room to the initial state, see dwm_ma_init
+ * @param lod valid room handle
+ * @param dwm_bound_params dwm boundary parameters, in order [Z-,Y-,X-,X+,Y+,Z+]
+ * @param dwm_bound_params_normalized controls how dwm_bound_params are interpreted, as in dwm_ma_init
+ */
+void dwm_ma_lod_init(void *lod, const float dwm_bound_params[6][2], int dwm_bound_params_normalized);
+
+/**
+ * Sets the runtime microphone array layout of every level of a room, see dwm_ma_set_custom_layout
+ * @param lod valid room handle
+ * @param layout valid layout, in level 0's junctions, or NULL to remove the levels' layouts
+ * @return 0 on success, non-zero if a level's layout cannot be allocated (that level then keeps its previous layout)
+ * @details Coarser levels get the layout scaled to their own junctions, so that every level reads the same metric
+ * microphone positions
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_lod_set_custom_layout(void *lod, const ma_custom_layout *layout);
+
+/**
+ * Sets the Ambisonics order every level of a room encodes its microphone array output to, see
+ * dwm_ma_set_ambisonics_order
+ * @param lod valid room handle
+ * @param order Ambisonics order, in [0, MA_AMBISONICS_MAX_ORDER], or negative to output the microphones themselves
+ * @return 0 on success, non-zero if the order is not valid or a level's encoder cannot be allocated (that level then
+ * keeps its previous order)
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_lod_set_ambisonics_order(void *lod, int order);
+
+/**
+ * Processes a buffer inside a room at its current level of detail, with the same arguments as dwm_ma_process_trajectory
+ * and the buffer size of level 0
+ * @param lod valid room handle
+ * @param in_buffers samples introduced by each input (dimensionality in_count x buffer_size)
+ * @param in_positions_start_m metric positions of each input at the buffer's first sample (dimensionality in_count x 3)
+ * @param in_positions_end_m metric positions of each input at the next buffer's first sample (dimensionality
+ * in_count x 3)
+ * @param in_count amount of inputs processed (no more than DWM_MA_MAX_INPUT_COUNT)
+ * @param ma_config microphone array configuration used
+ * @param ma_scale microphone array scale
+ * @param ma_buffers samples outputted by each channel (dimensionality out_count x buffer_size)
+ * @param ma_position_start_m microphone array's center position at the buffer's first sample (dimensionality 1 x 3)
+ * @param ma_position_end_m microphone array's center position at the next buffer's first sample (dimensionality 1 x 3)
+ * @details The call is timed and accounted to the room's load, after which the scheduler may request a switch. A switch
+ * resamples the current level's state into the new level's instance (see dwm_ma_transfer_state), processes the buffer
+ * at both levels and crossfades linearly from the former's outputs to the latter's, the call thus costing about the
+ * sum of both levels
+ */
+void dwm_ma_lod_process(void *lod, const float *const *in_buffers, const float *const *in_positions_start_m,
+                        const float *const *in_positions_end_m, int in_count, MA_CONFIG ma_config, float ma_scale,
+                        float *const *ma_buffers, const float *ma_position_start_m, const float *ma_position_end_m);
+
+#endif
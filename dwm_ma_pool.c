@@ -0,0 +1,178 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "dwm_ma_pool.h"
+#include "dwm_ma_internal.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Internal structs and functions declarations
+
+typedef struct dwm_ma_pool_t dwm_ma_pool_t;
+
+/**
+ * Internal worker thread state
+ */
+typedef struct {
+    dwm_ma_pool_t *pool;
+    pthread_t thread;
+    int index;
+} dwm_ma_pool_worker_t;
+
+/**
+ * Internal pool implementation: a generation counter starts each task and a pending counter tracks its completion
+ */
+struct dwm_ma_pool_t {
+    atomic_int generation;
+    atomic_int pending;
+    atomic_int sleeping;
+    atomic_int stop;
+    dwm_ma_pool_task_t task;
+    void *context;
+    int thread_count;
+    dwm_ma_pool_worker_t *workers;
+};
+
+/**
+ * Worker thread entry point
+ */
+static void *worker_main(void *arg);
+
+/**
+ * Pins the worker threads of a pool to single CPUs of the calling thread's affinity mask, if supported by the platform
+ * @details Workers are given the CPUs following the calling thread's one in its mask, shifted by the amount of workers
+ * pinned by every previous pool, so that the calling thread and successive pools run on distinct CPUs as long as the
+ * mask has enough of them. Workers are left unpinned (inheriting the mask) when it has fewer CPUs than the pool has
+ * threads
+ */
+static void pin_workers(dwm_ma_pool_t *handle);
+
+// Function definitions
+
+int dwm_ma_pool_create(void **pool, int thread_count) {
+    dwm_ma_pool_t *handle = malloc(sizeof(dwm_ma_pool_t));
+    if (handle == NULL) {
+        *pool = NULL;
+        return 1;
+    }
+    thread_count = thread_count < 1 ? 1 : thread_count;
+    atomic_init(&handle->generation, 0);
+    atomic_init(&handle->pending, 0);
+    atomic_init(&handle->sleeping, 0);
+    atomic_init(&handle->stop, 0);
+    handle->task = NULL;
+    handle->context = NULL;
+    handle->thread_count = thread_count;
+    handle->workers = malloc(sizeof(dwm_ma_pool_worker_t) * thread_count);
+    if (handle->workers == NULL) {
+        free(handle);
+        *pool = NULL;
+        return 1;
+    }
+
+    // Worker 0 is the calling thread, only the others are spawned
+    for (int i = 1; i < thread_count; i++) {
+        handle->workers[i].pool = handle;
+        handle->workers[i].index = i;
+        if (pthread_create(&handle->workers[i].thread, NULL, worker_main, &handle->workers[i]) != 0) {
+            handle->thread_count = i;
+            dwm_ma_pool_destroy((void **) &handle);
+            *pool = NULL;
+            return 1;
+        }
+    }
+    pin_workers(handle);
+    *pool = handle;
+    return 0;
+}
+
+void dwm_ma_pool_destroy(void **pool) {
+    dwm_ma_pool_t *handle = *pool;
+
+    // Signal all workers to stop and wait for them to exit
+    atomic_store_explicit(&handle->stop, 1, memory_order_relaxed);
+    dwm_ma_advance_counter(&handle->generation, &handle->sleeping, __INT_MAX__);
+    for (int i = 1; i < handle->thread_count; i++) {
+        pthread_join(handle->workers[i].thread, NULL);
+    }
+    free(handle->workers);
+    free(handle);
+    *pool = NULL;
+}
+
+void dwm_ma_pool_run(void *pool, const dwm_ma_pool_task_t task, void *context) {
+    dwm_ma_pool_t *handle = pool;
+    if (handle->thread_count == 1) {
+        task(context, 0, 1);
+        return;
+    }
+
+    // Publish the task, then start a new generation
+    handle->task = task;
+    handle->context = context;
+    atomic_store_explicit(&handle->pending, handle->thread_count - 1, memory_order_relaxed);
+    dwm_ma_advance_counter(&handle->generation, &handle->sleeping, __INT_MAX__);
+
+    // The calling thread takes the first share, then waits for the workers
+    task(context, 0, handle->thread_count);
+    while (atomic_load_explicit(&handle->pending, memory_order_acquire) != 0) {
+        dwm_ma_cpu_relax();
+    }
+}
+
+int dwm_ma_pool_get_thread_count(const void *pool) {
+    const dwm_ma_pool_t *handle = pool;
+    return handle->thread_count;
+}
+
+void *worker_main(void *arg) {
+    const dwm_ma_pool_worker_t *worker = arg;
+    dwm_ma_pool_t *handle = worker->pool;
+    int seen = 0;
+    for (;;) {
+        dwm_ma_wait_counter(&handle->generation, &handle->sleeping, seen);
+        seen = atomic_load_explicit(&handle->generation, memory_order_acquire);
+        if (atomic_load_explicit(&handle->stop, memory_order_relaxed)) {
+            return NULL;
+        }
+        handle->task(handle->context, worker->index, handle->thread_count);
+        atomic_fetch_sub_explicit(&handle->pending, 1, memory_order_release);
+    }
+}
+
+void pin_workers(dwm_ma_pool_t *handle) {
+#ifdef __linux__
+    static atomic_uint pinned_count = 0;
+    cpu_set_t mask;
+    if (handle->thread_count < 2 || pthread_getaffinity_np(pthread_self(), sizeof(mask), &mask) != 0 ||
+        CPU_COUNT(&mask) < handle->thread_count) {
+        return;
+    }
+
+    // List the mask's CPUs, and start after the calling thread's one (or the first one if it is not in the mask)
+    int cpus[CPU_SETSIZE], cpu_count = 0, first = 0;
+    const int current = sched_getcpu();
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &mask)) {
+            first = cpu == current ? cpu_count : first;
+            cpus[cpu_count++] = cpu;
+        }
+    }
+    const unsigned shift =
+            atomic_fetch_add_explicit(&pinned_count, (unsigned) handle->thread_count - 1, memory_order_relaxed);
+    for (int i = 1; i < handle->thread_count; i++) {
+        // Skip the calling thread's CPU when wrapping around the mask
+        const int k = (int) ((shift + (unsigned) i - 1) % (unsigned) (cpu_count - 1));
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[(first + 1 + k) % cpu_count], &set);
+        pthread_setaffinity_np(handle->workers[i].thread, sizeof(set), &set);
+    }
+#else
+    (void) handle;
+#endif
+}
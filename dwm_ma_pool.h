@@ -0,0 +1,47 @@
+#ifndef DWM_MA_POOL_H
+#define DWM_MA_POOL_H
+
+/**
+ * Task run by every thread of a pool
+ * @param context user context given to dwm_ma_pool_run
+ * @param thread_index index of the thread running the task, 0 being the calling thread
+ * @param thread_count total amount of threads running the task
+ */
+typedef void (*dwm_ma_pool_task_t)(void *context, int thread_index, int thread_count);
+
+/**
+ * Creates a persistent pool of pinned worker threads
+ * @param pool address of pool handle
+ * @param thread_count total amount of threads running each task, including the calling thread
+ * @return 0 on success, non-zero if the pool could not be allocated or the worker threads could not be created (the
+ * pool handle is then set to NULL)
+ * @details Workers are pinned to single CPUs of the calling thread's affinity mask other than its current one, each
+ * pool taking the CPUs following the previous pool's so that the pools of several instances spread over the mask.
+ * Workers are not pinned when the mask has fewer CPUs than thread_count
+ */
+int dwm_ma_pool_create(void **pool, int thread_count);
+
+/**
+ * Stops and joins all worker threads, then destroys the pool
+ * @param pool address of a valid pool handle
+ */
+void dwm_ma_pool_destroy(void **pool);
+
+/**
+ * Runs a task on every thread of the pool, returning once all threads completed it
+ * @param pool valid pool handle
+ * @param task task to be run
+ * @param context user context passed to the task
+ * @note Workers spin for a short while between tasks before going to sleep, so that back to back tasks (e.g. one per
+ * simulation step) are dispatched without any system call
+ */
+void dwm_ma_pool_run(void *pool, dwm_ma_pool_task_t task, void *context);
+
+/**
+ * Amount of threads of a pool
+ * @param pool valid pool handle
+ * @return the amount of threads running each task, including the calling thread
+ */
+int dwm_ma_pool_get_thread_count(const void *pool);
+
+#endif
@@ -0,0 +1,243 @@
+#include "dwm_ma_resampler.h"
+#include "dwm_ma_simd.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PI 3.141592653589793
+
+/**
+ * Fraction of the lower rate's Nyquist frequency at which the prototype's transition band is centered
+ */
+#define ROLLOFF 0.9
+
+/**
+ * Kaiser window shape parameter, giving roughly 80dB of stopband attenuation
+ */
+#define KAISER_BETA 8.0
+
+// Internal structs and functions declarations
+
+/**
+ * Internal resampler implementation
+ * @details Each channel keeps the last history_count = tap_count - 1 + down input samples, which are placed in front of
+ * every new block so that each output sample reads a contiguous window of tap_count samples; the outputs sharing a
+ * phase are computed by a single strided FIR kernel call and then interleaved into the output block. Blocks may start
+ * at any phase: phase is the next output's index J modulo L, and start the last input sample it reads relative to the
+ * next block, floor(J * M / L) minus the amount of inputs given so far, which the down extra history samples let go
+ * as low as -M for the outputs left to the next block
+ */
+typedef struct {
+    dwm_ma_fir_kernel_t fir_kernel;
+    int up, down;
+    int tap_count;
+    int history_count;
+    int channel_count;
+    int input_count;
+    int phase, start;
+    int *phases;
+    int *bases;
+    float *coefficients;
+    float *histories;
+    float *window;
+    float *phase_out;
+} dwm_ma_resampler_t;
+
+/**
+ * Computes the greatest common divisor of two positive integers
+ */
+static int gcd(int a, int b);
+
+/**
+ * Computes the zeroth order modified Bessel function of the first kind, used by the Kaiser window
+ */
+static double bessel_i0(double x);
+
+/**
+ * Designs the Kaiser-windowed sinc prototype and stores each phase's coefficients in reversed order
+ */
+static void compute_coefficients(dwm_ma_resampler_t *handle);
+
+// Function definitions
+
+int dwm_ma_resampler_create(void **resampler, const int input_rate, const int output_rate, const int channel_count,
+                            const int input_count) {
+    *resampler = NULL;
+    if (input_rate <= 0 || output_rate <= 0 || channel_count <= 0 || input_count <= 0) {
+        return 1;
+    }
+    const int divisor = gcd(input_rate, output_rate);
+    const int up = output_rate / divisor, down = input_rate / divisor;
+
+    // The prototype spans DWM_MA_RESAMPLER_ZERO_CROSSINGS on each side at the lower rate, rounded up to whole phases
+    const int max_ratio = up > down ? up : down;
+    const int prototype_count = 2 * DWM_MA_RESAMPLER_ZERO_CROSSINGS * max_ratio + 1;
+    dwm_ma_resampler_t *handle = malloc(sizeof(dwm_ma_resampler_t));
+    if (handle == NULL) {
+        return 1;
+    }
+    handle->fir_kernel = dwm_ma_simd_select_fir_kernel();
+    handle->up = up;
+    handle->down = down;
+    handle->tap_count = (prototype_count + up - 1) / up;
+    handle->history_count = handle->tap_count - 1 + down;
+    handle->channel_count = channel_count;
+    handle->input_count = input_count;
+    handle->phases = malloc(sizeof(int) * up);
+    handle->bases = malloc(sizeof(int) * up);
+    handle->coefficients = malloc(sizeof(float) * up * handle->tap_count);
+    handle->histories = malloc(sizeof(float) * channel_count * handle->history_count);
+    handle->window = malloc(sizeof(float) * (handle->history_count + input_count));
+
+    // The outputs sharing a phase read windows M samples apart, all ending within the M + input_count samples from the
+    // oldest deferred output to the block's end
+    handle->phase_out = malloc(sizeof(float) * ((input_count - 1) / down + 2));
+    if (handle->phases == NULL || handle->bases == NULL || handle->coefficients == NULL || handle->histories == NULL ||
+        handle->window == NULL || handle->phase_out == NULL) {
+        dwm_ma_resampler_destroy((void **) &handle);
+        return 1;
+    }
+
+    // Output j reads the phase (j * M) mod L, from the window starting at floor(j * M / L); outputs j and j + L share
+    // the phase, and their windows are M samples apart
+    for (int r = 0; r < up; r++) {
+        handle->phases[r] = (int) ((long long) r * down % up);
+        handle->bases[r] = (int) ((long long) r * down / up);
+    }
+    compute_coefficients(handle);
+    dwm_ma_resampler_reset(handle);
+    *resampler = handle;
+    return 0;
+}
+
+void dwm_ma_resampler_destroy(void **resampler) {
+    dwm_ma_resampler_t *handle = *resampler;
+    free(handle->phases);
+    free(handle->bases);
+    free(handle->coefficients);
+    free(handle->histories);
+    free(handle->window);
+    free(handle->phase_out);
+    free(handle);
+    *resampler = NULL;
+}
+
+void dwm_ma_resampler_reset(void *resampler) {
+    dwm_ma_resampler_t *handle = resampler;
+    memset(handle->histories, 0, sizeof(float) * handle->channel_count * handle->history_count);
+    handle->phase = 0;
+    handle->start = 0;
+}
+
+void dwm_ma_resampler_copy_state(void *resampler, const void *source) {
+    dwm_ma_resampler_t *handle = resampler;
+    const dwm_ma_resampler_t *source_handle = source;
+    const int history_count = handle->history_count;
+    const int channel_count = handle->channel_count < source_handle->channel_count ? handle->channel_count
+                                                                                   : source_handle->channel_count;
+    dwm_ma_resampler_reset(handle);
+    memcpy(handle->histories, source_handle->histories, sizeof(float) * channel_count * history_count);
+    handle->phase = source_handle->phase;
+    handle->start = source_handle->start;
+}
+
+int dwm_ma_resampler_available_count(const void *resampler, const int input_count) {
+    const dwm_ma_resampler_t *handle = resampler;
+
+    // Output u of the block is available once start + floor((phase + u) * M / L) - floor(phase * M / L) is below
+    // input_count, i.e. once (phase + u) * M < limit * L
+    const long long limit = (long long) input_count - handle->start + handle->bases[handle->phase];
+    if (limit <= 0) {
+        return 0;
+    }
+    const long long count = (limit * handle->up + handle->down - 1) / handle->down - handle->phase;
+    return count > 0 ? (int) count : 0;
+}
+
+void dwm_ma_resampler_process(void *resampler, const int channel, const float *in, const int input_count, float *out,
+                              const int output_count) {
+    dwm_ma_resampler_t *handle = resampler;
+    const int history_count = handle->history_count;
+    float *history = handle->histories + channel * history_count;
+
+    // Place the history in front of the block
+    memcpy(handle->window, history, sizeof(float) * history_count);
+    memcpy(handle->window + history_count, in, sizeof(float) * input_count);
+
+    // Compute the outputs of each phase, interleaving them unless there is a single one: output u reads the phase
+    // ((phase + u) * M) mod L, from the window starting at down + start + floor((phase + u) * M / L) minus
+    // floor(phase * M / L), phase + u being below 2 * L
+    const int up = handle->up, down = handle->down;
+    const float *window = handle->window + down + handle->start - handle->bases[handle->phase];
+    for (int u = 0; u < up && u < output_count; u++) {
+        const int r = handle->phase + u;
+        const int count = (output_count - u + up - 1) / up;
+        const float *coefficients = handle->coefficients + handle->phases[r % up] * handle->tap_count;
+        float *phase_out = up == 1 ? out : handle->phase_out;
+        handle->fir_kernel(phase_out, window + handle->bases[r % up] + (r >= up ? down : 0), coefficients,
+                           handle->tap_count, count, down);
+        if (up > 1) {
+            for (int v = 0; v < count; v++) {
+                out[u + v * up] = phase_out[v];
+            }
+        }
+    }
+
+    // Keep the last samples as the next block's history
+    memcpy(history, handle->window + input_count, sizeof(float) * history_count);
+}
+
+void dwm_ma_resampler_advance(void *resampler, const int input_count, const int output_count) {
+    dwm_ma_resampler_t *handle = resampler;
+    const long long r = (long long) handle->phase + output_count;
+    const long long offset = r / handle->up * handle->down + handle->bases[r % handle->up];
+    handle->start += (int) (offset - handle->bases[handle->phase] - input_count);
+    handle->phase = (int) (r % handle->up);
+}
+
+int gcd(int a, int b) {
+    while (b != 0) {
+        const int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+double bessel_i0(const double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 64 && term > sum * 1e-17; k++) {
+        const double half = x / (2.0 * k);
+        term *= half * half;
+        sum += term;
+    }
+    return sum;
+}
+
+void compute_coefficients(dwm_ma_resampler_t *handle) {
+    const int up = handle->up, tap_count = handle->tap_count;
+    const int max_ratio = up > handle->down ? up : handle->down;
+    const int prototype_count = 2 * DWM_MA_RESAMPLER_ZERO_CROSSINGS * max_ratio + 1;
+    const double center = DWM_MA_RESAMPLER_ZERO_CROSSINGS * max_ratio;
+    const double cutoff = ROLLOFF * 0.5 / max_ratio;
+    const double window_norm = bessel_i0(KAISER_BETA);
+
+    // Prototype sample n goes to phase n mod L, reversed so that the kernels read the window in increasing order
+    for (int p = 0; p < up; p++) {
+        for (int k = 0; k < tap_count; k++) {
+            const int n = p + (tap_count - 1 - k) * up;
+            double value = 0.0;
+            if (n < prototype_count) {
+                const double t = n - center;
+                const double ratio = t / center;
+                const double sinc = t == 0.0 ? 1.0 : sin(2.0 * PI * cutoff * t) / (2.0 * PI * cutoff * t);
+                const double window = bessel_i0(KAISER_BETA * sqrt(fmax(0.0, 1.0 - ratio * ratio))) / window_norm;
+
+                // The gain of L compensates the zeros inserted by upsampling
+                value = up * 2.0 * cutoff * sinc * window;
+            }
+            handle->coefficients[p * tap_count + k] = (float) value;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef DWM_MA_RESAMPLER_H
+#define DWM_MA_RESAMPLER_H
+
+#ifndef DWM_MA_RESAMPLER_ZERO_CROSSINGS
+/**
+ * Zero crossings on each side of the resamplers' windowed sinc, measured at the lower of the two rates: longer filters
+ * have sharper transitions at the cost of latency and computation
+ */
+#define DWM_MA_RESAMPLER_ZERO_CROSSINGS 24
+#endif
+
+/**
+ * Creates a multichannel polyphase resampler converting blocks of any size between two rates
+ * @param resampler address of resampler handle
+ * @param input_rate sampling rate of the input blocks
+ * @param output_rate sampling rate of the output blocks
+ * @param channel_count amount of independently filtered channels
+ * @param input_count largest amount of input samples per block
+ * @return 0 on success, non-zero if the rates or the block size are not valid or the resampler cannot be allocated (the
+ * handle is then set to NULL)
+ * @details The rate ratio is reduced to L / M, and every block is filtered by the L phases of a Kaiser-windowed sinc
+ * prototype, evaluating only the output samples (upsampling by L, filtering and decimating by M in a single pass).
+ * The channels share the phase at which the next block starts, which dwm_ma_resampler_advance moves past each block,
+ * so that blocks need not span whole ratio periods: blocks of a whole amount of periods all start from phase 0
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int dwm_ma_resampler_create(void **resampler, int input_rate, int output_rate, int channel_count, int input_count);
+
+/**
+ * Destroys a resampler
+ * @param resampler address of a valid resampler handle
+ */
+void dwm_ma_resampler_destroy(void **resampler);
+
+/**
+ * Clears the history of every channel and the phase, as if only silence had been processed
+ * @param resampler valid resampler handle
+ */
+void dwm_ma_resampler_reset(void *resampler);
+
+/**
+ * Copies the phase and the history of every channel of another resampler, so that both produce the same output from
+ * then on
+ * @param resampler valid resampler handle
+ * @param source valid resampler handle, created with the same rates and input count
+ * @note Only the channels both resamplers have are copied, the others are cleared
+ */
+void dwm_ma_resampler_copy_state(void *resampler, const void *source);
+
+/**
+ * Amount of output samples a resampler can produce from the next block
+ * @param resampler valid resampler handle
+ * @param input_count amount of input samples of the block, no more than the resampler's input count
+ * @return amount of outputs whose input samples all precede the end of the block, including those left by the previous
+ * blocks
+ */
+int dwm_ma_resampler_available_count(const void *resampler, int input_count);
+
+/**
+ * Resamples a block of a single channel
+ * @param resampler valid resampler handle
+ * @param channel index of the channel, whose history is used and updated
+ * @param in input samples (dimensionality input_count)
+ * @param input_count amount of input samples, no more than the resampler's input count
+ * @param out output samples (dimensionality output_count)
+ * @param output_count amount of output samples, no more than dwm_ma_resampler_available_count and leaving fewer than L
+ * of them to the next block
+ * @note Every channel of a block is processed with the same amounts, dwm_ma_resampler_advance then moving the phase
+ * past the block once
+ */
+void dwm_ma_resampler_process(void *resampler, int channel, const float *in, int input_count, float *out,
+                              int output_count);
+
+/**
+ * Moves the phase of every channel past a block, whether they were processed or not
+ * @param resampler valid resampler handle
+ * @param input_count amount of input samples of the block
+ * @param output_count amount of output samples of the block
+ */
+void dwm_ma_resampler_advance(void *resampler, int input_count, int output_count);
+
+#endif
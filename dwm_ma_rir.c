@@ -0,0 +1,246 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "dwm_ma_rir.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Internal structs and functions declarations
+
+/**
+ * Internal room impulse response file: the whole file, mapped into memory
+ */
+typedef struct {
+    void *memory;
+    size_t size;
+    const dwm_ma_rir_header *header;
+    const float *rirs;
+} dwm_ma_rir_file_t;
+
+/**
+ * Computes the size of a room impulse response file
+ */
+static size_t file_size(int rir_length, int source_count, int receiver_count);
+
+/**
+ * Runs one simulation per emitter, each capturing the responses of all captors
+ * @param handle dwm-ma handle, whose custom layout holds the captors
+ * @param buffer_size buffer size of the dwm-ma instance
+ * @param job extraction parameters
+ * @param emitters_m metric positions of the emitters
+ * @param emitter_count amount of emitters
+ * @param captor_count amount of captors
+ * @param swapped non-zero if the emitters are the job's receivers (and the captors its sources)
+ * @param rirs responses of the file
+ * @return 0 on success, non-zero if the working memory cannot be allocated
+ */
+static int run_simulations(void *handle, int buffer_size, const dwm_ma_rir_job *job, const float (*emitters_m)[3],
+                           int emitter_count, int captor_count, int swapped, float *rirs);
+
+// Function definitions
+
+int dwm_ma_rir_extract(const dwm_ma_mesh_config *config, const dwm_ma_rir_job *job, const char *path) {
+    if (job->source_count < 1 || job->receiver_count < 1 || job->rir_length < 1) {
+        return 1;
+    }
+
+    // Simulate from the smaller set, when swapping sources and receivers is allowed
+    const int swapped = job->reciprocity && job->receiver_count < job->source_count;
+    const float(*emitters_m)[3] = swapped ? job->receivers_m : job->sources_m;
+    const float(*captors_m)[3] = swapped ? job->sources_m : job->receivers_m;
+    const int emitter_count = swapped ? job->receiver_count : job->source_count;
+    const int captor_count = swapped ? job->source_count : job->receiver_count;
+
+    // The captors form a custom layout centered at the mesh's origin, with their coordinates converted as metric
+    // positions are, and a null radius so that the center is never moved
+    void *handle;
+    if (dwm_ma_create_ex(&handle, config) != 0) {
+        return 1;
+    }
+    const float metric_2_junction = (float) config->sample_rate / (_DWM_MA_JUNCTION_SPACING(config->topology) *
+                                                                   config->sound_propagation_speed);
+    float(*captors_j)[3] = malloc(sizeof(float[3]) * captor_count);
+    if (captors_j == NULL) {
+        dwm_ma_destroy(&handle);
+        return 1;
+    }
+    for (int i = 0; i < captor_count; i++) {
+        for (int k = 0; k < 3; k++) {
+            captors_j[i][k] = captors_m[i][k] * metric_2_junction;
+        }
+    }
+    ma_custom_layout *layout;
+    const int layout_result = ma_custom_layout_create(&layout, (const float(*)[3]) captors_j, captor_count);
+    free(captors_j);
+    if (layout_result != 0) {
+        dwm_ma_destroy(&handle);
+        return 1;
+    }
+    layout->radius_j = 0.0f;
+    const int set_result = dwm_ma_set_custom_layout(handle, layout);
+    ma_custom_layout_destroy(&layout);
+    if (set_result != 0) {
+        dwm_ma_destroy(&handle);
+        return 1;
+    }
+    dwm_ma_set_thread_count(handle, job->thread_count);
+
+    // Create the file with its final size, its blocks allocated so that a full disk fails here rather than raising
+    // SIGBUS when the mapped pages are written back, and map it. The positions are written first and the header last,
+    // so that the file is never a valid one until it is complete, and removed on failure (unless it is not a regular
+    // file)
+    const size_t size = file_size(job->rir_length, job->source_count, job->receiver_count);
+    const int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        dwm_ma_destroy(&handle);
+        return 1;
+    }
+    struct stat st;
+    const int regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    char *memory = posix_fallocate(fd, 0, (off_t) size) == 0
+                           ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                           : MAP_FAILED;
+    close(fd);
+    if (memory == MAP_FAILED) {
+        dwm_ma_destroy(&handle);
+        if (regular) {
+            unlink(path);
+        }
+        return 1;
+    }
+    float *positions = (float *) (memory + sizeof(dwm_ma_rir_header));
+    memcpy(positions, job->sources_m, sizeof(float[3]) * job->source_count);
+    memcpy(positions + 3 * job->source_count, job->receivers_m, sizeof(float[3]) * job->receiver_count);
+    float *rirs = positions + 3 * (job->source_count + job->receiver_count);
+
+    int result =
+            run_simulations(handle, config->buffer_size, job, emitters_m, emitter_count, captor_count, swapped, rirs);
+    dwm_ma_destroy(&handle);
+    if (result == 0) {
+        dwm_ma_rir_header *header = (dwm_ma_rir_header *) memory;
+        header->sample_rate = config->sample_rate;
+        header->rir_length = job->rir_length;
+        header->source_count = job->source_count;
+        header->receiver_count = job->receiver_count;
+        memcpy(header->magic, DWM_MA_RIR_MAGIC, sizeof(header->magic));
+    }
+    result |= munmap(memory, size) != 0;
+    if (result != 0 && regular) {
+        unlink(path);
+    }
+    return result;
+}
+
+int dwm_ma_rir_open(void **rir_file, const char *path) {
+    *rir_file = NULL;
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(dwm_ma_rir_header)) {
+        close(fd);
+        return 1;
+    }
+    const size_t size = (size_t) st.st_size;
+    void *memory = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        return 1;
+    }
+
+    // Check the header against the file's size before trusting any of its counts
+    const dwm_ma_rir_header *header = memory;
+    if (memcmp(header->magic, DWM_MA_RIR_MAGIC, sizeof(header->magic)) != 0 || header->rir_length < 1 ||
+        header->source_count < 1 || header->receiver_count < 1 ||
+        file_size(header->rir_length, header->source_count, header->receiver_count) != size) {
+        munmap(memory, size);
+        return 1;
+    }
+    dwm_ma_rir_file_t *handle = malloc(sizeof(dwm_ma_rir_file_t));
+    if (handle == NULL) {
+        munmap(memory, size);
+        return 1;
+    }
+    handle->memory = memory;
+    handle->size = size;
+    handle->header = header;
+    handle->rirs = (const float *) (header + 1) + 3 * (header->source_count + header->receiver_count);
+    *rir_file = handle;
+    return 0;
+}
+
+void dwm_ma_rir_close(void **rir_file) {
+    dwm_ma_rir_file_t *handle = *rir_file;
+    munmap(handle->memory, handle->size);
+    free(handle);
+    *rir_file = NULL;
+}
+
+const dwm_ma_rir_header *dwm_ma_rir_get_header(const void *rir_file) {
+    const dwm_ma_rir_file_t *handle = rir_file;
+    return handle->header;
+}
+
+const float *dwm_ma_rir_get_response(const void *rir_file, const int source, const int receiver) {
+    const dwm_ma_rir_file_t *handle = rir_file;
+    const dwm_ma_rir_header *header = handle->header;
+    return handle->rirs + ((size_t) source * header->receiver_count + receiver) * header->rir_length;
+}
+
+size_t file_size(const int rir_length, const int source_count, const int receiver_count) {
+    return sizeof(dwm_ma_rir_header) + sizeof(float[3]) * ((size_t) source_count + receiver_count) +
+           sizeof(float) * (size_t) source_count * receiver_count * rir_length;
+}
+
+int run_simulations(void *handle, const int buffer_size, const dwm_ma_rir_job *job, const float (*emitters_m)[3],
+                    const int emitter_count, const int captor_count, const int swapped, float *rirs) {
+    // Buffers ending inside the responses are written in place, the last partial one going through a scratch buffer
+    float **ma_buffers = malloc(sizeof(float *) * captor_count);
+    float *scratch = malloc(sizeof(float) * captor_count * buffer_size);
+    float *impulse = calloc(buffer_size, sizeof(float));
+    if (ma_buffers == NULL || scratch == NULL || impulse == NULL) {
+        free(ma_buffers);
+        free(scratch);
+        free(impulse);
+        return 1;
+    }
+
+    for (int e = 0; e < emitter_count; e++) {
+        dwm_ma_init(handle, job->dwm_bound_params, job->dwm_bound_params_normalized);
+        const float *in_positions_m[1] = {emitters_m[e]};
+        for (int n = 0; n < job->rir_length; n += buffer_size) {
+            const int count = job->rir_length - n < buffer_size ? job->rir_length - n : buffer_size;
+            float *rir_begin = rirs + n;
+            for (int c = 0; c < captor_count; c++) {
+                // Swapped simulations capture the response of each source to a single receiver
+                const size_t pair = swapped ? (size_t) c * job->receiver_count + e
+                                            : (size_t) e * job->receiver_count + c;
+                ma_buffers[c] = count == buffer_size ? rir_begin + pair * job->rir_length : scratch + c * buffer_size;
+            }
+
+            // The emitter's impulse is the first sample of the first buffer
+            impulse[0] = n == 0 ? 1.0f : 0.0f;
+            const float *in_buffers[1] = {impulse};
+            dwm_ma_process_interpolated(handle, in_buffers, in_positions_m, 1, MA_CONFIG_CUSTOM, 1.0f, ma_buffers,
+                                        (const float[3]){0.0f, 0.0f, 0.0f});
+            if (count < buffer_size) {
+                for (int c = 0; c < captor_count; c++) {
+                    const size_t pair = swapped ? (size_t) c * job->receiver_count + e
+                                                : (size_t) e * job->receiver_count + c;
+                    memcpy(rir_begin + pair * job->rir_length, ma_buffers[c], sizeof(float) * count);
+                }
+            }
+        }
+    }
+    free(ma_buffers);
+    free(scratch);
+    free(impulse);
+    return 0;
+}
@@ -0,0 +1,120 @@
+#ifndef DWM_MA_RIR_H
+#define DWM_MA_RIR_H
+
+#include "dwm_ma.h"
+
+#include <stdint.h>
+
+/**
+ * Magic bytes opening every room impulse response file
+ */
+#define DWM_MA_RIR_MAGIC "DWMARIR1"
+
+/**
+ * Header of a room impulse response file, all fields being stored in the host's byte order
+ * @details The header is followed by the metric positions of the sources (dimensionality source_count x 3) and of the
+ * receivers (dimensionality receiver_count x 3), and then by the responses of every source and receiver pair (the one
+ * of source s and receiver r starting at (s * receiver_count + r) * rir_length), all of them as 32-bit floats
+ */
+typedef struct {
+    char magic[8];
+    int32_t sample_rate;
+    int32_t rir_length;
+    int32_t source_count;
+    int32_t receiver_count;
+} dwm_ma_rir_header;
+
+/**
+ * Room impulse response extraction parameters
+ */
+typedef struct {
+    /**
+     * Metric positions of each source (dimensionality source_count x 3)
+     */
+    const float (*sources_m)[3];
+    /**
+     * Amount of sources
+     */
+    int source_count;
+    /**
+     * Metric positions of each receiver (dimensionality receiver_count x 3)
+     */
+    const float (*receivers_m)[3];
+    /**
+     * Amount of receivers
+     */
+    int receiver_count;
+    /**
+     * Amount of samples of each response
+     */
+    int rir_length;
+    /**
+     * dwm boundary parameters, in order [Z-,Y-,X-,X+,Y+,Z+], see dwm_ma_init
+     */
+    float dwm_bound_params[6][2];
+    /**
+     * Controls how dwm_bound_params are interpreted, see dwm_ma_init
+     */
+    int dwm_bound_params_normalized;
+    /**
+     * Non-zero to let sources and receivers swap roles when there are fewer receivers than sources, see
+     * dwm_ma_rir_extract
+     */
+    int reciprocity;
+    /**
+     * Amount of threads simulating the mesh, see dwm_ma_set_thread_count
+     */
+    int thread_count;
+} dwm_ma_rir_job;
+
+/**
+ * Extracts the room impulse responses of every source and receiver pair of a room into a file
+ * @param config mesh configuration of the room
+ * @param job extraction parameters
+ * @param path path of the output file, which is created or overwritten
+ * @return 0 on success, non-zero if the configuration or the parameters are not valid, or the file (including its
+ * blocks, allocated upfront) or the dwm-ma instance cannot be created (the file, if created, is then removed)
+ * @details By linearity, a single simulation per source captures the responses of all receivers at once: the source
+ * emits a unit impulse, and every receiver is read as a microphone of a custom layout (see dwm_ma_set_custom_layout).
+ * With job->reciprocity the simulations run from the smaller of both sets, for min(source_count, receiver_count)
+ * simulations in total, the response of a pair being then captured with its source and receiver swapped. The file is
+ * memory-mapped and each simulation writes its responses straight into it, the header being written once all of
+ * them completed
+ * @note Swapped responses are only approximately equal: inputs are lerped into their junctions (acting partly as hard,
+ * thus scattering, sources) while receivers are read passively, and boundary junctions are not updated symmetrically.
+ * Expect differences of a few percent for junction-aligned positions, and larger ones between junctions
+ * @note Allocates memory and performs file I/O, thus it must not be called from a real-time thread
+ */
+int dwm_ma_rir_extract(const dwm_ma_mesh_config *config, const dwm_ma_rir_job *job, const char *path);
+
+/**
+ * Opens a room impulse response file, mapping it read-only into memory
+ * @param rir_file address of file handle
+ * @param path path of the file
+ * @return 0 on success, non-zero if the file cannot be mapped or is not valid (the handle is then set to NULL)
+ */
+int dwm_ma_rir_open(void **rir_file, const char *path);
+
+/**
+ * Unmaps and closes a room impulse response file
+ * @param rir_file address of a valid file handle
+ */
+void dwm_ma_rir_close(void **rir_file);
+
+/**
+ * Header of an open room impulse response file
+ * @param rir_file valid file handle
+ * @return the file's header, valid until the file is closed
+ */
+const dwm_ma_rir_header *dwm_ma_rir_get_header(const void *rir_file);
+
+/**
+ * Response of a source and receiver pair of an open room impulse response file
+ * @param rir_file valid file handle
+ * @param source index of the source
+ * @param receiver index of the receiver
+ * @return the pair's response (dimensionality rir_length), valid until the file is closed
+ */
+const float *dwm_ma_rir_get_response(const void *rir_file, int source, int receiver);
+
+#endif
@@ -0,0 +1,1052 @@
+#include "dwm_ma_simd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define DWM_MA_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+/**
+ * Disables floating point contraction in a function whose target implies FMA, so that it stays bit-exact with the
+ * other kernels. Other compilers rely on the file being compiled with contraction disabled (see CMakeLists.txt)
+ */
+#define NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#define NO_FP_CONTRACT
+#endif
+
+// Kernels declarations
+
+/**
+ * Portable scalar row kernel
+ */
+static void row_kernel_scalar(float *p_aux, const float *p, int count, int stride_x, int stride_y, int stride_z);
+
+#ifdef DWM_MA_SIMD_X86
+/**
+ * SSE2 row kernel, updates 8 junctions per iteration
+ */
+static void row_kernel_sse2(float *p_aux, const float *p, int count, int stride_x, int stride_y, int stride_z);
+
+/**
+ * AVX2 row kernel, updates 8 junctions per iteration
+ */
+static void row_kernel_avx2(float *p_aux, const float *p, int count, int stride_x, int stride_y, int stride_z);
+
+/**
+ * AVX-512 row kernel, updates 16 junctions per iteration with a masked tail
+ */
+static void row_kernel_avx512(float *p_aux, const float *p, int count, int stride_x, int stride_y, int stride_z);
+#endif
+
+/**
+ * Portable scalar half precision row kernel
+ */
+static void row_kernel_f16_scalar(uint16_t *p_aux, const uint16_t *p, int count, int stride_x, int stride_y,
+                                  int stride_z);
+
+/**
+ * Portable scalar bfloat16 row kernel
+ */
+static void row_kernel_bf16_scalar(uint16_t *p_aux, const uint16_t *p, int count, int stride_x, int stride_y,
+                                   int stride_z);
+
+#ifdef DWM_MA_SIMD_X86
+/**
+ * AVX2 and F16C half precision row kernel, updates 8 junctions per iteration
+ */
+static void row_kernel_f16_avx2(uint16_t *p_aux, const uint16_t *p, int count, int stride_x, int stride_y,
+                                int stride_z);
+
+/**
+ * AVX-512 half precision row kernel, updates 16 junctions per iteration
+ */
+static void row_kernel_f16_avx512(uint16_t *p_aux, const uint16_t *p, int count, int stride_x, int stride_y,
+                                  int stride_z);
+
+/**
+ * AVX2 bfloat16 row kernel, updates 8 junctions per iteration
+ */
+static void row_kernel_bf16_avx2(uint16_t *p_aux, const uint16_t *p, int count, int stride_x, int stride_y,
+                                 int stride_z);
+
+/**
+ * AVX-512 bfloat16 row kernel, updates 16 junctions per iteration
+ */
+static void row_kernel_bf16_avx512(uint16_t *p_aux, const uint16_t *p, int count, int stride_x, int stride_y,
+                                   int stride_z);
+#endif
+
+/**
+ * Portable scalar interpolated row kernel
+ */
+static void interpolated_row_kernel_scalar(float *p_aux, const float *p, int count, int stride_x, int stride_y,
+                                           int stride_z);
+
+#ifdef DWM_MA_SIMD_X86
+/**
+ * SSE2 interpolated row kernel, updates 4 junctions per iteration
+ */
+static void interpolated_row_kernel_sse2(float *p_aux, const float *p, int count, int stride_x, int stride_y,
+                                         int stride_z);
+
+/**
+ * AVX2 interpolated row kernel, updates 8 junctions per iteration
+ */
+static void interpolated_row_kernel_avx2(float *p_aux, const float *p, int count, int stride_x, int stride_y,
+                                         int stride_z);
+
+/**
+ * AVX-512 interpolated row kernel, updates 16 junctions per iteration
+ */
+static void interpolated_row_kernel_avx512(float *p_aux, const float *p, int count, int stride_x, int stride_y,
+                                           int stride_z);
+#endif
+
+/**
+ * Portable scalar boundary kernel
+ */
+static void boundary_kernel_scalar(float *values, float *t1, float *t2, float *t3, int count, const float r[2]);
+
+#ifdef DWM_MA_SIMD_X86
+/**
+ * SSE2 boundary kernel, progresses 4 filters per iteration
+ */
+static void boundary_kernel_sse2(float *values, float *t1, float *t2, float *t3, int count, const float r[2]);
+
+/**
+ * AVX2 boundary kernel, progresses 8 filters per iteration
+ */
+static void boundary_kernel_avx2(float *values, float *t1, float *t2, float *t3, int count, const float r[2]);
+
+/**
+ * AVX-512 boundary kernel, progresses 16 filters per iteration with a masked tail
+ */
+static void boundary_kernel_avx512(float *values, float *t1, float *t2, float *t3, int count, const float r[2]);
+#endif
+
+/**
+ * Portable scalar boundary kernel with per filter values
+ */
+static void boundary_map_kernel_scalar(float *values, float *t1, float *t2, float *t3, int count, const float *r1,
+                                       const float *r2);
+
+#ifdef DWM_MA_SIMD_X86
+/**
+ * SSE2 boundary kernel with per filter values, progresses 4 filters per iteration
+ */
+static void boundary_map_kernel_sse2(float *values, float *t1, float *t2, float *t3, int count, const float *r1,
+                                     const float *r2);
+
+/**
+ * AVX2 boundary kernel with per filter values, progresses 8 filters per iteration
+ */
+static void boundary_map_kernel_avx2(float *values, float *t1, float *t2, float *t3, int count, const float *r1,
+                                     const float *r2);
+
+/**
+ * AVX-512 boundary kernel with per filter values, progresses 16 filters per iteration with a masked tail
+ */
+static void boundary_map_kernel_avx512(float *values, float *t1, float *t2, float *t3, int count, const float *r1,
+                                       const float *r2);
+#endif
+
+/**
+ * Portable scalar encoding kernel
+ */
+static void encode_kernel_scalar(float *const *out, const float *const *in, const float *matrix, int out_count,
+                                 int in_count, int count);
+
+#ifdef DWM_MA_SIMD_X86
+/**
+ * AVX2 encoding kernel, computes 8 samples of 4 outputs per iteration
+ */
+static void encode_kernel_avx2(float *const *out, const float *const *in, const float *matrix, int out_count,
+                               int in_count, int count);
+
+/**
+ * AVX-512 encoding kernel, computes 16 samples of 4 outputs per iteration with a masked tail
+ */
+static void encode_kernel_avx512(float *const *out, const float *const *in, const float *matrix, int out_count,
+                                 int in_count, int count);
+#endif
+
+/**
+ * Portable scalar FIR kernel
+ */
+static void fir_kernel_scalar(float *out, const float *in, const float *coefficients, int tap_count, int count,
+                              int stride);
+
+#ifdef DWM_MA_SIMD_X86
+/**
+ * AVX2 FIR kernel, computes 8 output samples per iteration, gathering the inputs when strided
+ */
+static void fir_kernel_avx2(float *out, const float *in, const float *coefficients, int tap_count, int count,
+                            int stride);
+
+/**
+ * AVX-512 FIR kernel, computes 16 output samples per iteration with a masked tail, gathering the inputs when strided
+ */
+static void fir_kernel_avx512(float *out, const float *in, const float *coefficients, int tap_count, int count,
+                              int stride);
+#endif
+
+/**
+ * Portable scalar complex multiply-accumulate kernel
+ */
+static void cmac_kernel_scalar(float *acc_re, float *acc_im, const float *a_re, const float *a_im, const float *b_re,
+                               const float *b_im, int count);
+
+#ifdef DWM_MA_SIMD_X86
+/**
+ * AVX2 complex multiply-accumulate kernel, progresses 8 elements per iteration
+ */
+static void cmac_kernel_avx2(float *acc_re, float *acc_im, const float *a_re, const float *a_im, const float *b_re,
+                             const float *b_im, int count);
+
+/**
+ * AVX-512 complex multiply-accumulate kernel, progresses 16 elements per iteration with a masked tail
+ */
+static void cmac_kernel_avx512(float *acc_re, float *acc_im, const float *a_re, const float *a_im, const float *b_re,
+                               const float *b_im, int count);
+#endif
+
+// Function definitions
+
+dwm_ma_row_kernel_t dwm_ma_simd_select_row_kernel(void) {
+#ifdef DWM_MA_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return row_kernel_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return row_kernel_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return row_kernel_sse2;
+    }
+#endif
+    return row_kernel_scalar;
+}
+
+dwm_ma_row_kernel_16_t dwm_ma_simd_select_row_kernel_f16(void) {
+#ifdef DWM_MA_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return row_kernel_f16_avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c")) {
+        return row_kernel_f16_avx2;
+    }
+#endif
+    return row_kernel_f16_scalar;
+}
+
+dwm_ma_row_kernel_16_t dwm_ma_simd_select_row_kernel_bf16(void) {
+#ifdef DWM_MA_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return row_kernel_bf16_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return row_kernel_bf16_avx2;
+    }
+#endif
+    return row_kernel_bf16_scalar;
+}
+
+dwm_ma_row_kernel_t dwm_ma_simd_select_interpolated_row_kernel(void) {
+#ifdef DWM_MA_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return interpolated_row_kernel_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return interpolated_row_kernel_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return interpolated_row_kernel_sse2;
+    }
+#endif
+    return interpolated_row_kernel_scalar;
+}
+
+dwm_ma_boundary_kernel_t dwm_ma_simd_select_boundary_kernel(void) {
+#ifdef DWM_MA_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return boundary_kernel_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return boundary_kernel_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return boundary_kernel_sse2;
+    }
+#endif
+    return boundary_kernel_scalar;
+}
+
+dwm_ma_boundary_map_kernel_t dwm_ma_simd_select_boundary_map_kernel(void) {
+#ifdef DWM_MA_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return boundary_map_kernel_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return boundary_map_kernel_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return boundary_map_kernel_sse2;
+    }
+#endif
+    return boundary_map_kernel_scalar;
+}
+
+dwm_ma_encode_kernel_t dwm_ma_simd_select_encode_kernel(void) {
+#ifdef DWM_MA_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return encode_kernel_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return encode_kernel_avx2;
+    }
+#endif
+    return encode_kernel_scalar;
+}
+
+dwm_ma_fir_kernel_t dwm_ma_simd_select_fir_kernel(void) {
+#ifdef DWM_MA_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return fir_kernel_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return fir_kernel_avx2;
+    }
+#endif
+    return fir_kernel_scalar;
+}
+
+dwm_ma_cmac_kernel_t dwm_ma_simd_select_cmac_kernel(void) {
+#ifdef DWM_MA_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return cmac_kernel_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return cmac_kernel_avx2;
+    }
+#endif
+    return cmac_kernel_scalar;
+}
+
+// All kernels sum the neighbours in the same order as the scalar update and divide (instead of multiplying by the
+// reciprocal), so that the output is bit-exact regardless of the selected kernel
+
+void row_kernel_scalar(float *p_aux, const float *p, const int count, const int stride_x, const int stride_y,
+                       const int stride_z) {
+    for (int x = 0; x < count; x++) {
+        float sum = p[x - stride_z] + p[x - stride_y] + p[x - stride_x];
+        sum = sum + p[x + stride_x] + p[x + stride_y] + p[x + stride_z];
+        p_aux[x] = sum / 3.0f - p_aux[x];
+    }
+}
+
+void row_kernel_f16_scalar(uint16_t *p_aux, const uint16_t *p, const int count, const int stride_x, const int stride_y,
+                           const int stride_z) {
+    for (int x = 0; x < count; x++) {
+        float sum = dwm_ma_f16_to_f32(p[x - stride_z]) + dwm_ma_f16_to_f32(p[x - stride_y]) +
+                    dwm_ma_f16_to_f32(p[x - stride_x]);
+        sum = sum + dwm_ma_f16_to_f32(p[x + stride_x]) + dwm_ma_f16_to_f32(p[x + stride_y]) +
+              dwm_ma_f16_to_f32(p[x + stride_z]);
+        p_aux[x] = dwm_ma_f32_to_f16(sum / 3.0f - dwm_ma_f16_to_f32(p_aux[x]));
+    }
+}
+
+void row_kernel_bf16_scalar(uint16_t *p_aux, const uint16_t *p, const int count, const int stride_x,
+                            const int stride_y, const int stride_z) {
+    for (int x = 0; x < count; x++) {
+        float sum = dwm_ma_bf16_to_f32(p[x - stride_z]) + dwm_ma_bf16_to_f32(p[x - stride_y]) +
+                    dwm_ma_bf16_to_f32(p[x - stride_x]);
+        sum = sum + dwm_ma_bf16_to_f32(p[x + stride_x]) + dwm_ma_bf16_to_f32(p[x + stride_y]) +
+              dwm_ma_bf16_to_f32(p[x + stride_z]);
+        p_aux[x] = dwm_ma_f32_to_bf16(sum / 3.0f - dwm_ma_bf16_to_f32(p_aux[x]));
+    }
+}
+
+// Interpolated kernels go through a row a chunk at a time: the column sums of the chunk's junctions (their 3 x 3
+// neighbours in the Y-Z plane, weighted 1-2-1 along both axes) are computed first, then each junction combines the
+// column sums of its X neighbours and itself with the same weights. All kernels add in the same order and the
+// multiplications are by powers of two, thus exact, so that the output is bit-exact regardless of the selected kernel
+
+/**
+ * Amount of junctions whose column sums an interpolated row kernel keeps at once
+ */
+#define INTERPOLATED_CHUNK 256
+
+void interpolated_row_kernel_scalar(float *p_aux, const float *p, const int count, const int stride_x,
+                                    const int stride_y, const int stride_z) {
+    float columns[INTERPOLATED_CHUNK + 2];
+    for (int x = 0; x < count; x += INTERPOLATED_CHUNK) {
+        const int n = count - x < INTERPOLATED_CHUNK ? count - x : INTERPOLATED_CHUNK;
+        for (int k = 0; k < n + 2; k++) {
+            const float *c = p + x + k - stride_x;
+            const float zn = c[-stride_z - stride_y] + c[-stride_z + stride_y] + (c[-stride_z] + c[-stride_z]);
+            const float z0 = c[-stride_y] + c[stride_y] + (c[0] + c[0]);
+            const float zp = c[stride_z - stride_y] + c[stride_z + stride_y] + (c[stride_z] + c[stride_z]);
+            columns[k] = zn + zp + (z0 + z0);
+        }
+        for (int k = 0; k < n; k++) {
+            const float sum = columns[k] + columns[k + 2] + (columns[k + 1] + columns[k + 1]);
+            p_aux[x + k] = sum * 0.0625f - (p[x + k] + p[x + k]) - p_aux[x + k];
+        }
+    }
+}
+
+// Boundary kernels keep every multiplication and addition separate (the AVX-512 one disables floating point
+// contraction, see NO_FP_CONTRACT), so that they are bit-exact as well
+
+void boundary_kernel_scalar(float *values, float *t1, float *t2, float *t3, const int count, const float r[2]) {
+    const float r2 = 1 + r[1];
+    for (int i = 0; i < count; i++) {
+        const float aux = values[i] - t1[i];
+        values[i] = r[0] * (aux + t3[i]) + r2 * t2[i];
+        t3[i] = t2[i];
+        t1[i] = values[i] - t2[i];
+        t2[i] = aux;
+    }
+}
+
+void boundary_map_kernel_scalar(float *values, float *t1, float *t2, float *t3, const int count, const float *r1,
+                                const float *r2) {
+    for (int i = 0; i < count; i++) {
+        const float aux = values[i] - t1[i];
+        values[i] = r1[i] * (aux + t3[i]) + (1 + r2[i]) * t2[i];
+        t3[i] = t2[i];
+        t1[i] = values[i] - t2[i];
+        t2[i] = aux;
+    }
+}
+
+// Encoding kernels accumulate the products of each input in input order, without contraction, so that they are
+// bit-exact as well
+
+void encode_kernel_scalar(float *const *out, const float *const *in, const float *matrix, const int out_count,
+                          const int in_count, const int count) {
+    for (int k = 0; k < out_count; k++) {
+        const float *row = matrix + k * in_count;
+        for (int n = 0; n < count; n++) {
+            float sum = 0.0f;
+            for (int m = 0; m < in_count; m++) {
+                sum = sum + row[m] * in[m][n];
+            }
+            out[k][n] = sum;
+        }
+    }
+}
+
+// FIR kernels accumulate the products in coefficient order, without contraction, so that they are bit-exact as well
+
+void fir_kernel_scalar(float *out, const float *in, const float *coefficients, const int tap_count, const int count,
+                       const int stride) {
+    for (int u = 0; u < count; u++) {
+        const float *window = in + u * stride;
+        float sum = 0.0f;
+        for (int k = 0; k < tap_count; k++) {
+            sum = sum + coefficients[k] * window[k];
+        }
+        out[u] = sum;
+    }
+}
+
+// Complex multiply-accumulate kernels compute each product's parts before accumulating them, without contraction, so
+// that they are bit-exact as well
+
+void cmac_kernel_scalar(float *acc_re, float *acc_im, const float *a_re, const float *a_im, const float *b_re,
+                        const float *b_im, const int count) {
+    for (int k = 0; k < count; k++) {
+        const float re = a_re[k] * b_re[k] - a_im[k] * b_im[k];
+        const float im = a_re[k] * b_im[k] + a_im[k] * b_re[k];
+        acc_re[k] = acc_re[k] + re;
+        acc_im[k] = acc_im[k] + im;
+    }
+}
+
+#ifdef DWM_MA_SIMD_X86
+
+__attribute__((target("sse2"))) void row_kernel_sse2(float *p_aux, const float *p, const int count,
+                                                     const int stride_x, const int stride_y, const int stride_z) {
+    const __m128 three = _mm_set1_ps(3.0f);
+    int x = 0;
+
+#define STEP(OFF)                                                                                                      \
+    {                                                                                                                  \
+        __m128 sum = _mm_add_ps(_mm_loadu_ps(p + x + (OFF) - stride_z), _mm_loadu_ps(p + x + (OFF) - stride_y));      \
+        sum = _mm_add_ps(sum, _mm_loadu_ps(p + x + (OFF) - stride_x));                                                 \
+        sum = _mm_add_ps(sum, _mm_loadu_ps(p + x + (OFF) + stride_x));                                                 \
+        sum = _mm_add_ps(sum, _mm_loadu_ps(p + x + (OFF) + stride_y));                                                 \
+        sum = _mm_add_ps(sum, _mm_loadu_ps(p + x + (OFF) + stride_z));                                                 \
+        _mm_storeu_ps(p_aux + x + (OFF), _mm_sub_ps(_mm_div_ps(sum, three), _mm_loadu_ps(p_aux + x + (OFF))));      \
+    }
+    for (; x + 8 <= count; x += 8) {
+        STEP(0)
+        STEP(4)
+    }
+    for (; x + 4 <= count; x += 4) {
+        STEP(0)
+    }
+#undef STEP
+
+    row_kernel_scalar(p_aux + x, p + x, count - x, stride_x, stride_y, stride_z);
+}
+
+__attribute__((target("avx2"))) void row_kernel_avx2(float *p_aux, const float *p, const int count,
+                                                     const int stride_x, const int stride_y, const int stride_z) {
+    const __m256 three = _mm256_set1_ps(3.0f);
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m256 sum = _mm256_add_ps(_mm256_loadu_ps(p + x - stride_z), _mm256_loadu_ps(p + x - stride_y));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(p + x - stride_x));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(p + x + stride_x));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(p + x + stride_y));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(p + x + stride_z));
+        _mm256_storeu_ps(p_aux + x, _mm256_sub_ps(_mm256_div_ps(sum, three), _mm256_loadu_ps(p_aux + x)));
+    }
+    row_kernel_scalar(p_aux + x, p + x, count - x, stride_x, stride_y, stride_z);
+}
+
+__attribute__((target("avx512f"))) void row_kernel_avx512(float *p_aux, const float *p, const int count,
+                                                          const int stride_x, const int stride_y, const int stride_z) {
+    const __m512 three = _mm512_set1_ps(3.0f);
+    for (int x = 0; x < count; x += 16) {
+        // Full mask for all iterations bar the last one, which may be partial
+        const __mmask16 m = count - x >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << (count - x)) - 1u);
+        __m512 sum =
+                _mm512_add_ps(_mm512_maskz_loadu_ps(m, p + x - stride_z), _mm512_maskz_loadu_ps(m, p + x - stride_y));
+        sum = _mm512_add_ps(sum, _mm512_maskz_loadu_ps(m, p + x - stride_x));
+        sum = _mm512_add_ps(sum, _mm512_maskz_loadu_ps(m, p + x + stride_x));
+        sum = _mm512_add_ps(sum, _mm512_maskz_loadu_ps(m, p + x + stride_y));
+        sum = _mm512_add_ps(sum, _mm512_maskz_loadu_ps(m, p + x + stride_z));
+        _mm512_mask_storeu_ps(p_aux + x, m,
+                              _mm512_sub_ps(_mm512_div_ps(sum, three), _mm512_maskz_loadu_ps(m, p_aux + x)));
+    }
+}
+
+__attribute__((target("sse2"))) void boundary_kernel_sse2(float *values, float *t1, float *t2, float *t3,
+                                                          const int count, const float r[2]) {
+    const __m128 r1 = _mm_set1_ps(r[0]), r2 = _mm_set1_ps(1 + r[1]);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 t2_old = _mm_loadu_ps(t2 + i);
+        const __m128 aux = _mm_sub_ps(_mm_loadu_ps(values + i), _mm_loadu_ps(t1 + i));
+        const __m128 out =
+                _mm_add_ps(_mm_mul_ps(r1, _mm_add_ps(aux, _mm_loadu_ps(t3 + i))), _mm_mul_ps(r2, t2_old));
+        _mm_storeu_ps(values + i, out);
+        _mm_storeu_ps(t3 + i, t2_old);
+        _mm_storeu_ps(t1 + i, _mm_sub_ps(out, t2_old));
+        _mm_storeu_ps(t2 + i, aux);
+    }
+    boundary_kernel_scalar(values + i, t1 + i, t2 + i, t3 + i, count - i, r);
+}
+
+__attribute__((target("avx2"))) void boundary_kernel_avx2(float *values, float *t1, float *t2, float *t3,
+                                                          const int count, const float r[2]) {
+    const __m256 r1 = _mm256_set1_ps(r[0]), r2 = _mm256_set1_ps(1 + r[1]);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 t2_old = _mm256_loadu_ps(t2 + i);
+        const __m256 aux = _mm256_sub_ps(_mm256_loadu_ps(values + i), _mm256_loadu_ps(t1 + i));
+        const __m256 out = _mm256_add_ps(_mm256_mul_ps(r1, _mm256_add_ps(aux, _mm256_loadu_ps(t3 + i))),
+                                         _mm256_mul_ps(r2, t2_old));
+        _mm256_storeu_ps(values + i, out);
+        _mm256_storeu_ps(t3 + i, t2_old);
+        _mm256_storeu_ps(t1 + i, _mm256_sub_ps(out, t2_old));
+        _mm256_storeu_ps(t2 + i, aux);
+    }
+    boundary_kernel_scalar(values + i, t1 + i, t2 + i, t3 + i, count - i, r);
+}
+
+__attribute__((target("avx512f"))) NO_FP_CONTRACT void
+boundary_kernel_avx512(float *values, float *t1, float *t2, float *t3, const int count, const float r[2]) {
+    const __m512 r1 = _mm512_set1_ps(r[0]), r2 = _mm512_set1_ps(1 + r[1]);
+    for (int i = 0; i < count; i += 16) {
+        // Full mask for all iterations bar the last one, which may be partial
+        const __mmask16 m = count - i >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << (count - i)) - 1u);
+        const __m512 t2_old = _mm512_maskz_loadu_ps(m, t2 + i);
+        const __m512 aux = _mm512_sub_ps(_mm512_maskz_loadu_ps(m, values + i), _mm512_maskz_loadu_ps(m, t1 + i));
+        const __m512 out = _mm512_add_ps(_mm512_mul_ps(r1, _mm512_add_ps(aux, _mm512_maskz_loadu_ps(m, t3 + i))),
+                                         _mm512_mul_ps(r2, t2_old));
+        _mm512_mask_storeu_ps(values + i, m, out);
+        _mm512_mask_storeu_ps(t3 + i, m, t2_old);
+        _mm512_mask_storeu_ps(t1 + i, m, _mm512_sub_ps(out, t2_old));
+        _mm512_mask_storeu_ps(t2 + i, m, aux);
+    }
+}
+
+__attribute__((target("sse2"))) void boundary_map_kernel_sse2(float *values, float *t1, float *t2, float *t3,
+                                                              const int count, const float *r1, const float *r2) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 t2_old = _mm_loadu_ps(t2 + i);
+        const __m128 aux = _mm_sub_ps(_mm_loadu_ps(values + i), _mm_loadu_ps(t1 + i));
+        const __m128 out = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(r1 + i), _mm_add_ps(aux, _mm_loadu_ps(t3 + i))),
+                                      _mm_mul_ps(_mm_add_ps(one, _mm_loadu_ps(r2 + i)), t2_old));
+        _mm_storeu_ps(values + i, out);
+        _mm_storeu_ps(t3 + i, t2_old);
+        _mm_storeu_ps(t1 + i, _mm_sub_ps(out, t2_old));
+        _mm_storeu_ps(t2 + i, aux);
+    }
+    boundary_map_kernel_scalar(values + i, t1 + i, t2 + i, t3 + i, count - i, r1 + i, r2 + i);
+}
+
+__attribute__((target("avx2"))) void boundary_map_kernel_avx2(float *values, float *t1, float *t2, float *t3,
+                                                              const int count, const float *r1, const float *r2) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 t2_old = _mm256_loadu_ps(t2 + i);
+        const __m256 aux = _mm256_sub_ps(_mm256_loadu_ps(values + i), _mm256_loadu_ps(t1 + i));
+        const __m256 out =
+                _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(r1 + i), _mm256_add_ps(aux, _mm256_loadu_ps(t3 + i))),
+                              _mm256_mul_ps(_mm256_add_ps(one, _mm256_loadu_ps(r2 + i)), t2_old));
+        _mm256_storeu_ps(values + i, out);
+        _mm256_storeu_ps(t3 + i, t2_old);
+        _mm256_storeu_ps(t1 + i, _mm256_sub_ps(out, t2_old));
+        _mm256_storeu_ps(t2 + i, aux);
+    }
+    boundary_map_kernel_scalar(values + i, t1 + i, t2 + i, t3 + i, count - i, r1 + i, r2 + i);
+}
+
+__attribute__((target("avx512f"))) NO_FP_CONTRACT void
+boundary_map_kernel_avx512(float *values, float *t1, float *t2, float *t3, const int count, const float *r1,
+                           const float *r2) {
+    const __m512 one = _mm512_set1_ps(1.0f);
+    for (int i = 0; i < count; i += 16) {
+        // Full mask for all iterations bar the last one, which may be partial
+        const __mmask16 m = count - i >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << (count - i)) - 1u);
+        const __m512 t2_old = _mm512_maskz_loadu_ps(m, t2 + i);
+        const __m512 aux = _mm512_sub_ps(_mm512_maskz_loadu_ps(m, values + i), _mm512_maskz_loadu_ps(m, t1 + i));
+        const __m512 out = _mm512_add_ps(
+                _mm512_mul_ps(_mm512_maskz_loadu_ps(m, r1 + i), _mm512_add_ps(aux, _mm512_maskz_loadu_ps(m, t3 + i))),
+                _mm512_mul_ps(_mm512_add_ps(one, _mm512_maskz_loadu_ps(m, r2 + i)), t2_old));
+        _mm512_mask_storeu_ps(values + i, m, out);
+        _mm512_mask_storeu_ps(t3 + i, m, t2_old);
+        _mm512_mask_storeu_ps(t1 + i, m, _mm512_sub_ps(out, t2_old));
+        _mm512_mask_storeu_ps(t2 + i, m, aux);
+    }
+}
+
+// 16-bit kernels convert to single precision in registers and share the single precision update. Their partial last
+// vector is updated ahead of the main loop, while it still holds the previous step values, and merged with the updated
+// junctions afterwards (16-bit values convert back exactly), rows shorter than a vector are processed by the scalar
+// kernels, whose conversions round exactly as the SIMD ones
+
+/**
+ * AVX2 single precision update of 8 junctions, given their neighbours in summation order and their previous values
+ */
+__attribute__((target("avx2"))) static inline __m256 update_avx2(const __m256 zn, const __m256 yn, const __m256 xn,
+                                                                 const __m256 xp, const __m256 yp, const __m256 zp,
+                                                                 const __m256 aux) {
+    __m256 sum = _mm256_add_ps(zn, yn);
+    sum = _mm256_add_ps(sum, xn);
+    sum = _mm256_add_ps(sum, xp);
+    sum = _mm256_add_ps(sum, yp);
+    sum = _mm256_add_ps(sum, zp);
+    return _mm256_sub_ps(_mm256_div_ps(sum, _mm256_set1_ps(3.0f)), aux);
+}
+
+/**
+ * AVX-512 single precision update of 16 junctions, see update_avx2
+ */
+__attribute__((target("avx512f"))) static inline __m512 update_avx512(const __m512 zn, const __m512 yn, const __m512 xn,
+                                                                      const __m512 xp, const __m512 yp,
+                                                                      const __m512 zp, const __m512 aux) {
+    __m512 sum = _mm512_add_ps(zn, yn);
+    sum = _mm512_add_ps(sum, xn);
+    sum = _mm512_add_ps(sum, xp);
+    sum = _mm512_add_ps(sum, yp);
+    sum = _mm512_add_ps(sum, zp);
+    return _mm512_sub_ps(_mm512_div_ps(sum, _mm512_set1_ps(3.0f)), aux);
+}
+
+/**
+ * AVX2 conversion of 8 single precision values to bfloat16, rounding as dwm_ma_f32_to_bf16
+ */
+__attribute__((target("avx2"))) static inline __m128i f32_to_bf16_avx2(const __m256 v) {
+    const __m256i u = _mm256_castps_si256(v), upper = _mm256_srli_epi32(u, 16);
+    const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+    const __m256i rounding = _mm256_add_epi32(_mm256_set1_epi32(0x7FFF), _mm256_and_si256(upper, _mm256_set1_epi32(1)));
+    __m256i h = _mm256_add_epi32(u, rounding);
+    h = _mm256_blendv_epi8(_mm256_srli_epi32(h, 16), _mm256_or_si256(upper, _mm256_set1_epi32(0x40)), nan);
+    return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(h, h), 0x08));
+}
+
+/**
+ * AVX-512 conversion of 16 single precision values to bfloat16, rounding as dwm_ma_f32_to_bf16
+ */
+__attribute__((target("avx512f"))) static inline __m256i f32_to_bf16_avx512(const __m512 v) {
+    const __m512i u = _mm512_castps_si512(v), upper = _mm512_srli_epi32(u, 16);
+    const __mmask16 nan = _mm512_cmp_ps_mask(v, v, _CMP_UNORD_Q);
+    const __m512i rounding = _mm512_add_epi32(_mm512_set1_epi32(0x7FFF), _mm512_and_si512(upper, _mm512_set1_epi32(1)));
+    __m512i h = _mm512_add_epi32(u, rounding);
+    h = _mm512_mask_blend_epi32(nan, _mm512_srli_epi32(h, 16), _mm512_or_si512(upper, _mm512_set1_epi32(0x40)));
+    return _mm512_cvtepi32_epi16(h);
+}
+
+#define UPDATE(UPDATE_FUNCTION, X)                                                                                     \
+    UPDATE_FUNCTION(LOAD(p + (X) - stride_z), LOAD(p + (X) - stride_y), LOAD(p + (X) - stride_x),                      \
+                    LOAD(p + (X) + stride_x), LOAD(p + (X) + stride_y), LOAD(p + (X) + stride_z), LOAD(p_aux + (X)))
+
+__attribute__((target("avx2,f16c"))) void row_kernel_f16_avx2(uint16_t *p_aux, const uint16_t *p, const int count,
+                                                              const int stride_x, const int stride_y,
+                                                              const int stride_z) {
+#define LOAD(ADDRESS) _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *) (ADDRESS)))
+#define STORE(ADDRESS, V) _mm_storeu_si128((__m128i *) (ADDRESS), _mm256_cvtps_ph(V, _MM_FROUND_TO_NEAREST_INT))
+    if (count < 8) {
+        row_kernel_f16_scalar(p_aux, p, count, stride_x, stride_y, stride_z);
+        return;
+    }
+    const int last = count - 8;
+    const __m256 last_v = UPDATE(update_avx2, last);
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        STORE(p_aux + x, UPDATE(update_avx2, x));
+    }
+    if (x < count) {
+        const __m256 merge = _mm256_cmp_ps(_mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_ps((float) (x - last)),
+                                           _CMP_GE_OQ);
+        STORE(p_aux + last, _mm256_blendv_ps(LOAD(p_aux + last), last_v, merge));
+    }
+#undef LOAD
+#undef STORE
+}
+
+__attribute__((target("avx512f"))) void row_kernel_f16_avx512(uint16_t *p_aux, const uint16_t *p, const int count,
+                                                              const int stride_x, const int stride_y,
+                                                              const int stride_z) {
+#define LOAD(ADDRESS) _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *) (ADDRESS)))
+#define STORE(ADDRESS, V)                                                                                              \
+    _mm256_storeu_si256((__m256i *) (ADDRESS), _mm512_cvtps_ph(V, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC))
+    if (count < 16) {
+        row_kernel_f16_scalar(p_aux, p, count, stride_x, stride_y, stride_z);
+        return;
+    }
+    const int last = count - 16;
+    const __m512 last_v = UPDATE(update_avx512, last);
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        STORE(p_aux + x, UPDATE(update_avx512, x));
+    }
+    if (x < count) {
+        const __mmask16 merge = (__mmask16) (0xFFFFu << (x - last));
+        STORE(p_aux + last, _mm512_mask_blend_ps(merge, LOAD(p_aux + last), last_v));
+    }
+#undef LOAD
+#undef STORE
+}
+
+__attribute__((target("avx2"))) void row_kernel_bf16_avx2(uint16_t *p_aux, const uint16_t *p, const int count,
+                                                          const int stride_x, const int stride_y, const int stride_z) {
+#define LOAD(ADDRESS)                                                                                                  \
+    _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (ADDRESS))), 16))
+#define STORE(ADDRESS, V) _mm_storeu_si128((__m128i *) (ADDRESS), f32_to_bf16_avx2(V))
+    if (count < 8) {
+        row_kernel_bf16_scalar(p_aux, p, count, stride_x, stride_y, stride_z);
+        return;
+    }
+    const int last = count - 8;
+    const __m256 last_v = UPDATE(update_avx2, last);
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        STORE(p_aux + x, UPDATE(update_avx2, x));
+    }
+    if (x < count) {
+        const __m256 merge = _mm256_cmp_ps(_mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_ps((float) (x - last)),
+                                           _CMP_GE_OQ);
+        STORE(p_aux + last, _mm256_blendv_ps(LOAD(p_aux + last), last_v, merge));
+    }
+#undef LOAD
+#undef STORE
+}
+
+__attribute__((target("avx512f"))) void row_kernel_bf16_avx512(uint16_t *p_aux, const uint16_t *p, const int count,
+                                                               const int stride_x, const int stride_y,
+                                                               const int stride_z) {
+#define LOAD(ADDRESS)                                                                                                  \
+    _mm512_castsi512_ps(                                                                                               \
+            _mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *) (ADDRESS))), 16))
+#define STORE(ADDRESS, V) _mm256_storeu_si256((__m256i *) (ADDRESS), f32_to_bf16_avx512(V))
+    if (count < 16) {
+        row_kernel_bf16_scalar(p_aux, p, count, stride_x, stride_y, stride_z);
+        return;
+    }
+    const int last = count - 16;
+    const __m512 last_v = UPDATE(update_avx512, last);
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        STORE(p_aux + x, UPDATE(update_avx512, x));
+    }
+    if (x < count) {
+        const __mmask16 merge = (__mmask16) (0xFFFFu << (x - last));
+        STORE(p_aux + last, _mm512_mask_blend_ps(merge, LOAD(p_aux + last), last_v));
+    }
+#undef LOAD
+#undef STORE
+}
+
+#undef UPDATE
+
+// SIMD interpolated kernels share a single body for all instruction sets, given the LOAD and STORE of the junction
+// values. The partial last vector of a chunk's column sums is computed again overlapping the previous one, and the
+// one of its junctions is updated ahead of the main loop, while it still holds the previous step values, and stored
+// afterwards over junctions which are then rewritten with the same values. Chunks shorter than a vector are processed
+// by the scalar kernel
+
+#define INTERPOLATED_ROW(WIDTH, VECTOR, PREFIX, SCALAR_KERNEL)                                                         \
+    float columns[INTERPOLATED_CHUNK + 2];                                                                             \
+    for (int x = 0; x < count; x += INTERPOLATED_CHUNK) {                                                              \
+        const int n = count - x < INTERPOLATED_CHUNK ? count - x : INTERPOLATED_CHUNK;                                 \
+        if (n < (WIDTH)) {                                                                                             \
+            SCALAR_KERNEL(p_aux + x, p + x, n, stride_x, stride_y, stride_z);                                          \
+            continue;                                                                                                  \
+        }                                                                                                              \
+        for (int k = 0; k < n + 2; k += (WIDTH)) {                                                                     \
+            const int c = k + (WIDTH) <= n + 2 ? k : n + 2 - (WIDTH);                                                  \
+            VECTOR planes[3];                                                                                          \
+            for (int o = 0; o < 3; o++) {                                                                              \
+                const int i = x + c - stride_x + (o - 1) * stride_z;                                                   \
+                const VECTOR mid = LOAD(p + i);                                                                        \
+                planes[o] = PREFIX##_add_ps(PREFIX##_add_ps(LOAD(p + i - stride_y), LOAD(p + i + stride_y)),           \
+                                            PREFIX##_add_ps(mid, mid));                                                \
+            }                                                                                                          \
+            PREFIX##_storeu_ps(columns + c, PREFIX##_add_ps(PREFIX##_add_ps(planes[0], planes[2]),                     \
+                                                            PREFIX##_add_ps(planes[1], planes[1])));                   \
+        }                                                                                                              \
+        const VECTOR last = INTERPOLATED_UPDATE(VECTOR, PREFIX, n - (WIDTH));                                          \
+        int k = 0;                                                                                                     \
+        for (; k + (WIDTH) <= n; k += (WIDTH)) {                                                                       \
+            STORE(p_aux + x + k, INTERPOLATED_UPDATE(VECTOR, PREFIX, k));                                              \
+        }                                                                                                              \
+        if (k < n) {                                                                                                   \
+            STORE(p_aux + x + n - (WIDTH), last);                                                                      \
+        }                                                                                                              \
+    }
+
+#define INTERPOLATED_UPDATE(VECTOR, PREFIX, K)                                                                         \
+    PREFIX##_sub_ps(                                                                                                   \
+            PREFIX##_sub_ps(                                                                                           \
+                    PREFIX##_mul_ps(PREFIX##_add_ps(PREFIX##_add_ps(PREFIX##_loadu_ps(columns + (K)),                  \
+                                                                    PREFIX##_loadu_ps(columns + (K) + 2)),             \
+                                                    PREFIX##_add_ps(PREFIX##_loadu_ps(columns + (K) + 1),              \
+                                                                    PREFIX##_loadu_ps(columns + (K) + 1))),            \
+                                    PREFIX##_set1_ps(0.0625f)),                                                        \
+                    PREFIX##_add_ps(LOAD(p + x + (K)), LOAD(p + x + (K)))),                                            \
+            LOAD(p_aux + x + (K)))
+
+__attribute__((target("sse2"))) void interpolated_row_kernel_sse2(float *p_aux, const float *p, const int count,
+                                                                  const int stride_x, const int stride_y,
+                                                                  const int stride_z) {
+#define LOAD(ADDRESS) _mm_loadu_ps(ADDRESS)
+#define STORE(ADDRESS, V) _mm_storeu_ps(ADDRESS, V)
+    INTERPOLATED_ROW(4, __m128, _mm, interpolated_row_kernel_scalar)
+#undef LOAD
+#undef STORE
+}
+
+__attribute__((target("avx2"))) void interpolated_row_kernel_avx2(float *p_aux, const float *p, const int count,
+                                                                  const int stride_x, const int stride_y,
+                                                                  const int stride_z) {
+#define LOAD(ADDRESS) _mm256_loadu_ps(ADDRESS)
+#define STORE(ADDRESS, V) _mm256_storeu_ps(ADDRESS, V)
+    INTERPOLATED_ROW(8, __m256, _mm256, interpolated_row_kernel_scalar)
+#undef LOAD
+#undef STORE
+}
+
+__attribute__((target("avx512f"))) NO_FP_CONTRACT void
+interpolated_row_kernel_avx512(float *p_aux, const float *p, const int count, const int stride_x, const int stride_y,
+                               const int stride_z) {
+#define LOAD(ADDRESS) _mm512_loadu_ps(ADDRESS)
+#define STORE(ADDRESS, V) _mm512_storeu_ps(ADDRESS, V)
+    INTERPOLATED_ROW(16, __m512, _mm512, interpolated_row_kernel_scalar)
+#undef LOAD
+#undef STORE
+}
+
+#undef INTERPOLATED_UPDATE
+#undef INTERPOLATED_ROW
+
+__attribute__((target("avx2"))) void encode_kernel_avx2(float *const *out, const float *const *in,
+                                                        const float *matrix, const int out_count, const int in_count,
+                                                        const int count) {
+    int n = 0;
+    for (; n + 8 <= count; n += 8) {
+        // Blocks of 4 outputs share each input load
+        int k = 0;
+        for (; k + 4 <= out_count; k += 4) {
+            const float *row = matrix + k * in_count;
+            __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+            __m256 sum2 = _mm256_setzero_ps(), sum3 = _mm256_setzero_ps();
+            for (int m = 0; m < in_count; m++) {
+                const __m256 v = _mm256_loadu_ps(in[m] + n);
+                sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_set1_ps(row[m]), v));
+                sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_set1_ps(row[in_count + m]), v));
+                sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(_mm256_set1_ps(row[2 * in_count + m]), v));
+                sum3 = _mm256_add_ps(sum3, _mm256_mul_ps(_mm256_set1_ps(row[3 * in_count + m]), v));
+            }
+            _mm256_storeu_ps(out[k] + n, sum0);
+            _mm256_storeu_ps(out[k + 1] + n, sum1);
+            _mm256_storeu_ps(out[k + 2] + n, sum2);
+            _mm256_storeu_ps(out[k + 3] + n, sum3);
+        }
+        for (; k < out_count; k++) {
+            const float *row = matrix + k * in_count;
+            __m256 sum = _mm256_setzero_ps();
+            for (int m = 0; m < in_count; m++) {
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(row[m]), _mm256_loadu_ps(in[m] + n)));
+            }
+            _mm256_storeu_ps(out[k] + n, sum);
+        }
+    }
+    for (int k = 0; k < out_count; k++) {
+        const float *row = matrix + k * in_count;
+        for (int t = n; t < count; t++) {
+            float sum = 0.0f;
+            for (int m = 0; m < in_count; m++) {
+                sum = sum + row[m] * in[m][t];
+            }
+            out[k][t] = sum;
+        }
+    }
+}
+
+__attribute__((target("avx512f"))) NO_FP_CONTRACT void
+encode_kernel_avx512(float *const *out, const float *const *in, const float *matrix, const int out_count,
+                     const int in_count, const int count) {
+    for (int n = 0; n < count; n += 16) {
+        // Full mask for all iterations bar the last one, which may be partial, and blocks of 4 outputs sharing each
+        // input load
+        const __mmask16 mask = count - n >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << (count - n)) - 1u);
+        int k = 0;
+        for (; k + 4 <= out_count; k += 4) {
+            const float *row = matrix + k * in_count;
+            __m512 sum0 = _mm512_setzero_ps(), sum1 = _mm512_setzero_ps();
+            __m512 sum2 = _mm512_setzero_ps(), sum3 = _mm512_setzero_ps();
+            for (int m = 0; m < in_count; m++) {
+                const __m512 v = _mm512_maskz_loadu_ps(mask, in[m] + n);
+                sum0 = _mm512_add_ps(sum0, _mm512_mul_ps(_mm512_set1_ps(row[m]), v));
+                sum1 = _mm512_add_ps(sum1, _mm512_mul_ps(_mm512_set1_ps(row[in_count + m]), v));
+                sum2 = _mm512_add_ps(sum2, _mm512_mul_ps(_mm512_set1_ps(row[2 * in_count + m]), v));
+                sum3 = _mm512_add_ps(sum3, _mm512_mul_ps(_mm512_set1_ps(row[3 * in_count + m]), v));
+            }
+            _mm512_mask_storeu_ps(out[k] + n, mask, sum0);
+            _mm512_mask_storeu_ps(out[k + 1] + n, mask, sum1);
+            _mm512_mask_storeu_ps(out[k + 2] + n, mask, sum2);
+            _mm512_mask_storeu_ps(out[k + 3] + n, mask, sum3);
+        }
+        for (; k < out_count; k++) {
+            const float *row = matrix + k * in_count;
+            __m512 sum = _mm512_setzero_ps();
+            for (int m = 0; m < in_count; m++) {
+                sum = _mm512_add_ps(sum,
+                                    _mm512_mul_ps(_mm512_set1_ps(row[m]), _mm512_maskz_loadu_ps(mask, in[m] + n)));
+            }
+            _mm512_mask_storeu_ps(out[k] + n, mask, sum);
+        }
+    }
+}
+
+__attribute__((target("avx2"))) void fir_kernel_avx2(float *out, const float *in, const float *coefficients,
+                                                     const int tap_count, const int count, const int stride) {
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+    int u = 0;
+    for (; u + 8 <= count; u += 8) {
+        const float *window = in + u * stride;
+        __m256 sum = _mm256_setzero_ps();
+        if (stride == 1) {
+            for (int k = 0; k < tap_count; k++) {
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(coefficients[k]), _mm256_loadu_ps(window + k)));
+            }
+        } else {
+            for (int k = 0; k < tap_count; k++) {
+                const __m256 v = _mm256_i32gather_ps(window + k, offsets, 4);
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(coefficients[k]), v));
+            }
+        }
+        _mm256_storeu_ps(out + u, sum);
+    }
+    for (; u < count; u++) {
+        const float *window = in + u * stride;
+        float sum = 0.0f;
+        for (int k = 0; k < tap_count; k++) {
+            sum = sum + coefficients[k] * window[k];
+        }
+        out[u] = sum;
+    }
+}
+
+__attribute__((target("avx512f"))) NO_FP_CONTRACT void
+fir_kernel_avx512(float *out, const float *in, const float *coefficients, const int tap_count, const int count,
+                  const int stride) {
+    const __m512i offsets = _mm512_mullo_epi32(
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(stride));
+    for (int u = 0; u < count; u += 16) {
+        // Full mask for all iterations bar the last one, which may be partial, so that no input past the last window
+        // is read
+        const __mmask16 mask = count - u >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << (count - u)) - 1u);
+        const float *window = in + u * stride;
+        __m512 sum = _mm512_setzero_ps();
+        if (stride == 1) {
+            for (int k = 0; k < tap_count; k++) {
+                const __m512 v = _mm512_maskz_loadu_ps(mask, window + k);
+                sum = _mm512_add_ps(sum, _mm512_mul_ps(_mm512_set1_ps(coefficients[k]), v));
+            }
+        } else {
+            for (int k = 0; k < tap_count; k++) {
+                const __m512 v = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, offsets, window + k, 4);
+                sum = _mm512_add_ps(sum, _mm512_mul_ps(_mm512_set1_ps(coefficients[k]), v));
+            }
+        }
+        _mm512_mask_storeu_ps(out + u, mask, sum);
+    }
+}
+
+__attribute__((target("avx2"))) void cmac_kernel_avx2(float *acc_re, float *acc_im, const float *a_re,
+                                                      const float *a_im, const float *b_re, const float *b_im,
+                                                      const int count) {
+    int k = 0;
+    for (; k + 8 <= count; k += 8) {
+        const __m256 ar = _mm256_loadu_ps(a_re + k), ai = _mm256_loadu_ps(a_im + k);
+        const __m256 br = _mm256_loadu_ps(b_re + k), bi = _mm256_loadu_ps(b_im + k);
+        const __m256 re = _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi));
+        const __m256 im = _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br));
+        _mm256_storeu_ps(acc_re + k, _mm256_add_ps(_mm256_loadu_ps(acc_re + k), re));
+        _mm256_storeu_ps(acc_im + k, _mm256_add_ps(_mm256_loadu_ps(acc_im + k), im));
+    }
+    for (; k < count; k++) {
+        const float re = a_re[k] * b_re[k] - a_im[k] * b_im[k];
+        const float im = a_re[k] * b_im[k] + a_im[k] * b_re[k];
+        acc_re[k] = acc_re[k] + re;
+        acc_im[k] = acc_im[k] + im;
+    }
+}
+
+__attribute__((target("avx512f"))) NO_FP_CONTRACT void
+cmac_kernel_avx512(float *acc_re, float *acc_im, const float *a_re, const float *a_im, const float *b_re,
+                   const float *b_im, const int count) {
+    for (int k = 0; k < count; k += 16) {
+        // Full mask for all iterations bar the last one, which may be partial
+        const __mmask16 mask = count - k >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << (count - k)) - 1u);
+        const __m512 ar = _mm512_maskz_loadu_ps(mask, a_re + k), ai = _mm512_maskz_loadu_ps(mask, a_im + k);
+        const __m512 br = _mm512_maskz_loadu_ps(mask, b_re + k), bi = _mm512_maskz_loadu_ps(mask, b_im + k);
+        const __m512 re = _mm512_sub_ps(_mm512_mul_ps(ar, br), _mm512_mul_ps(ai, bi));
+        const __m512 im = _mm512_add_ps(_mm512_mul_ps(ar, bi), _mm512_mul_ps(ai, br));
+        _mm512_mask_storeu_ps(acc_re + k, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, acc_re + k), re));
+        _mm512_mask_storeu_ps(acc_im + k, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, acc_im + k), im));
+    }
+}
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef DWM_MA_SIMD_H
+#define DWM_MA_SIMD_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Junction row update kernel, progresses count contiguous non-boundary junction values by one step
+ * @param p_aux previous step pressure of the first junction, overwritten with the next step pressure
+ * @param p current step pressure of the first junction
+ * @param count amount of contiguous values to be updated
+ * @param stride_x linearized index distance between two neighbouring junctions along the X-axis
+ * @param stride_y linearized index distance between two neighbouring junctions along the Y-axis
+ * @param stride_z linearized index distance between two neighbouring junctions along the Z-axis
+ * @note The caller must guarantee that every neighbour of the updated junctions is a valid mesh junction
+ */
+typedef void (*dwm_ma_row_kernel_t)(float *p_aux, const float *p, int count, int stride_x, int stride_y,
+                                    int stride_z);
+
+/**
+ * Junction row update kernel for meshes stored as 16-bit floating point values, see dwm_ma_row_kernel_t
+ * @note Values are converted to 32-bit floating point, updated exactly as by dwm_ma_row_kernel_t and rounded back to
+ * nearest (ties to even) 16-bit values
+ */
+typedef void (*dwm_ma_row_kernel_16_t)(uint16_t *p_aux, const uint16_t *p, int count, int stride_x, int stride_y,
+                                       int stride_z);
+
+/**
+ * Boundary filter kernel, progresses count boundary filters by one step, see dwm_boundary_t in dwm_ma.c
+ * @param values input sample of each filter, overwritten with the filtered sample
+ * @param t1 first state of each filter
+ * @param t2 second state of each filter
+ * @param t3 third state of each filter
+ * @param count amount of filters to be progressed
+ * @param r R1 and R2 filter values shared by all filters
+ */
+typedef void (*dwm_ma_boundary_kernel_t)(float *values, float *t1, float *t2, float *t3, int count, const float r[2]);
+
+/**
+ * Boundary filter kernel with per filter values, progresses count boundary filters by one step as
+ * dwm_ma_boundary_kernel_t does
+ * @param values input sample of each filter, overwritten with the filtered sample
+ * @param t1 first state of each filter
+ * @param t2 second state of each filter
+ * @param t3 third state of each filter
+ * @param count amount of filters to be progressed
+ * @param r1 R1 filter value of each filter
+ * @param r2 R2 filter value of each filter
+ */
+typedef void (*dwm_ma_boundary_map_kernel_t)(float *values, float *t1, float *t2, float *t3, int count,
+                                             const float *r1, const float *r2);
+
+/**
+ * Matrix encoding kernel, computes each output sample as the dot product of a matrix row with the input samples
+ * @param out samples of each output (dimensionality out_count x count)
+ * @param in samples of each input (dimensionality in_count x count)
+ * @param matrix row-major matrix (dimensionality out_count x in_count)
+ * @param out_count amount of outputs
+ * @param in_count amount of inputs
+ * @param count amount of samples
+ */
+typedef void (*dwm_ma_encode_kernel_t)(float *const *out, const float *const *in, const float *matrix, int out_count,
+                                       int in_count, int count);
+
+/**
+ * Strided FIR kernel, computes each output sample as the dot product of the coefficients with a window of the input
+ * @param out output samples (dimensionality count)
+ * @param in input samples, output u reads in[u * stride + k] for every k < tap_count
+ * @param coefficients filter coefficients (dimensionality tap_count)
+ * @param tap_count amount of coefficients
+ * @param count amount of output samples
+ * @param stride input advance between consecutive output samples
+ */
+typedef void (*dwm_ma_fir_kernel_t)(float *out, const float *in, const float *coefficients, int tap_count, int count,
+                                    int stride);
+
+/**
+ * Complex multiply-accumulate kernel over split real and imaginary arrays, computes acc += a * b for each element
+ * @param acc_re real parts of the accumulators (dimensionality count)
+ * @param acc_im imaginary parts of the accumulators (dimensionality count)
+ * @param a_re real parts of the first factors (dimensionality count)
+ * @param a_im imaginary parts of the first factors (dimensionality count)
+ * @param b_re real parts of the second factors (dimensionality count)
+ * @param b_im imaginary parts of the second factors (dimensionality count)
+ * @param count amount of elements
+ */
+typedef void (*dwm_ma_cmac_kernel_t)(float *acc_re, float *acc_im, const float *a_re, const float *a_im,
+                                     const float *b_re, const float *b_im, int count);
+
+/**
+ * Selects the fastest junction row update kernel supported by the running CPU
+ * @return the selected kernel, a portable scalar kernel is returned when no SIMD extension is available
+ */
+dwm_ma_row_kernel_t dwm_ma_simd_select_row_kernel(void);
+
+/**
+ * Selects the fastest IEEE 754 half precision junction row update kernel supported by the running CPU
+ * @return the selected kernel, a portable scalar kernel is returned when F16C is not available
+ */
+dwm_ma_row_kernel_16_t dwm_ma_simd_select_row_kernel_f16(void);
+
+/**
+ * Selects the fastest bfloat16 junction row update kernel supported by the running CPU
+ * @return the selected kernel, a portable scalar kernel is returned when no SIMD extension is available
+ */
+dwm_ma_row_kernel_16_t dwm_ma_simd_select_row_kernel_bf16(void);
+
+/**
+ * Selects the fastest interpolated junction row update kernel supported by the running CPU, which updates the
+ * junctions as DWM_MA_TOPOLOGY_INTERPOLATED does (see dwm_ma.h) instead of rectilinearly
+ * @return the selected kernel, a portable scalar kernel is returned when no SIMD extension is available
+ * @note The caller must guarantee that all 26 neighbours of the updated junctions are valid mesh junctions, and the
+ * kernel's stride_x must be 1
+ */
+dwm_ma_row_kernel_t dwm_ma_simd_select_interpolated_row_kernel(void);
+
+/**
+ * Selects the fastest boundary filter kernel supported by the running CPU
+ * @return the selected kernel, a portable scalar kernel is returned when no SIMD extension is available
+ */
+dwm_ma_boundary_kernel_t dwm_ma_simd_select_boundary_kernel(void);
+
+/**
+ * Selects the fastest boundary filter kernel with per filter values supported by the running CPU
+ * @return the selected kernel, a portable scalar kernel is returned when no SIMD extension is available
+ */
+dwm_ma_boundary_map_kernel_t dwm_ma_simd_select_boundary_map_kernel(void);
+
+/**
+ * Selects the fastest matrix encoding kernel supported by the running CPU
+ * @return the selected kernel, a portable scalar kernel is returned when no SIMD extension is available
+ */
+dwm_ma_encode_kernel_t dwm_ma_simd_select_encode_kernel(void);
+
+/**
+ * Selects the fastest strided FIR kernel supported by the running CPU
+ * @return the selected kernel, a portable scalar kernel is returned when no SIMD extension is available
+ */
+dwm_ma_fir_kernel_t dwm_ma_simd_select_fir_kernel(void);
+
+/**
+ * Selects the fastest complex multiply-accumulate kernel supported by the running CPU
+ * @return the selected kernel, a portable scalar kernel is returned when no SIMD extension is available
+ */
+dwm_ma_cmac_kernel_t dwm_ma_simd_select_cmac_kernel(void);
+
+// Scalar conversions between 32-bit and 16-bit floating point values, defined inline since they are used by every
+// junction access of a 16-bit mesh. Conversions to 16 bits round to nearest (ties to even), as the SIMD conversions do
+
+/**
+ * Converts an IEEE 754 half precision value to single precision
+ */
+static inline float dwm_ma_f16_to_f32(const uint16_t h) {
+    const uint32_t exponent = (h >> 10) & 0x1Fu, mantissa = h & 0x3FFu;
+    uint32_t u;
+    if (exponent == 0) {
+        // Zero or subnormal, an exact multiple of 2^-24
+        const float v = (float) mantissa * 5.9604644775390625e-8f;
+        return h & 0x8000u ? -v : v;
+    }
+    if (exponent == 0x1Fu) {
+        u = 0x7F800000u | (mantissa << 13) | (mantissa != 0 ? 0x400000u : 0); // Infinity or quiet NaN
+    } else {
+        u = ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    u |= (uint32_t) (h & 0x8000u) << 16;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/**
+ * Converts a single precision value to IEEE 754 half precision
+ */
+static inline uint16_t dwm_ma_f32_to_f16(const float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    const uint16_t sign = (uint16_t) ((u >> 16) & 0x8000u);
+    u &= 0x7FFFFFFFu;
+    if (u > 0x7F800000u) {
+        return sign | 0x7E00u | ((u >> 13) & 0x3FFu); // Quiet NaN, keeping the upper payload bits
+    }
+    if (u >= 0x477FF000u) {
+        return sign | 0x7C00u; // Infinity, or rounded to infinity
+    }
+    if (u >= 0x38800000u) {
+        // Normal, rebias the exponent and round the dropped 13 mantissa bits (carries propagate into the exponent)
+        u -= 0x38000000u;
+        return sign | (uint16_t) ((u + 0xFFFu + ((u >> 13) & 1u)) >> 13);
+    }
+    if (u <= 0x33000000u) {
+        return sign; // Rounded to zero, 2^-25 being a tie
+    }
+    // Subnormal, in units of 2^-24
+    const uint32_t shift = 126 - (u >> 23), mantissa = (u & 0x7FFFFFu) | 0x800000u;
+    return sign | (uint16_t) ((mantissa + (1u << (shift - 1)) - 1u + ((mantissa >> shift) & 1u)) >> shift);
+}
+
+/**
+ * Converts a bfloat16 value to single precision
+ */
+static inline float dwm_ma_bf16_to_f32(const uint16_t h) {
+    const uint32_t u = (uint32_t) h << 16;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/**
+ * Converts a single precision value to bfloat16
+ */
+static inline uint16_t dwm_ma_f32_to_bf16(const float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    if ((u & 0x7FFFFFFFu) > 0x7F800000u) {
+        return (uint16_t) ((u >> 16) | 0x40u); // Quiet NaN
+    }
+    return (uint16_t) ((u + 0x7FFFu + ((u >> 16) & 1u)) >> 16);
+}
+
+#endif
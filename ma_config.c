@@ -2,6 +2,49 @@
 
 #include "dwm_ma.h"
 
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Microphone of a runtime layout being sorted
+ */
+typedef struct {
+    float xyz_j[3];
+    int channel;
+} ma_custom_mic;
+
+/**
+ * Orders microphones by Z, then Y and then X coordinate, and then by output channel
+ */
+static int compare_custom_mics(const void *a, const void *b);
+
+/**
+ * Computes the real spherical harmonics of a direction, ACN channel ordering with SN3D normalization
+ * @param order highest order computed
+ * @param azimuth direction's azimuth, in radians
+ * @param elevation direction's elevation, in radians
+ * @param sh resulting value of each spherical harmonic (dimensionality (order + 1)^2)
+ */
+static void compute_spherical_harmonics(int order, double azimuth, double elevation, double *sh);
+
+/**
+ * Factorizes in place a symmetric positive definite matrix as L * L^T (Cholesky), L being stored in the lower triangle
+ * @param a row-major matrix (dimensionality size x size)
+ * @param size matrix size
+ * @return non-zero if the matrix is numerically singular
+ */
+static int cholesky_decompose(double *a, int size);
+
+/**
+ * Solves L * L^T * x = b in place, L being the lower triangle of a matrix factorized by cholesky_decompose
+ * @param l factorized matrix (dimensionality size x size)
+ * @param size matrix size
+ * @param x right hand side b, overwritten with the solution x (dimensionality size)
+ */
+static void cholesky_solve(const double *l, int size, double *x);
+
 static const ma_layout MA_CONFIG_MONO_layout = {
         0.f,
         1,
@@ -323,3 +366,232 @@ const ma_layout *ma_config_layout(const MA_CONFIG ma_config) {
             return &MA_CONFIG_MONO_layout;
     }
 }
+
+int compare_custom_mics(const void *a, const void *b) {
+    const ma_custom_mic *mic_a = a, *mic_b = b;
+    for (int k = 2; k >= 0; k--) {
+        if (mic_a->xyz_j[k] != mic_b->xyz_j[k]) {
+            return mic_a->xyz_j[k] < mic_b->xyz_j[k] ? -1 : 1;
+        }
+    }
+    return mic_a->channel - mic_b->channel;
+}
+
+int ma_custom_layout_create(ma_custom_layout **layout, const float mic_rel_xyz_j[][3], const int channel_count) {
+    *layout = NULL;
+    if (channel_count < 1) {
+        return 1;
+    }
+    for (int i = 0; i < channel_count; i++) {
+        for (int k = 0; k < 3; k++) {
+            if (!isfinite(mic_rel_xyz_j[i][k])) {
+                return 1;
+            }
+        }
+    }
+
+    // Sort the microphones by linearized mesh index, remembering the output channel of each
+    ma_custom_mic *mics = malloc(sizeof(ma_custom_mic) * channel_count);
+    if (mics == NULL) {
+        return 1;
+    }
+    for (int i = 0; i < channel_count; i++) {
+        for (int k = 0; k < 3; k++) {
+            mics[i].xyz_j[k] = mic_rel_xyz_j[i][k];
+        }
+        mics[i].channel = i;
+    }
+    qsort(mics, channel_count, sizeof(ma_custom_mic), compare_custom_mics);
+
+    // Allocate the whole layout as a single memory block
+    ma_custom_layout *result = malloc(sizeof(ma_custom_layout) + (sizeof(float[3]) + sizeof(int)) * channel_count);
+    if (result == NULL) {
+        free(mics);
+        return 1;
+    }
+    result->channel_count = channel_count;
+    result->mic_rel_xyz_j = (float(*)[3])(result + 1);
+    result->channels = (int *) (result->mic_rel_xyz_j + channel_count);
+    result->radius_j = 0.0f;
+    for (int i = 0; i < channel_count; i++) {
+        for (int k = 0; k < 3; k++) {
+            result->mic_rel_xyz_j[i][k] = mics[i].xyz_j[k];
+        }
+        result->channels[i] = mics[i].channel;
+        result->radius_j = fmaxf(result->radius_j, sqrtf(mics[i].xyz_j[0] * mics[i].xyz_j[0] +
+                                                         mics[i].xyz_j[1] * mics[i].xyz_j[1] +
+                                                         mics[i].xyz_j[2] * mics[i].xyz_j[2]));
+    }
+    free(mics);
+    *layout = result;
+    return 0;
+}
+
+int ma_custom_layout_load(ma_custom_layout **layout, const char *path) {
+    *layout = NULL;
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return 1;
+    }
+
+    // Read one microphone per line, growing the coordinate list as needed
+    float(*coordinates)[3] = NULL;
+    int count = 0, capacity = 0, valid = 1;
+    char line[256];
+    while (valid && fgets(line, sizeof(line), file) != NULL) {
+        float xyz_j[3];
+        char first, extra;
+        if (sscanf(line, " %c", &first) != 1 || first == '#') {
+            continue; // Empty line or comment
+        }
+        if (sscanf(line, "%f %f %f %c", &xyz_j[0], &xyz_j[1], &xyz_j[2], &extra) != 3) {
+            valid = 0;
+            break;
+        }
+        if (count == capacity) {
+            capacity = capacity == 0 ? 64 : 2 * capacity;
+            float(*grown)[3] = realloc(coordinates, sizeof(float[3]) * capacity);
+            if (grown == NULL) {
+                valid = 0;
+                break;
+            }
+            coordinates = grown;
+        }
+        for (int k = 0; k < 3; k++) {
+            coordinates[count][k] = xyz_j[k];
+        }
+        count++;
+    }
+    valid = valid && !ferror(file);
+    fclose(file);
+
+    const int result = valid ? ma_custom_layout_create(layout, (const float(*)[3]) coordinates, count) : 1;
+    free(coordinates);
+    return result;
+}
+
+void ma_custom_layout_destroy(ma_custom_layout **layout) {
+    free(*layout);
+    *layout = NULL;
+}
+
+int ma_ambisonics_encoder(const int order, const float mic_azi_elev[][2], const int channel_count, float *matrix) {
+    if (order < 0 || order > MA_AMBISONICS_MAX_ORDER || channel_count < 1) {
+        return -1;
+    }
+    const int sh_count = (order + 1) * (order + 1);
+    double *sh = malloc(sizeof(double) * sh_count * channel_count);
+    double *gram = malloc(sizeof(double) * sh_count * sh_count);
+    if (sh == NULL || gram == NULL) {
+        free(sh);
+        free(gram);
+        return -1;
+    }
+    for (int m = 0; m < channel_count; m++) {
+        compute_spherical_harmonics(order, mic_azi_elev[m][0], mic_azi_elev[m][1], &sh[m * sh_count]);
+    }
+
+    // Lower the order until the Gram matrix of the array's spherical harmonics is invertible, and then encode each
+    // microphone with its column of the pseudo-inverse, (Y^T * Y)^-1 * Y^T
+    memset(matrix, 0, sizeof(float) * sh_count * channel_count);
+    int resolved = 0;
+    for (int n = order; n >= 0; n--) {
+        const int k = (n + 1) * (n + 1);
+        if (k > channel_count) {
+            continue;
+        }
+        for (int i = 0; i < k; i++) {
+            for (int j = 0; j < k; j++) {
+                double sum = 0.0;
+                for (int m = 0; m < channel_count; m++) {
+                    sum += sh[m * sh_count + i] * sh[m * sh_count + j];
+                }
+                gram[i * k + j] = sum;
+            }
+        }
+        if (cholesky_decompose(gram, k) != 0) {
+            continue;
+        }
+        for (int m = 0; m < channel_count; m++) {
+            cholesky_solve(gram, k, &sh[m * sh_count]);
+            for (int i = 0; i < k; i++) {
+                matrix[i * channel_count + m] = (float) sh[m * sh_count + i];
+            }
+        }
+        resolved = n;
+        break;
+    }
+    free(sh);
+    free(gram);
+    return resolved;
+}
+
+void compute_spherical_harmonics(const int order, const double azimuth, const double elevation, double *sh) {
+    // Associated Legendre functions of sin(elevation) without the Condon-Shortley phase, by increasing degree m
+    const double x = sin(elevation), y = cos(elevation);
+    double legendre[MA_AMBISONICS_MAX_ORDER + 1][MA_AMBISONICS_MAX_ORDER + 1];
+    double diagonal = 1.0;
+    for (int m = 0; m <= order; m++) {
+        diagonal *= m > 0 ? (2 * m - 1) * y : 1.0;
+        legendre[m][m] = diagonal;
+        if (m + 1 <= order) {
+            legendre[m + 1][m] = x * (2 * m + 1) * diagonal;
+        }
+        for (int n = m + 2; n <= order; n++) {
+            legendre[n][m] = ((2 * n - 1) * x * legendre[n - 1][m] - (n + m - 1) * legendre[n - 2][m]) / (n - m);
+        }
+    }
+
+    // SN3D normalization, sqrt((2 - delta_m) * (n - |m|)! / (n + |m|)!)
+    for (int n = 0; n <= order; n++) {
+        for (int m = -n; m <= n; m++) {
+            const int degree = abs(m);
+            double ratio = m == 0 ? 1.0 : 2.0;
+            for (int k = n - degree + 1; k <= n + degree; k++) {
+                ratio /= k;
+            }
+            const double angular = m > 0 ? cos(m * azimuth) : m < 0 ? sin(degree * azimuth) : 1.0;
+            sh[n * n + n + m] = sqrt(ratio) * legendre[n][degree] * angular;
+        }
+    }
+}
+
+int cholesky_decompose(double *a, const int size) {
+    double largest = 0.0;
+    for (int i = 0; i < size; i++) {
+        largest = fmax(largest, a[i * size + i]);
+    }
+    for (int j = 0; j < size; j++) {
+        double pivot = a[j * size + j];
+        for (int k = 0; k < j; k++) {
+            pivot -= a[j * size + k] * a[j * size + k];
+        }
+        if (pivot <= 1e-9 * largest) {
+            return 1;
+        }
+        a[j * size + j] = sqrt(pivot);
+        for (int i = j + 1; i < size; i++) {
+            double value = a[i * size + j];
+            for (int k = 0; k < j; k++) {
+                value -= a[i * size + k] * a[j * size + k];
+            }
+            a[i * size + j] = value / a[j * size + j];
+        }
+    }
+    return 0;
+}
+
+void cholesky_solve(const double *l, const int size, double *x) {
+    for (int i = 0; i < size; i++) {
+        for (int k = 0; k < i; k++) {
+            x[i] -= l[i * size + k] * x[k];
+        }
+        x[i] /= l[i * size + i];
+    }
+    for (int i = size - 1; i >= 0; i--) {
+        for (int k = i + 1; k < size; k++) {
+            x[i] -= l[k * size + i] * x[k];
+        }
+        x[i] /= l[i * size + i];
+    }
+}
@@ -29,6 +29,11 @@ typedef enum {
     MA_CONFIG_24_POINTS_SQRT_11,
     MA_CONFIG_24_POINTS_SQRT_13,
     MA_CONFIG_30_POINTS_SQRT_9,
+    /**
+     * Runtime layout of the dwm-ma instance, see ma_custom_layout and dwm_ma_set_custom_layout
+     * @remark Outputs in the order of the coordinates the layout was created from
+     */
+    MA_CONFIG_CUSTOM,
 } MA_CONFIG;
 
 /**
@@ -62,4 +67,80 @@ typedef struct {
 
 const ma_layout *ma_config_layout(MA_CONFIG ma_config);
 
+/**
+ * Maximum Ambisonics order of an encoder, see ma_ambisonics_encoder
+ */
+#define MA_AMBISONICS_MAX_ORDER 7
+
+/**
+ * Computes the matrix encoding the channels of a microphone array to Ambisonics, ACN channel ordering with SN3D
+ * normalization (AmbiX)
+ * @param order Ambisonics order, in [0, MA_AMBISONICS_MAX_ORDER]
+ * @param mic_azi_elev azimuth-elevation couples for each microphone, in radians, as in ma_layout (dimensionality
+ * channel_count x 2)
+ * @param channel_count amount of microphones
+ * @param matrix resulting row-major encoding matrix, Ambisonics channel k being the dot product of its k-th row with
+ * the microphone samples (dimensionality (order + 1)^2 x channel_count)
+ * @return the highest order resolved by the array, no greater than order, or -1 if order or channel_count are not valid
+ * or the computation cannot allocate its memory
+ * @details Each order is encoded with the pseudo-inverse of the array's spherical harmonics matrix, up to the highest
+ * order whose (order + 1)^2 spherical harmonics the microphones tell apart. Rows of higher orders are zero
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int ma_ambisonics_encoder(int order, const float mic_azi_elev[][2], int channel_count, float *matrix);
+
+/**
+ * Runtime microphone array layout, of any channel count and with fractional junction coordinates
+ */
+typedef struct {
+    /**
+     * Microphone array channels count
+     */
+    int channel_count;
+    /**
+     * Largest distance of a microphone to the center of the array, in junctions
+     */
+    float radius_j;
+    /**
+     * Relative junction X-Y-Z coordinates to the center of the array for each microphone (dimensionality
+     * channel_count x 3)
+     * @remark Sorted by Z, then Y and then X coordinate, that is in the order of the junctions' linearized mesh
+     * indices, so that capturing the array walks the mesh memory forwards
+     */
+    float (*mic_rel_xyz_j)[3];
+    /**
+     * Output channel of each sorted microphone (dimensionality channel_count)
+     */
+    int *channels;
+} ma_custom_layout;
+
+/**
+ * Creates a runtime microphone array layout from a list of coordinates
+ * @param layout address of layout handle
+ * @param mic_rel_xyz_j relative junction X-Y-Z coordinates to the center of the array for each microphone, output
+ * channel c being read at the c-th coordinate (dimensionality channel_count x 3)
+ * @param channel_count amount of microphones
+ * @return 0 on success, non-zero if channel_count is not positive, a coordinate is not finite or the layout cannot be
+ * allocated (the handle is then set to NULL)
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int ma_custom_layout_create(ma_custom_layout **layout, const float mic_rel_xyz_j[][3], int channel_count);
+
+/**
+ * Creates a runtime microphone array layout from a text file
+ * @param layout address of layout handle
+ * @param path path of the file, holding the relative junction X-Y-Z coordinates of one microphone per line (separated
+ * by whitespace), in output channel order. Empty lines and lines starting with '#' are ignored
+ * @return 0 on success, non-zero if the file cannot be read, a line is not valid or as in ma_custom_layout_create
+ * (the handle is then set to NULL)
+ * @note Allocates memory, thus it must not be called from a real-time thread
+ */
+int ma_custom_layout_load(ma_custom_layout **layout, const char *path);
+
+/**
+ * Destroys a runtime microphone array layout
+ * @param layout address of a valid layout handle
+ */
+void ma_custom_layout_destroy(ma_custom_layout **layout);
+
 #endif
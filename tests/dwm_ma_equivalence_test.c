@@ -0,0 +1,310 @@
+#include "dwm_ma.h"
+#include "dwm_ma_batch.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Amount of samples of each processing call, and of each batch processing call
+ */
+#define BUFFER_SIZE 128
+
+/**
+ * Amount of rendered buffers
+ */
+#define BUFFER_COUNT 24
+
+/**
+ * Amount of buffers whose inputs are noise, the following ones being silent
+ */
+#define NOISE_BUFFER_COUNT 6
+
+/**
+ * Amount of rendered samples
+ */
+#define FRAME_COUNT (BUFFER_COUNT * BUFFER_SIZE)
+
+/**
+ * Amount of rendered inputs
+ */
+#define IN_COUNT 2
+
+/**
+ * Microphone array configuration of the rendered scenes
+ */
+#define RENDER_MA_CONFIG MA_CONFIG_6_POINTS_SQRT_1
+
+/**
+ * Amount of channels of RENDER_MA_CONFIG
+ */
+#define CHANNEL_COUNT 6
+
+/**
+ * Amount of instances of the rendered batch, more than a group of lanes so that a group is only partially used
+ */
+#define INSTANCE_COUNT (DWM_MA_BATCH_LANES + 1)
+
+// Internal structs and functions declarations
+
+/**
+ * Processing paths of a dwm-ma instance, all of which must produce the output of RENDER_PLAIN
+ */
+typedef enum {
+    /**
+     * Step by step on the calling thread, a buffer per call
+     */
+    RENDER_PLAIN,
+    /**
+     * Temporal blocking of 5 steps, which does not divide BUFFER_SIZE
+     */
+    RENDER_BLOCKED_5,
+    /**
+     * Temporal blocking of 16 steps
+     */
+    RENDER_BLOCKED_16,
+    /**
+     * Three threads
+     */
+    RENDER_THREADED,
+    /**
+     * Calls of varying sizes, smaller and larger than a buffer, through dwm_ma_process_frames
+     */
+    RENDER_SPLIT,
+} RENDER;
+
+/**
+ * Names of the processing paths, in RENDER order
+ */
+static const char *const RENDER_NAMES[] = {"plain", "blocked (5 steps)", "blocked (16 steps)", "threaded (3 threads)",
+                                           "split calls"};
+
+/**
+ * Sizes of the calls of RENDER_SPLIT, repeated until FRAME_COUNT samples are rendered
+ */
+static const int SPLIT_FRAME_COUNTS[] = {1, 37, 300, 90, 128, 256, 7};
+
+/**
+ * Configuration of the rendered meshes, whose size is neither specialized nor a multiple of the SIMD width
+ */
+static const dwm_ma_mesh_config MESH_CONFIG = {DWM_MA_SAMPLE_RATE, BUFFER_SIZE, 14, 12, 10,
+                                               DWM_MA_SOUND_PROPAGATION_SPEED, DWM_MA_STORAGE_FLOAT32,
+                                               DWM_MA_TOPOLOGY_RECTILINEAR};
+
+/**
+ * Input samples of the rendered scenes (dimensionality IN_COUNT x FRAME_COUNT)
+ */
+static float in_samples[IN_COUNT][FRAME_COUNT];
+
+/**
+ * Reference output of each instance, rendered by RENDER_PLAIN
+ */
+static float references[INSTANCE_COUNT][CHANNEL_COUNT][FRAME_COUNT];
+
+/**
+ * Output of the processing path under test
+ */
+static float outputs[CHANNEL_COUNT][FRAME_COUNT];
+
+/**
+ * Output of each instance of the batch
+ */
+static float batch_outputs[INSTANCE_COUNT][CHANNEL_COUNT][FRAME_COUNT];
+
+/**
+ * Fills in_samples with noise followed by silence
+ */
+static void fill_inputs(void);
+
+/**
+ * Fills the boundary parameters of an instance, different for each instance and face
+ * @param bound_params boundary parameters, in order [Z-,Y-,X-,X+,Y+,Z+]
+ * @param instance index of the instance
+ */
+static void fill_bound_params(float bound_params[6][2], int instance);
+
+/**
+ * Fills the metric positions of an instance's inputs and microphone array
+ * @param in_positions_m positions of each input (dimensionality IN_COUNT x 3)
+ * @param ma_position_m position of the microphone array (dimensionality 1 x 3)
+ * @param instance index of the instance
+ */
+static void fill_positions(float in_positions_m[IN_COUNT][3], float ma_position_m[3], int instance);
+
+/**
+ * Renders the scene of an instance through a processing path
+ * @param out output samples of each channel (dimensionality CHANNEL_COUNT x FRAME_COUNT)
+ * @param path processing path
+ * @param instance index of the instance, whose boundary parameters and positions are rendered
+ * @return 0 on success, non-zero if the mesh cannot be created
+ */
+static int render(float out[CHANNEL_COUNT][FRAME_COUNT], RENDER path, int instance);
+
+/**
+ * Renders the scenes of all instances through a batch
+ * @param out output samples of each instance and channel (dimensionality INSTANCE_COUNT x CHANNEL_COUNT x
+ * FRAME_COUNT)
+ * @return 0 on success, non-zero if the batch cannot be created
+ */
+static int render_batch(float out[INSTANCE_COUNT][CHANNEL_COUNT][FRAME_COUNT]);
+
+/**
+ * Reports whether a rendered output is bit-for-bit the same as the reference
+ * @param name name of the processing path
+ * @param instance index of the rendered instance
+ * @param out rendered output (dimensionality CHANNEL_COUNT x FRAME_COUNT)
+ * @param reference reference output (dimensionality CHANNEL_COUNT x FRAME_COUNT)
+ * @return 0 if the outputs are the same, non-zero otherwise
+ */
+static int report(const char *name, int instance, float out[CHANNEL_COUNT][FRAME_COUNT],
+                  float reference[CHANNEL_COUNT][FRAME_COUNT]);
+
+// Function definitions
+
+int main(void) {
+    fill_inputs();
+    for (int k = 0; k < INSTANCE_COUNT; k++) {
+        if (render(references[k], RENDER_PLAIN, k) != 0) {
+            fprintf(stderr, "cannot create the mesh\n");
+            return 1;
+        }
+    }
+
+    // Every path must reproduce the plain output exactly, not only closely
+    int failed = 0;
+    for (int r = RENDER_PLAIN + 1; r <= RENDER_SPLIT; r++) {
+        if (render(outputs, (RENDER) r, 0) != 0) {
+            fprintf(stderr, "cannot create the mesh\n");
+            return 1;
+        }
+        failed |= report(RENDER_NAMES[r], 0, outputs, references[0]);
+    }
+    if (render_batch(batch_outputs) != 0) {
+        fprintf(stderr, "cannot create the batch\n");
+        return 1;
+    }
+    for (int k = 0; k < INSTANCE_COUNT; k++) {
+        failed |= report("batched", k, batch_outputs[k], references[k]);
+    }
+    return failed;
+}
+
+void fill_inputs(void) {
+    unsigned int seed = 1;
+    for (int i = 0; i < IN_COUNT; i++) {
+        for (int n = 0; n < FRAME_COUNT; n++) {
+            seed = seed * 1103515245u + 12345u;
+            in_samples[i][n] = n < NOISE_BUFFER_COUNT * BUFFER_SIZE ? (float) (seed >> 9) / 4194304.0f - 1.0f : 0.0f;
+        }
+    }
+}
+
+void fill_bound_params(float bound_params[6][2], const int instance) {
+    for (int f = 0; f < 6; f++) {
+        bound_params[f][0] = 0.5f + 0.05f * (float) ((instance + f) % 8);
+        bound_params[f][1] = 0.1f * (float) ((instance * 3 + f) % 9);
+    }
+}
+
+void fill_positions(float in_positions_m[IN_COUNT][3], float ma_position_m[3], const int instance) {
+    const float in_positions_j[IN_COUNT][3] = {{3.3f, 4.2f, 2.7f}, {9.6f, 7.1f, 6.4f}};
+    const float ma_position_j[3] = {7.2f, 5.5f, 4.8f};
+    for (int a = 0; a < 3; a++) {
+        for (int i = 0; i < IN_COUNT; i++) {
+            in_positions_m[i][a] = (in_positions_j[i][a] + 0.1f * (float) instance) * DWM_MA_SIZE_JUNCTION_M;
+        }
+        ma_position_m[a] = (ma_position_j[a] - 0.1f * (float) instance) * DWM_MA_SIZE_JUNCTION_M;
+    }
+}
+
+int render(float out[CHANNEL_COUNT][FRAME_COUNT], const RENDER path, const int instance) {
+    float bound_params[6][2], in_positions_m[IN_COUNT][3], ma_position_m[3];
+    fill_bound_params(bound_params, instance);
+    fill_positions(in_positions_m, ma_position_m, instance);
+    const float *positions_m[IN_COUNT];
+    for (int i = 0; i < IN_COUNT; i++) {
+        positions_m[i] = in_positions_m[i];
+    }
+
+    void *handle;
+    if (dwm_ma_create_ex(&handle, &MESH_CONFIG) != 0) {
+        return 1;
+    }
+    dwm_ma_init(handle, bound_params, 1);
+    if (path == RENDER_BLOCKED_5 || path == RENDER_BLOCKED_16) {
+        dwm_ma_set_temporal_block_size(handle, path == RENDER_BLOCKED_5 ? 5 : 16);
+    } else if (path == RENDER_THREADED) {
+        dwm_ma_set_thread_count(handle, 3);
+    }
+
+    // Each call reads and writes its part of the whole rendering
+    const int split_count = (int) (sizeof(SPLIT_FRAME_COUNTS) / sizeof(SPLIT_FRAME_COUNTS[0]));
+    const float *in_buffers[IN_COUNT];
+    float *ma_buffers[CHANNEL_COUNT];
+    for (int begin = 0, call = 0; begin < FRAME_COUNT; call++) {
+        int frame_count = path == RENDER_SPLIT ? SPLIT_FRAME_COUNTS[call % split_count] : BUFFER_SIZE;
+        if (frame_count > FRAME_COUNT - begin) {
+            frame_count = FRAME_COUNT - begin;
+        }
+        for (int i = 0; i < IN_COUNT; i++) {
+            in_buffers[i] = in_samples[i] + begin;
+        }
+        for (int c = 0; c < CHANNEL_COUNT; c++) {
+            ma_buffers[c] = out[c] + begin;
+        }
+        if (path == RENDER_SPLIT) {
+            dwm_ma_process_frames(handle, in_buffers, positions_m, positions_m, IN_COUNT, RENDER_MA_CONFIG, 1.0f,
+                                  ma_buffers, ma_position_m, ma_position_m, frame_count);
+        } else {
+            dwm_ma_process_interpolated(handle, in_buffers, positions_m, IN_COUNT, RENDER_MA_CONFIG, 1.0f, ma_buffers,
+                                        ma_position_m);
+        }
+        begin += frame_count;
+    }
+    dwm_ma_destroy(&handle);
+    return 0;
+}
+
+int render_batch(float out[INSTANCE_COUNT][CHANNEL_COUNT][FRAME_COUNT]) {
+    void *batch;
+    if (dwm_ma_batch_create(&batch, &MESH_CONFIG, INSTANCE_COUNT) != 0) {
+        return 1;
+    }
+    float in_positions_m[INSTANCE_COUNT][IN_COUNT][3], ma_positions_m[INSTANCE_COUNT][3];
+    const float *positions_m[INSTANCE_COUNT][IN_COUNT];
+    for (int k = 0; k < INSTANCE_COUNT; k++) {
+        float bound_params[6][2];
+        fill_bound_params(bound_params, k);
+        dwm_ma_batch_init(batch, k, bound_params, 1);
+        fill_positions(in_positions_m[k], ma_positions_m[k], k);
+        for (int i = 0; i < IN_COUNT; i++) {
+            positions_m[k][i] = in_positions_m[k][i];
+        }
+    }
+
+    // Every instance reads the same inputs, each from its own positions
+    const float *in_buffers[IN_COUNT];
+    float *ma_buffers[INSTANCE_COUNT][CHANNEL_COUNT];
+    dwm_ma_batch_io io[INSTANCE_COUNT];
+    for (int begin = 0; begin < FRAME_COUNT; begin += BUFFER_SIZE) {
+        for (int i = 0; i < IN_COUNT; i++) {
+            in_buffers[i] = in_samples[i] + begin;
+        }
+        for (int k = 0; k < INSTANCE_COUNT; k++) {
+            for (int c = 0; c < CHANNEL_COUNT; c++) {
+                ma_buffers[k][c] = out[k][c] + begin;
+            }
+            io[k] = (dwm_ma_batch_io) {in_buffers,    positions_m[k], IN_COUNT, RENDER_MA_CONFIG, 1.0f,
+                                       ma_buffers[k], ma_positions_m[k]};
+        }
+        dwm_ma_batch_process_interpolated(batch, io);
+    }
+    dwm_ma_batch_destroy(&batch);
+    return 0;
+}
+
+int report(const char *name, const int instance, float out[CHANNEL_COUNT][FRAME_COUNT],
+           float reference[CHANNEL_COUNT][FRAME_COUNT]) {
+    const int passed = memcmp(out, reference, sizeof(float) * CHANNEL_COUNT * FRAME_COUNT) == 0;
+    printf("%s, instance %d: %s\n", name, instance, passed ? "identical" : "different FAILED");
+    return !passed;
+}
@@ -0,0 +1,135 @@
+#include "dwm_ma.h"
+
+#include <math.h>
+#include <stdio.h>
+
+/**
+ * Amount of samples of each processing call
+ */
+#define BUFFER_SIZE 128
+
+/**
+ * Amount of buffers whose output energy is summed together
+ */
+#define WINDOW_BUFFER_COUNT 25
+
+/**
+ * Amount of measured windows, 3.2 seconds at the default 16 kHz
+ */
+#define WINDOW_COUNT 16
+
+/**
+ * Junctions size of the measured meshes along each axis
+ */
+#define SIZE_J 12
+
+/**
+ * Largest energy of the last window relative to the first one
+ */
+#define FINAL_ENERGY_RATIO 1e-8
+
+// Internal structs and functions declarations
+
+/**
+ * Normalized admittances of the measured meshes, the same on all faces
+ */
+static const float ADMITTANCES[] = {0.99f, 0.1f};
+
+/**
+ * Renders the impulse response of an interpolated mesh and sums its energy over each window
+ * @param energies output energy of each window (dimensionality WINDOW_COUNT)
+ * @param admittance normalized admittance of all faces
+ * @return 0 on success, non-zero if the mesh cannot be created
+ */
+static int render_energies(double energies[WINDOW_COUNT], float admittance);
+
+/**
+ * Checks that an interpolated mesh cannot be created with a storage format
+ * @param storage storage format of the mesh
+ * @return 0 if the configuration is rejected, non-zero otherwise
+ */
+static int check_rejected(DWM_MA_STORAGE storage);
+
+// Function definitions
+
+int main(void) {
+    int failed = 0;
+    if (check_rejected(DWM_MA_STORAGE_FLOAT16) != 0 || check_rejected(DWM_MA_STORAGE_BFLOAT16) != 0) {
+        fprintf(stderr, "interpolated meshes with 16-bit storage are not rejected\n");
+        failed = 1;
+    }
+    for (int a = 0; a < (int) (sizeof(ADMITTANCES) / sizeof(ADMITTANCES[0])); a++) {
+        double energies[WINDOW_COUNT];
+        if (render_energies(energies, ADMITTANCES[a]) != 0) {
+            fprintf(stderr, "cannot create the interpolated mesh\n");
+            return 1;
+        }
+
+        // The energy must stay finite and fall from each window to the next, down to silence
+        int passed = energies[0] > 0.0 && isfinite(energies[0]);
+        printf("admittance %.2f: energies", ADMITTANCES[a]);
+        for (int w = 0; w < WINDOW_COUNT; w++) {
+            printf(" %.2g", energies[w]);
+            passed &= isfinite(energies[w]) && (w == 0 || energies[w] < energies[w - 1]);
+        }
+        passed &= energies[WINDOW_COUNT - 1] < FINAL_ENERGY_RATIO * energies[0];
+        printf("%s\n", passed ? "" : " FAILED");
+        failed |= !passed;
+    }
+    return failed;
+}
+
+int render_energies(double energies[WINDOW_COUNT], const float admittance) {
+    const float in_position_m[3] = {0.3f, 0.4f, 0.35f}, ma_position_m[3] = {0.25f, 0.3f, 0.2f};
+    const float *in_positions_m[1] = {in_position_m};
+    float in_buffer[BUFFER_SIZE], ma_buffer[2][BUFFER_SIZE];
+    const float *in_buffers[1] = {in_buffer};
+    float *ma_buffers[2] = {ma_buffer[0], ma_buffer[1]};
+    float bound_params[6][2];
+    for (int f = 0; f < 6; f++) {
+        bound_params[f][0] = admittance;
+        bound_params[f][1] = 0.5f;
+    }
+
+    dwm_ma_mesh_config config;
+    dwm_ma_mesh_config_default(&config);
+    config.size_x_j = config.size_y_j = config.size_z_j = SIZE_J;
+    config.topology = DWM_MA_TOPOLOGY_INTERPOLATED;
+    void *handle;
+    if (dwm_ma_create_ex(&handle, &config) != 0) {
+        return 1;
+    }
+    dwm_ma_init(handle, bound_params, 1);
+
+    // Feed a unit impulse, then let the response ring while summing the output energy of each window
+    for (int w = 0; w < WINDOW_COUNT; w++) {
+        energies[w] = 0.0;
+        for (int k = 0; k < WINDOW_BUFFER_COUNT; k++) {
+            for (int n = 0; n < BUFFER_SIZE; n++) {
+                in_buffer[n] = w == 0 && k == 0 && n == 0 ? 1.0f : 0.0f;
+            }
+            dwm_ma_process_interpolated(handle, in_buffers, in_positions_m, 1, MA_CONFIG_STEREO, 1.0f, ma_buffers,
+                                        ma_position_m);
+            for (int c = 0; c < 2; c++) {
+                for (int n = 0; n < BUFFER_SIZE; n++) {
+                    energies[w] += (double) ma_buffer[c][n] * ma_buffer[c][n];
+                }
+            }
+        }
+    }
+    dwm_ma_destroy(&handle);
+    return 0;
+}
+
+int check_rejected(const DWM_MA_STORAGE storage) {
+    dwm_ma_mesh_config config;
+    dwm_ma_mesh_config_default(&config);
+    config.storage = storage;
+    config.topology = DWM_MA_TOPOLOGY_INTERPOLATED;
+    void *handle;
+    if (dwm_ma_create_ex(&handle, &config) == 0) {
+        dwm_ma_destroy(&handle);
+        return 1;
+    }
+    return handle != NULL;
+}
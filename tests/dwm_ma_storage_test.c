@@ -0,0 +1,135 @@
+#include "dwm_ma.h"
+
+#include <math.h>
+#include <stdio.h>
+
+/**
+ * Amount of samples of each processing call
+ */
+#define BUFFER_SIZE 128
+
+/**
+ * Amount of buffers of each measured response, one second at the default 16 kHz
+ */
+#define BUFFER_COUNT (16000 / BUFFER_SIZE)
+
+/**
+ * Amount of channels of MA_CONFIG_24_POINTS_SQRT_5
+ */
+#define CHANNEL_COUNT 24
+
+// Internal structs and functions declarations
+
+/**
+ * Error bounds of a storage format, as documented by DWM_MA_STORAGE
+ */
+typedef struct {
+    DWM_MA_STORAGE storage;
+    const char *name;
+    double peak_error_db;
+    double error_energy_db;
+} storage_bounds_t;
+
+/**
+ * Normalized admittances of the measured responses, in order [Z-,Y-,X-,X+,Y+,Z+]
+ */
+static const float ADMITTANCES[][6] = {
+        {0.1f, 0.3f, 0.5f, 0.7f, 0.9f, 0.5f},
+        {0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f},
+        {0.9f, 0.9f, 0.9f, 0.9f, 0.9f, 0.9f},
+};
+
+/**
+ * Documented error bounds of each half precision storage format
+ */
+static const storage_bounds_t BOUNDS[] = {
+        {DWM_MA_STORAGE_FLOAT16, "DWM_MA_STORAGE_FLOAT16", -50.0, -44.0},
+        {DWM_MA_STORAGE_BFLOAT16, "DWM_MA_STORAGE_BFLOAT16", -20.0, -10.0},
+};
+
+/**
+ * Renders the impulse response of a default mesh with the given storage format
+ * @param response rendered response (dimensionality CHANNEL_COUNT x BUFFER_COUNT * BUFFER_SIZE)
+ * @param storage storage format of the mesh
+ * @param admittances normalized admittance of each face
+ * @return 0 on success, non-zero if the mesh cannot be created
+ */
+static int render_response(float response[CHANNEL_COUNT][BUFFER_COUNT * BUFFER_SIZE], DWM_MA_STORAGE storage,
+                           const float admittances[6]);
+
+// Function definitions
+
+int main(void) {
+    static float reference[CHANNEL_COUNT][BUFFER_COUNT * BUFFER_SIZE];
+    static float response[CHANNEL_COUNT][BUFFER_COUNT * BUFFER_SIZE];
+    int failed = 0;
+    for (int a = 0; a < (int) (sizeof(ADMITTANCES) / sizeof(ADMITTANCES[0])); a++) {
+        if (render_response(reference, DWM_MA_STORAGE_FLOAT32, ADMITTANCES[a]) != 0) {
+            fprintf(stderr, "cannot create the reference mesh\n");
+            return 1;
+        }
+        for (int b = 0; b < (int) (sizeof(BOUNDS) / sizeof(BOUNDS[0])); b++) {
+            if (render_response(response, BOUNDS[b].storage, ADMITTANCES[a]) != 0) {
+                fprintf(stderr, "cannot create the %s mesh\n", BOUNDS[b].name);
+                return 1;
+            }
+
+            // Compare the peaks and energies of the error and of the reference response
+            double peak = 0.0, peak_error = 0.0, energy = 0.0, error_energy = 0.0;
+            for (int c = 0; c < CHANNEL_COUNT; c++) {
+                for (int n = 0; n < BUFFER_COUNT * BUFFER_SIZE; n++) {
+                    const double value = reference[c][n], error = response[c][n] - value;
+                    peak = fmax(peak, fabs(value));
+                    peak_error = fmax(peak_error, fabs(error));
+                    energy += value * value;
+                    error_energy += error * error;
+                }
+            }
+            const double peak_error_db = 20.0 * log10(peak_error / peak);
+            const double error_energy_db = 10.0 * log10(error_energy / energy);
+            const int passed = peak_error_db < BOUNDS[b].peak_error_db && error_energy_db < BOUNDS[b].error_energy_db;
+            printf("%s, admittances %d: peak error %.1f dB (bound %.0f dB), error energy %.1f dB (bound %.0f dB)%s\n",
+                   BOUNDS[b].name, a, peak_error_db, BOUNDS[b].peak_error_db, error_energy_db,
+                   BOUNDS[b].error_energy_db, passed ? "" : " FAILED");
+            failed |= !passed;
+        }
+    }
+    return failed;
+}
+
+int render_response(float response[CHANNEL_COUNT][BUFFER_COUNT * BUFFER_SIZE], const DWM_MA_STORAGE storage,
+                    const float admittances[6]) {
+    const float in_position_m[3] = {0.7f, 0.9f, 0.6f}, ma_position_m[3] = {1.5f, 1.3f, 1.2f};
+    const float *in_positions_m[1] = {in_position_m};
+    float in_buffer[BUFFER_SIZE];
+    const float *in_buffers[1] = {in_buffer};
+    float *ma_buffers[CHANNEL_COUNT];
+    float bound_params[6][2];
+    for (int f = 0; f < 6; f++) {
+        bound_params[f][0] = admittances[f];
+        bound_params[f][1] = 0.5f;
+    }
+
+    dwm_ma_mesh_config config;
+    dwm_ma_mesh_config_default(&config);
+    config.storage = storage;
+    void *handle;
+    if (dwm_ma_create_ex(&handle, &config) != 0) {
+        return 1;
+    }
+    dwm_ma_init(handle, bound_params, 1);
+
+    // Feed a unit impulse, then let the response ring for the rest of the second
+    for (int k = 0; k < BUFFER_COUNT; k++) {
+        for (int n = 0; n < BUFFER_SIZE; n++) {
+            in_buffer[n] = k == 0 && n == 0 ? 1.0f : 0.0f;
+        }
+        for (int c = 0; c < CHANNEL_COUNT; c++) {
+            ma_buffers[c] = &response[c][k * BUFFER_SIZE];
+        }
+        dwm_ma_process_interpolated(handle, in_buffers, in_positions_m, 1, MA_CONFIG_24_POINTS_SQRT_5, 1.0f,
+                                    ma_buffers, ma_position_m);
+    }
+    dwm_ma_destroy(&handle);
+    return 0;
+}